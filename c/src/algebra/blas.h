@@ -0,0 +1,143 @@
+/*******************************************************************************
+*
+* Matrix Algebra - BLAS level-1/2/3 kernels
+*
+*   SUMMARY
+*       This single-header submodule gathers vector kernels in the style of
+*       the BLAS, over float vectors with explicit strides:
+*
+*       - blas_dot(), blas_axpy(), blas_scal(), blas_nrm2(), blas_iamax(),
+*         compiled in c/src/kernels,
+*       - blas_gemv() and blas_gemm() over MATRIX, op(A) is A or A^T as
+*         BLAS_NO_TRANS or BLAS_TRANS is given.
+*
+*       A row i of a MATRIX A is &A->val[A->cols * i] with stride 1, and its
+*       column j is &A->val[j] with stride A->cols. Unit strides take loops
+*       that the compiler vectorizes, reductions keep BLAS_LANES partial
+*       sums for it. As in the BLAS, x and y do not overlap. Nothing is
+*       pushed on the stack.
+*
+*******************************************************************************/
+
+#ifndef BLAS_H_
+#define BLAS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/*    INCLUDED FILES                                                          */
+/******************************************************************************/
+
+#include "kernels.h"
+#include "memory.h"
+#include "levels.h"
+
+/* Logs in this header belong to the algebra module */
+#pragma push_macro("LOG_MODULE")
+#undef LOG_MODULE
+#define LOG_MODULE LOG_MODULE_ALGEBRA
+
+/******************************************************************************/
+/*    API                                                                     */
+/******************************************************************************/
+
+/**
+ * @brief   Function that computes y := alpha op(A) x + beta y, op(A) is A
+ *          or A^T as trans is BLAS_NO_TRANS or BLAS_TRANS. y is not read
+ *          when beta is 0.
+ *
+ * @return  A, or NULL when an input is NULL.
+ *
+ * @examples blas_gemv(BLAS_NO_TRANS, 1.0F, A, x, 1U, 0.0F, y, 1U);
+ */
+MATRIX* blas_gemv(uint32_t trans, float alpha, MATRIX *A, const float *x, uint32_t incx,
+                  float beta, float *y, uint32_t incy);
+
+/**
+ * @brief   Function that computes C := alpha op(A) op(B) + beta C in place of
+ *          C, op(A) is m x k, op(B) is k x n and C is m x n. The transposes
+ *          are read by blocks, A^T and B^T are not pushed. C is not read
+ *          when beta is 0, and it does not overlap A or B.
+ *
+ * @return  C, or NULL when an input is NULL or the sizes do not match.
+ *
+ * @examples blas_gemm(BLAS_TRANS, BLAS_NO_TRANS, 1.0F, A, A, 0.0F, G);
+ */
+MATRIX* blas_gemm(uint32_t transA, uint32_t transB, float alpha, MATRIX *A, MATRIX *B,
+                  float beta, MATRIX *C);
+
+/******************************************************************************/
+/*    IMPLEMENTATION                                                          */
+/******************************************************************************/
+
+MATRIX* blas_gemv(uint32_t trans, float alpha, MATRIX *A, const float *x, uint32_t incx,
+                  float beta, float *y, uint32_t incy)
+{
+    if ((A == NULL) || (x == NULL) || (y == NULL))
+    {
+        LOG_ERROR("Wrong inputs in blas_gemv(A, x, y).");
+        return NULL;
+    }
+
+    const uint32_t yLen = (trans == BLAS_NO_TRANS) ? A->rows : A->cols;
+
+    /* 1) y := beta y, BLAS does not read y when beta is 0 */
+    for (uint32_t i = 0U; i < yLen; i++)
+    {
+        float *yi = &y[(size_t)incy * i];
+        *yi = (beta == 0.0F) ? 0.0F : beta * *yi;
+    }
+
+    if (trans == BLAS_NO_TRANS)
+    {
+        /* 2) y(i) += alpha A(i,:) x, rows are contiguous */
+        for (uint32_t i = 0U; i < A->rows; i++)
+        {
+            y[(size_t)incy * i] += alpha * blas_dot(A->cols, &A->val[(size_t)A->cols * i], 1U, x, incx);
+        }
+    }
+    else
+    {
+        /* 2) y += alpha x(i) A(i,:)^T, one row of A at a time */
+        for (uint32_t i = 0U; i < A->rows; i++)
+        {
+            blas_axpy(A->cols, alpha * x[(size_t)incx * i], &A->val[(size_t)A->cols * i], 1U, y, incy);
+        }
+    }
+
+    return A;
+}
+
+MATRIX* blas_gemm(uint32_t transA, uint32_t transB, float alpha, MATRIX *A, MATRIX *B,
+                  float beta, MATRIX *C)
+{
+    if ((A == NULL) || (B == NULL) || (C == NULL))
+    {
+        LOG_ERROR("Wrong inputs in blas_gemm(A, B, C).");
+        return NULL;
+    }
+
+    const uint32_t m = (transA == BLAS_NO_TRANS) ? A->rows : A->cols;
+    const uint32_t k = (transA == BLAS_NO_TRANS) ? A->cols : A->rows;
+    const uint32_t kB = (transB == BLAS_NO_TRANS) ? B->rows : B->cols;
+    const uint32_t n = (transB == BLAS_NO_TRANS) ? B->cols : B->rows;
+    if ((k != kB) || (C->rows != m) || (C->cols != n))
+    {
+        LOG_ERROR("Matrices does not have suitable size for blas_gemm(A, B, C).");
+        return NULL;
+    }
+
+    kernel_gemm(transA, transB, m, n, k, alpha, A->val, A->cols, B->val, B->cols, beta, C->val, C->cols);
+
+    return C;
+}
+
+#pragma pop_macro("LOG_MODULE")
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BLAS_H_ */
@@ -3,9 +3,10 @@
 * Matrix Algebra
 *
 *   SUMMARY
-*       This single-header module implements a recursive version of
-*       the echelon form of a aquare matrix,A in PA = LU, and it returns
-*       U after completion.
+*       This single-header module implements the echelon form of a square
+*       matrix, A in PA = LU, and it returns U after completion. It is built
+*       on lu_factor(), an in-place LU with partial pivoting. solve() goes on
+*       to A X = B. Both run the kernels of c/src/kernels.
 *
 *******************************************************************************/
 
@@ -22,25 +23,59 @@ extern "C" {
 
 #include <float.h>
 #include <math.h>
+#include <stdint.h>
 
+#include "blas.h"
 #include "operators.h"
 
+/* Logs in this header belong to the algebra module */
+#pragma push_macro("LOG_MODULE")
+#undef LOG_MODULE
+#define LOG_MODULE LOG_MODULE_ALGEBRA
+
+/******************************************************************************/
+/*    DEFINITIONS                                                             */
+/******************************************************************************/
+
+/* lu_factor() return value for a NULL matrix */
+#define LU_INVALID  (UINT32_MAX)
+
 /******************************************************************************/
 /*    API                                                                     */
 /******************************************************************************/
 
 /**
- * @brief   Function that computes the echelon form of a square matrix.
+ * @brief   Function that computes the echelon form of a square matrix, U
+ *          in PA = LU. A is not modified, U is pushed on the stack.
  */
 MATRIX* echelon(MATRIX *A);
 
-/******************************************************************************/
-/*    STATIC FUNCTION PROTOTYPES                                              */
-/******************************************************************************/
-
-static MATRIX* get_lower_triangular(MATRIX *PA);
+/**
+ * @brief   Function that factors A in place as PA = LU with partial
+ *          pivoting, rows are swapped to bring the max-abs entry of each
+ *          column to the diagonal. U is on and above the diagonal and L,
+ *          whose unit diagonal is implicit, below it. It does not allocate.
+ *
+ * @param   piv     row k was swapped with row piv[k], it holds
+ *                  min(rows, cols) entries. NULL when P is not needed.
+ *                  piv[k] = k for a column that is not eliminated.
+ *
+ * @return  0 when U is invertible, k + 1 when U(k,k) is the first pivot
+ *          below FLT_EPSILON, its column is not eliminated.
+ *
+ * @examples uint32_t piv[4U]; uint32_t info = lu_factor(A, piv);
+ */
+uint32_t lu_factor(MATRIX *A, uint32_t *piv);
 
-static MATRIX* get_permutation(MATRIX *A);
+/**
+ * @brief   Function that solves A X = B for a square A, X is pushed on the
+ *          stack. A and B are not modified.
+ *
+ * @return  X, or NULL when A is singular.
+ *
+ * @examples MATRIX *x = solve(A, b);
+ */
+MATRIX* solve(MATRIX *A, MATRIX *B);
 
 /******************************************************************************/
 /*    IMPLEMENTATION                                                          */
@@ -48,155 +83,119 @@ static MATRIX* get_permutation(MATRIX *A);
 
 MATRIX* echelon(MATRIX *A)
 {
-    MATRIX *P, *L, *U;
-    if (A->cols != A->rows)
+    if ((A == NULL) || (A->cols != A->rows))
     {
         LOG_WARNING("Matrix is not a square matrix.");
-        LOG_WARNING_MATRIX(A);
-        return NULL;
-    }
-
-    if (A->rows == 1U)
-    {
-        if (fabs(A->val[0U]) < FLT_EPSILON)
+        if (A != NULL)
         {
-            LOG_WARNING("Matrix is singular");
             LOG_WARNING_MATRIX(A);
         }
-        else
-        {
-            LOG_INFO("Matrix is invertible");
-            P = L = id(1U);
-            U = A;
-
-            LOG_DEBUG("P = L = id(1U)");
-            LOG_DEBUG_MATRIX(L);
-
-            LOG_DEBUG("A = U");
-            LOG_DEBUG_MATRIX(U);
-        }
-
-        return A;
+        return NULL;
     }
 
+    MATRIX *U = push_matrix(A->rows, A->cols);
+    if (U == NULL)
+    {
+        LOG_ERROR("Echelon form was not created.");
+        return NULL;
+    }
+    memcpy(U->val, A->val, sizeof(float) * A->rows * A->cols);
     LOG_DEBUG_MATRIX(A);
-    /* 1) get P for P x A product, if a(0,0) is zero */
-    MATRIX *PA;
-    P = get_permutation(A);
-    if (P != NULL)
+
+    if (lu_factor(U, NULL) != 0U)
     {
-        LOG_DEBUG_MATRIX(P);
-        PA = mult(P, A);
+        LOG_WARNING("Matrix is singular");
     }
     else
     {
-        PA = A;
+        LOG_INFO("Matrix is invertible");
     }
-    LOG_DEBUG_MATRIX(PA);
-
-    /* 2) get L(j) for L(j) x PA = L(j) x LU, to remove j-th column */
-    L = get_lower_triangular(PA);
-    LOG_DEBUG_MATRIX(L);
-    MATRIX *LPA = mult(L, PA);
-    LOG_DEBUG_MATRIX(LPA);
-
-    /* 3) get LPA(2,2) as subA in LPA = [LPA(1,1) | LPA(1,2)]
-     *                                  [LPA(2,1) | LPA(2,2)] */
-    MATRIX *subA = GET_BLOCK_MATRIX(LPA, 1U);
-    LOG_DEBUG_MATRIX(subA);
-
-    /* 4) call recursively */
-    U = echelon(subA);
-    LOG_INFO("return U");
-    LOG_DEBUG_MATRIX(U);
 
-    /* 5) set U as LPA(2,2) in LPA */
-    U = set_block_matrix(LPA, 1U, 1U, U);
+    /* Dropping L */
+    for (uint32_t i = 1U; i < U->rows; i++)
+    {
+        memset(&U->val[TO_C_CONT(U, i, 0U)], 0U, sizeof(float) * i);
+    }
     LOG_DEBUG_MATRIX(U);
-    LOG_DEBUG_MATRIX(A);
-    LOG_DEBUG_MATRIX(L);
 
     /* returning upper-triangular matrix from PA = LU */
     return U;
 }
 
-uint32_t get_new_pivot(MATRIX *A)
+uint32_t lu_factor(MATRIX *A, uint32_t *piv)
 {
-    uint32_t row = A->rows;
+    if (A == NULL)
+    {
+        LOG_ERROR("Wrong inputs in lu_factor(A, piv).");
+        return LU_INVALID;
+    }
 
-    for (uint32_t i = 0U; i < A->rows; i++)
+    const uint32_t info = kernel_getrf(A->rows, A->cols, A->val, A->cols, piv);
+    if (info != 0U)
     {
-        uint32_t pos = TO_C_CONT(A, i, 0U);
-        if (fabs(A->val[pos]) > FLT_EPSILON)
-        {
-            row = i;
-            break;
-        }
+        LOG_DEBUG("Pivot of column %u is zero", info - 1U);
     }
 
-    LOG_TRACE("Pivot %f, A[%u, 0], is in row %u of %u rows", A->val[TO_C_CONT(A, row, 0U)], row, row, A->rows - 1U);
-    return row;
+    return info;
 }
 
-static MATRIX* get_permutation(MATRIX *A)
+MATRIX* solve(MATRIX *A, MATRIX *B)
 {
-    MATRIX *P = NULL;
+    if ((A == NULL) || (B == NULL) || (A->rows != A->cols) || (A->rows != B->rows))
+    {
+        LOG_ERROR("Wrong inputs in solve(A, B).");
+        return NULL;
+    }
 
-    uint32_t row = get_new_pivot(A);
-    if (row == A->rows)
+    /* X stays on the stack, LU and piv are released */
+    MATRIX *X = push_matrix(B->rows, B->cols);
+    if (X == NULL)
     {
-        LOG_WARNING("Matrix is singular.");
+        LOG_ERROR("Solution was not created.");
+        return NULL;
     }
-    else
+    memcpy(X->val, B->val, sizeof(float) * B->rows * B->cols);
+
+    MARK mark = mark_stack();
+    MATRIX *LU = push_matrix(A->rows, A->cols);
+    uint32_t *piv = malloc(sizeof(uint32_t) * A->rows);
+    uint32_t info = LU_INVALID;
+
+    if ((LU != NULL) && (piv != NULL))
     {
-        if (row == 0U)
-        {
-            LOG_DEBUG("Pivot is nonzero, nothing to permute");
-        }
-        else /* The matrix is nonsingular, pivot is zero and nonscalar */
+        memcpy(LU->val, A->val, sizeof(float) * A->rows * A->cols);
+        info = kernel_getrf(LU->rows, LU->cols, LU->val, LU->cols, piv);
+        if (info == 0U)
         {
-            P = id(A->rows);
-            P = PERMUTE_ROWS(P, row);
+            kernel_getrs(LU->rows, X->cols, LU->val, LU->cols, piv, X->val, X->cols);
         }
     }
+    free(piv);
+    release_stack(mark);
 
-    return P;
-}
+    if (info != 0U)
+    {
+        LOG_WARNING("Matrix is singular, A X = B was not solved.");
+        /* X is the top of the stack again */
+        stack = pop_matrix(stack);
+        return NULL;
+    }
 
-static MATRIX* get_lower_triangular(MATRIX *PA)
-{
-    MATRIX *L = id(PA->rows);
-    MATRIX *a = get_block_matrix(PA, 0U, 1U, 0U, 1U);
-    /* when being a scalar it migh be removed by outter for */
-    MATRIX *b = get_block_matrix(PA, 1U, PA->rows, 0U, 1U);
-
-    LOG_DEBUG_MATRIX(a);
-    a->val[0U] = -1.0F / a->val[0U];
-    LOG_DEBUG("1/a is %f", a->val[0U]);
-    LOG_DEBUG_MATRIX(b);
-
-    /* building column-vector as B * A^(-1) */
-    b = mult(b, a);
-    LOG_DEBUG_MATRIX(b);
-    L = set_block_matrix(L, 1U, 0U, b);
-
-    return L;
+    LOG_DEBUG_MATRIX(X);
+    return X;
 }
 
 MATRIX* get_inverse_lower_triag(MATRIX *L)
 {
-    /* Copying the matrix */
+    /* Copying the matrix, and negating its first column below the diagonal */
     MATRIX *invL = GET_BLOCK_MATRIX(L, 0U);
-
-    for (uint32_t i = 1U; i < L->rows; i++)
-    {
-        uint32_t pos = TO_C_CONT(invL, i, 0U);
-        invL->val[pos] = -1.0F * invL->val[pos];
-    }
+    blas_scal(invL->rows - 1U, -1.0F, &invL->val[invL->cols], invL->cols);
 
     return invL;
 }
 
+#pragma pop_macro("LOG_MODULE")
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,354 @@
+/******************************************************************************/
+/*    INCLUDED FILES                                                          */
+/******************************************************************************/
+
+#include <pthread.h>
+
+#include "memory.h"
+
+/* Spare chunks are freed when threads do not share them */
+#ifndef MEMORY_SHARED_CHUNKS
+    #define MEMORY_SHARED_CHUNKS    (0U)
+#endif
+
+/******************************************************************************/
+/*    PRIVATE DATA                                                            */
+/******************************************************************************/
+
+/* Top of the stack of each thread */
+_Thread_local ITEM *stack = NULL;
+
+/* A chunk of the arena, its blocks start ARENA_ALIGN_UP(sizeof(CHUNK)) on */
+typedef struct Chunk
+{
+    struct Chunk *prev;
+    size_t       size;
+    size_t       used;
+} CHUNK;
+
+/* The chunk being bumped, and freed ones kept to avoid malloc() churn */
+static _Thread_local CHUNK    *arena = NULL;
+static _Thread_local CHUNK    *spares = NULL;
+static _Thread_local uint32_t spareCount = 0U;
+
+/* Key whose destructor releases the stack of a thread at exit */
+static pthread_key_t  arenaKey;
+static pthread_once_t arenaOnce = PTHREAD_ONCE_INIT;
+
+#if MEMORY_SHARED_CHUNKS
+/* Spare chunks of every thread, a lock-free list. Chunks are pushed, and
+ * only taken all at once, so that a compare-and-swap never sees ABA */
+static CHUNK *sharedChunks = NULL;
+#endif
+
+/******************************************************************************/
+/*    STATIC FUNCTION PROTOTYPES                                              */
+/******************************************************************************/
+
+static void* arena_alloc(size_t size);
+
+static void arena_rewind(CHUNK *chunk, size_t used);
+
+static CHUNK* chunk_malloc(size_t size);
+
+static void chunk_free(CHUNK *chunk);
+
+static char* get_data(CHUNK *chunk);
+
+static void make_arena_key(void);
+
+static void free_arena(void *unused);
+
+static void give_chunks(CHUNK *first, CHUNK *last);
+
+static CHUNK* take_chunks(void);
+
+/******************************************************************************/
+/*    IMPLEMENTATION                                                          */
+/******************************************************************************/
+
+MATRIX* push_matrix(uint32_t rows, uint32_t cols)
+{
+    /* [ITEM | MATRIX | padding][values | padding] */
+    const size_t header = ARENA_ALIGN_UP(sizeof(ITEM) + sizeof(MATRIX));
+    char *block = (char*)arena_alloc(header + ARENA_ALIGN_UP(sizeof(float) * (size_t)rows * cols));
+
+    if (block == NULL)
+    {
+        return NULL;
+    }
+
+    ITEM *top = (ITEM*)block;
+    MATRIX *A = (MATRIX*)(block + sizeof(ITEM));
+    A->rows = rows;
+    A->cols = cols;
+    A->val = (float*)(block + header);
+
+    top->matrix = A;
+    top->next = stack;
+    stack = top;
+
+    return A;
+}
+
+/* Freeing only one item from the stack */
+void* pop_matrix(void *top)
+{
+    if (top != NULL)
+    {
+        ITEM *item = (ITEM*)top;
+        top = item->next;
+
+        /* Everything above the top of the stack is unreachable */
+        if (item == stack)
+        {
+            CHUNK *chunk = arena;
+            while ((chunk != NULL) &&
+                   (((char*)item < get_data(chunk)) || (get_data(chunk) + chunk->used <= (char*)item)))
+            {
+                chunk = chunk->prev;
+            }
+            arena_rewind(chunk, (chunk == NULL) ? 0U : (size_t)((char*)item - get_data(chunk)));
+        }
+    }
+
+    return top;
+}
+
+MARK mark_stack(void)
+{
+    MARK mark = {stack, arena, (arena == NULL) ? 0U : arena->used};
+
+    return mark;
+}
+
+void release_stack(MARK mark)
+{
+    arena_rewind(mark.chunk, mark.used);
+    stack = mark.top;
+}
+
+MATRIX* get_block_matrix(MATRIX *S, uint32_t row, uint32_t rowEnd,
+                                  uint32_t col, uint32_t colEnd)
+{
+    MATRIX *block = NULL;
+
+    if (S == NULL)
+    {
+        return NULL;
+    }
+
+    /* row < rowEnd <= S->rows, the same holds for cols, to be a valid call */
+    if ((rowEnd <= row) || (colEnd <= col) ||
+        (S->rows < rowEnd) || (S->cols < colEnd))
+    {
+        return S;
+    }
+
+    block = push_matrix(rowEnd - row, colEnd - col);
+    for (uint32_t i = row; i < rowEnd; i++)
+    {
+        uint32_t srcIdx = TO_C_CONT(S, i, col);
+        uint32_t dstIdx = TO_C_CONT(block, (i - row), 0U);
+        memcpy(&block->val[dstIdx], &S->val[srcIdx], sizeof(float) * block->cols);
+    }
+
+    return block;
+}
+
+MATRIX* set_block_matrix(MATRIX *D, uint32_t row, uint32_t col, MATRIX *S)
+{
+    if ((D == NULL) || (S == NULL))
+    {
+        return NULL;
+    }
+
+    if ((D->rows < row) || (D->cols < col))
+    {
+        return D;
+    }
+
+    if ((D->rows - row) < (S->rows) ||
+        (D->cols - col) < (S->cols))
+    {
+        return S;
+    }
+
+    for (uint32_t i = 0U; i < S->rows; i++)
+    {
+        uint32_t dstIdx = TO_C_CONT(D, (i + row), col);
+        uint32_t srcIdx = TO_C_CONT(S, i, 0U);
+        memcpy(&D->val[dstIdx], &S->val[srcIdx], sizeof(float) * S->cols);
+    }
+
+    return D;
+}
+
+/* Memory allocation-like functions, size is a multiple of ARENA_ALIGN */
+static void* arena_alloc(size_t size)
+{
+    if ((arena == NULL) || ((arena->size - arena->used) < size))
+    {
+        CHUNK *chunk = chunk_malloc((size < ARENA_CHUNK_LEN) ? ARENA_CHUNK_LEN : size);
+        if (chunk == NULL)
+        {
+            return NULL;
+        }
+
+        /* The tail of the previous chunk is left unused */
+        chunk->prev = arena;
+        arena = chunk;
+    }
+
+    void *block = get_data(arena) + arena->used;
+    arena->used += size;
+
+    return block;
+}
+
+/* Freeing the chunks after chunk, chunk = NULL frees them all */
+static void arena_rewind(CHUNK *chunk, size_t used)
+{
+    while (arena != chunk)
+    {
+        CHUNK *prev = arena->prev;
+        chunk_free(arena);
+        arena = prev;
+    }
+
+    if (arena != NULL)
+    {
+        arena->used = used;
+    }
+}
+
+static CHUNK* chunk_malloc(size_t size)
+{
+    CHUNK *chunk = NULL;
+
+    if ((spares == NULL) && (size == ARENA_CHUNK_LEN))
+    {
+        /* Chunks that other threads freed, they are this thread's spares now */
+        for (CHUNK *itr = take_chunks(); itr != NULL; )
+        {
+            CHUNK *prev = itr->prev;
+            itr->prev = spares;
+            spares = itr;
+            spareCount++;
+            itr = prev;
+        }
+    }
+
+    if ((spares != NULL) && (size == ARENA_CHUNK_LEN))
+    {
+        chunk = spares;
+        spares = chunk->prev;
+        spareCount--;
+    }
+    else
+    {
+        chunk = (CHUNK*)aligned_alloc(ARENA_ALIGN, ARENA_ALIGN_UP(sizeof(CHUNK)) + size);
+    }
+
+    /* The first chunk of the stack, it is released at thread exit */
+    if ((chunk != NULL) && (arena == NULL))
+    {
+        pthread_once(&arenaOnce, make_arena_key);
+        pthread_setspecific(arenaKey, &arena);
+    }
+
+    if (chunk != NULL)
+    {
+        chunk->prev = NULL;
+        chunk->size = size;
+        chunk->used = 0U;
+    }
+
+    return chunk;
+}
+
+/* Memory free-like functions, ARENA_SPARE_CHUNKS chunks are kept */
+static void chunk_free(CHUNK *chunk)
+{
+    if (chunk->size != ARENA_CHUNK_LEN)
+    {
+        free(chunk);
+    }
+    else if (spareCount < ARENA_SPARE_CHUNKS)
+    {
+        chunk->prev = spares;
+        spares = chunk;
+        spareCount++;
+    }
+    else
+    {
+        give_chunks(chunk, chunk);
+    }
+}
+
+static char* get_data(CHUNK *chunk)
+{
+    return (char*)chunk + ARENA_ALIGN_UP(sizeof(CHUNK));
+}
+
+static void make_arena_key(void)
+{
+    pthread_key_create(&arenaKey, free_arena);
+}
+
+/* Matrices of an exiting thread are unreachable, its chunks are spare */
+static void free_arena(void *unused)
+{
+    (void)unused;
+
+    arena_rewind(NULL, 0U);
+    stack = NULL;
+
+    if (spares != NULL)
+    {
+        CHUNK *last = spares;
+        while (last->prev != NULL)
+        {
+            last = last->prev;
+        }
+        give_chunks(spares, last);
+        spares = NULL;
+        spareCount = 0U;
+    }
+}
+
+/* Pushing the chunks from first to last, linked by prev */
+static void give_chunks(CHUNK *first, CHUNK *last)
+{
+#if MEMORY_SHARED_CHUNKS
+    CHUNK *head = __atomic_load_n(&sharedChunks, __ATOMIC_RELAXED);
+
+    do {
+        last->prev = head;
+    } while (!__atomic_compare_exchange_n(&sharedChunks, &head, first, 1,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+#else
+    last->prev = NULL;
+    while (first != NULL)
+    {
+        CHUNK *prev = first->prev;
+        free(first);
+        first = prev;
+    }
+#endif
+}
+
+static CHUNK* take_chunks(void)
+{
+#if MEMORY_SHARED_CHUNKS
+    /* Empty most of the time, a load is cheaper than an exchange */
+    if (__atomic_load_n(&sharedChunks, __ATOMIC_RELAXED) == NULL)
+    {
+        return NULL;
+    }
+
+    return __atomic_exchange_n(&sharedChunks, NULL, __ATOMIC_ACQUIRE);
+#else
+    return NULL;
+#endif
+}
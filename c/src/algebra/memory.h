@@ -3,14 +3,24 @@
 * MEMORY MANAGEMENT SYSTEM
 *
 *   SUMMARY
-*       This single-header module implements a simple but effective memory
-*       management system, the M2S. Its functionality is boiled down to:
+*       This module implements a simple but effective memory management
+*       system, the M2S. Its functionality is boiled down to:
 *
 *       a) matrix creation,
 *       b) matrix destruction,
 *       c) a stack-like mechanism,
 *       d) copy/paste between (sub)matrices.
 *
+*       Matrices live in an arena: the stack item, the MATRIX and its values
+*       are one 64-byte aligned block, bumped from chunks of ARENA_CHUNK_LEN
+*       bytes (larger matrices get a chunk of their own). mark_stack() and
+*       release_stack() free every matrix pushed in between at once.
+*
+*       Each thread has its own stack and arena, so threads push and pop
+*       without locks. A matrix is popped by the thread that pushed it, and
+*       the matrices of a thread are released when it exits. Spare chunks
+*       are shared between threads with MEMORY_SHARED_CHUNKS.
+*
 *******************************************************************************/
 
 #ifndef MEMORY_H_
@@ -40,6 +50,35 @@ typedef struct Matrix
     float   *val;
 } MATRIX;
 
+/* A simple stack, stack is the top of the calling thread's one */
+typedef struct Item
+{
+    MATRIX *matrix;
+    struct Item *next;
+} ITEM;
+
+/* A point of the stack to go back to */
+typedef struct Mark
+{
+    struct Item  *top;
+    struct Chunk *chunk;
+    size_t       used;
+} MARK;
+
+/******************************************************************************/
+/*    DEFINITIONS                                                             */
+/******************************************************************************/
+
+/* Blocks and values start at cache-line boundaries */
+#define ARENA_ALIGN         (64U)
+#define ARENA_CHUNK_LEN     (1024U * 1024U)
+
+/* Spare chunks a thread keeps before sharing or freeing them */
+#define ARENA_SPARE_CHUNKS  (4U)
+
+#define ARENA_ALIGN_UP(size) \
+    (((size) + ARENA_ALIGN - 1U) & ~((size_t)ARENA_ALIGN - 1U))
+
 /******************************************************************************/
 /*    PUBLIC MACROS                                                           */
 /******************************************************************************/
@@ -72,6 +111,16 @@ typedef struct Matrix
  */
 #define TO_F_CONT(A, row, col) A->rows * col + row
 
+/******************************************************************************/
+/*    PUBLIC DATA                                                             */
+/******************************************************************************/
+
+#ifdef __cplusplus
+extern thread_local ITEM *stack;
+#else
+extern _Thread_local ITEM *stack;
+#endif
+
 /******************************************************************************/
 /*    API                                                                     */
 /******************************************************************************/
@@ -83,10 +132,26 @@ MATRIX* push_matrix(uint32_t rows, uint32_t cols);
 
 /**
  * @brief   Function that deletes a MATRIX and pops it from the stack.
- *          void is used because ITEM is defined in the private data
+ *          void is kept for the callers that predate ITEM being public. The
+ *          memory is reclaimed when top is the top of the stack, otherwise
+ *          at the next release_stack() below it.
+ *
+ * @examples stack = pop_matrix(stack);
  */
 void* pop_matrix(void *top);
 
+/**
+ * @brief   Function that marks the top of the stack.
+ */
+MARK mark_stack(void);
+
+/**
+ * @brief   Function that pops every matrix pushed after mark at once.
+ *
+ * @examples MARK mark = mark_stack(); ... release_stack(mark);
+ */
+void release_stack(MARK mark);
+
 /**
  * @brief   Function that get a block-matrix from a matrix, it takes two
  *          points (row, col) and (rowEnd, colEnd).
@@ -100,161 +165,6 @@ MATRIX* get_block_matrix(MATRIX *S, uint32_t row, uint32_t rowEnd,
  */
 MATRIX* set_block_matrix(MATRIX *D, uint32_t row, uint32_t col, MATRIX *S);
 
-/******************************************************************************/
-/*    PRIVATE DATA                                                            */
-/******************************************************************************/
-
-/* A simple stack */
-typedef struct Item
-{
-    MATRIX *matrix;
-    struct Item *next;
-} ITEM;
-
-static ITEM *stack = NULL;
-
-/******************************************************************************/
-/*    STATIC FUNCTION PROTOTYPES                                              */
-/******************************************************************************/
-
-static MATRIX* matrix_malloc(uint32_t rows, uint32_t cols);
-
-static ITEM* matrix_push(ITEM *stack, MATRIX *A);
-
-static MATRIX* matrix_free(MATRIX *matrix);
-
-/******************************************************************************/
-/*    IMPLEMENTATION                                                          */
-/******************************************************************************/
-
-MATRIX* push_matrix(uint32_t rows, uint32_t cols)
-{
-    MATRIX *A = matrix_malloc(rows, cols);
-
-    if (A == NULL)
-    {
-        return NULL;
-    }
-    else
-    {
-        stack = matrix_push(stack, A);
-    }
-
-    return A;
-}
-
-/* Freeing only one item from the stack */
-void* pop_matrix(void *top)
-{
-    if (top != NULL)
-    {
-        ITEM *tmp = ((ITEM*)top)->next;
-        matrix_free(((ITEM*)top)->matrix);
-        free(top);
-        top = tmp;
-    }
-
-    return top;
-}
-
-MATRIX* get_block_matrix(MATRIX *S, uint32_t row, uint32_t rowEnd,
-                                  uint32_t col, uint32_t colEnd)
-{
-    MATRIX *block = NULL;
-
-    if (S == NULL)
-    {
-        return NULL;
-    }
-
-    /* row < rowEnd <= S->rows, the same holds for cols, to be a valid call */
-    if ((rowEnd <= row) || (colEnd <= col) ||
-        (S->rows < rowEnd) || (S->cols < colEnd))
-    {
-        return S;
-    }
-
-    block = push_matrix(rowEnd - row, colEnd - col);
-    for (uint32_t i = row; i < rowEnd; i++)
-    {
-        uint32_t srcIdx = TO_C_CONT(S, i, col);
-        uint32_t dstIdx = TO_C_CONT(block, (i - row), 0U);
-        memcpy(&block->val[dstIdx], &S->val[srcIdx], sizeof(float) * block->cols);
-    }
-
-    return block;
-}
-
-MATRIX* set_block_matrix(MATRIX *D, uint32_t row, uint32_t col, MATRIX *S)
-{
-    if ((D == NULL) || (S == NULL))
-    {
-        return NULL;
-    }
-
-    if ((D->rows < row) || (D->cols < col))
-    {
-        return D;
-    }
-
-    if ((D->rows - row) < (S->rows) ||
-        (D->cols - col) < (S->cols))
-    {
-        return S;
-    }
-
-    for (uint32_t i = 0U; i < S->rows; i++)
-    {
-        uint32_t dstIdx = TO_C_CONT(D, (i + row), col);
-        uint32_t srcIdx = TO_C_CONT(S, i, 0U);
-        memcpy(&D->val[dstIdx], &S->val[srcIdx], sizeof(float) * S->cols);
-    }
-
-    return D;
-}
-
-/* Memory allocation-like functions */
-static MATRIX* matrix_malloc(uint32_t rows, uint32_t cols)
-{
-    MATRIX *matrix = (MATRIX*)malloc(sizeof(MATRIX));
-
-    if (matrix != NULL)
-    {
-        matrix->rows = rows;
-        matrix->cols = cols;
-        matrix->val = (float*)malloc(sizeof(float) * rows * cols);
-    }
-
-    return matrix;
-}
-
-static ITEM* matrix_push(ITEM *stack, MATRIX *A)
-{
-    ITEM *top = (ITEM*)malloc(sizeof(ITEM));
-
-    /* stack is NULL at the very first itr */
-    top->next = stack;
-    top->matrix = A;
-
-    return top;
-}
-
-/* Memory free-like functions */
-static MATRIX* matrix_free(MATRIX *matrix)
-{
-    if (matrix->val != NULL)
-    {
-        free(matrix->val);
-    }
-
-    if (matrix != NULL)
-    {
-        free(matrix);
-    }
-
-    return (MATRIX*)NULL;
-}
-
 #ifdef __cplusplus
 }
 #endif
@@ -13,6 +13,8 @@
 *       - Identity matrix
 *       - Row-permutation matrix
 *
+*       The loops are kernels of c/src/kernels, shared with the C++ algebra.
+*
 *******************************************************************************/
 
 #ifndef OPERATORS_H_
@@ -26,9 +28,15 @@ extern "C" {
 /*    INCLUDED FILES                                                          */
 /******************************************************************************/
 
+#include "kernels.h"
 #include "memory.h"
 #include "levels.h"
 
+/* Logs in this header belong to the algebra module */
+#pragma push_macro("LOG_MODULE")
+#undef LOG_MODULE
+#define LOG_MODULE LOG_MODULE_ALGEBRA
+
 /******************************************************************************/
 /*    PUBLIC MACROS                                                           */
 /******************************************************************************/
@@ -95,16 +103,7 @@ MATRIX* transpose(MATRIX *A)
     AT = push_matrix(A->cols, A->rows);
     if (AT != NULL)
     {
-        for (uint32_t row = 0U; row < A->rows; row++)
-        {
-            for (uint32_t col = 0U; col < A->cols; col++)
-            {
-                uint32_t pos = TO_C_CONT(A, row, col);     //A->cols * row + col;
-                uint32_t posT = TO_F_CONT(A, row, col);    //A->rows * col + row;
-
-                AT->val[posT] = A->val[pos];
-            }
-        }
+        kernel_transpose(A->rows, A->cols, A->val, A->cols, AT->val, AT->cols);
     }
 
     return AT;
@@ -130,14 +129,7 @@ MATRIX* add(MATRIX *A, MATRIX *B)
     C = push_matrix(A->rows, A->cols);
     if (C != NULL)
     {
-        for (uint32_t row = 0U; row < A->rows; row++)
-        {
-            for (uint32_t col = 0U; col < A->cols; col++)
-            {
-                uint32_t pos = TO_C_CONT(A, row, col);
-                C->val[pos] = A->val[pos] + B->val[pos];
-            }
-        }
+        kernel_add(A->rows, A->cols, A->val, A->cols, B->val, B->cols, C->val, C->cols);
     }
 
     return C;
@@ -163,14 +155,7 @@ MATRIX* sub(MATRIX *A, MATRIX *B)
     C = push_matrix(A->rows, A->cols);
     if (C != NULL)
     {
-        for (uint32_t row = 0U; row < A->rows; row++)
-        {
-            for (uint32_t col = 0U; col < A->cols; col++)
-            {
-                uint32_t pos = TO_C_CONT(A, row, col);
-                C->val[pos] = A->val[pos] - B->val[pos];
-            }
-        }
+        kernel_sub(A->rows, A->cols, A->val, A->cols, B->val, B->cols, C->val, C->cols);
     }
 
     return C;
@@ -196,24 +181,8 @@ MATRIX* mult(MATRIX *A, MATRIX *B)
     C = push_matrix(A->rows, B->cols);
     if (C != NULL)
     {
-        for (uint32_t row = 0U; row < A->rows; row++)
-        {
-            MATRIX *rowV = GET_ROW_VECTOR(A, row);
-            LOG_TRACE_MATRIX(rowV);
-
-            for (uint32_t col = 0U; col < B->cols; col++)
-            {
-                MATRIX *colV = GET_COLUMN_VECTOR(B, col);
-                uint32_t pos = TO_C_CONT(C, row, col);
-                LOG_TRACE_MATRIX(colV);
-
-                for (uint32_t k = 0; k < A->cols; k++)
-                {
-                    C->val[pos] += rowV->val[k] * colV->val[k];
-                }
-                LOG_TRACE("C[%u,%u] := %f", row, col, C->val[pos]);
-            }
-        }
+        kernel_gemm(BLAS_NO_TRANS, BLAS_NO_TRANS, A->rows, B->cols, A->cols, 1.0F, A->val, A->cols,
+                    B->val, B->cols, 0.0F, C->val, C->cols);
     }
 
     return C;
@@ -228,10 +197,10 @@ MATRIX* id(uint32_t size)
         return NULL;
     }
 
-    memset(I->val, 0U, I->rows * I->cols);
-    for (uint32_t i = 0U; i < I->rows; i++)
+    /* One memset, then every (size + 1)-th value */
+    memset(I->val, 0U, sizeof(float) * I->rows * I->cols);
+    for (size_t pos = 0U; pos < (size_t)size * size; pos += (size_t)size + 1U)
     {
-        uint32_t pos = TO_C_CONT(I, i, i);
         I->val[pos] = 1.0F;
     }
 
@@ -272,6 +241,8 @@ MATRIX* permute(MATRIX *I, uint32_t a, uint32_t b)
     return I;
 }
 
+#pragma pop_macro("LOG_MODULE")
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,391 @@
+/*******************************************************************************
+*
+* Matrix Algebra - matrix storage
+*
+*   SUMMARY
+*       This is a single-header submodule that persists matrices in a simple
+*       binary format, a STORAGE_HEADER followed by the payload:
+*
+*       - save_matrix() writes a MATRIX at once,
+*       - open_storage(), write_rows() and close_storage() stream the rows
+*         of a matrix that does not fit in memory,
+*       - map_matrix() maps a file, and its MATRIX uses the mapped pages
+*         without copying them. unmap_matrix() releases it.
+*
+*       The payload is page-aligned so that it can be mapped on its own, and
+*       the header is in native endianness.
+*
+*******************************************************************************/
+
+#ifndef STORAGE_H_
+#define STORAGE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/*    INCLUDED FILES                                                          */
+/******************************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "memory.h"
+#include "levels.h"
+
+/* Logs in this header belong to the memory module */
+#pragma push_macro("LOG_MODULE")
+#undef LOG_MODULE
+#define LOG_MODULE LOG_MODULE_MEMORY
+
+/******************************************************************************/
+/*    DEFINITIONS                                                             */
+/******************************************************************************/
+
+/* Files start with "M2SF" and the version of their header */
+#define STORAGE_MAGIC           "M2SF"
+#define STORAGE_VERSION         (1U)
+
+/* Read back as 0x04030201 when the file comes from the other endianness */
+#define STORAGE_ENDIAN          (0x01020304U)
+
+/* Element types, only floats so far */
+#define STORAGE_DTYPE_FLOAT32   (0U)
+
+/* The payload starts at a page boundary */
+#define STORAGE_ALIGN           (4096U)
+
+/******************************************************************************/
+/*    PUBLIC TYPES                                                            */
+/******************************************************************************/
+
+/* Header of a file, rows are ld elements apart in the payload (ld >= cols) */
+typedef struct StorageHeader
+{
+    char     magic[4U];
+    uint32_t version;
+    uint32_t endian;
+    uint32_t dtype;
+    uint32_t rows;
+    uint32_t cols;
+    uint32_t ld;
+    uint32_t alignment;
+    uint64_t offset;
+} STORAGE_HEADER;
+
+/* A file being written row by row */
+typedef struct Storage
+{
+    FILE           *descriptor;
+    STORAGE_HEADER header;
+    uint32_t       written;
+} STORAGE;
+
+/******************************************************************************/
+/*    API                                                                     */
+/******************************************************************************/
+
+/**
+ * @brief   Function that opens a file to write a matrix of rows x cols,
+ *          row by row, with write_rows().
+ */
+STORAGE* open_storage(const char *filename, uint32_t rows, uint32_t cols);
+
+/**
+ * @brief   Function that appends rows to a file, val holds rows x cols
+ *          elements in c-contiguous layout.
+ *
+ * @return  The number of rows that were written.
+ */
+uint32_t write_rows(STORAGE *storage, const float *val, uint32_t rows);
+
+/**
+ * @brief   Function that closes a file, it fails when some rows were not
+ *          written.
+ *
+ * @return  0 on success, an errno value otherwise.
+ */
+int32_t close_storage(STORAGE *storage);
+
+/**
+ * @brief   Function that writes a matrix to a file.
+ *
+ * @return  A on success, NULL otherwise.
+ */
+MATRIX* save_matrix(const char *filename, MATRIX *A);
+
+/**
+ * @brief   Function that maps a file into a MATRIX whose values are the
+ *          mapped pages. They are private, writing to them does not change
+ *          the file. It is released with unmap_matrix(), not pop_matrix().
+ */
+MATRIX* map_matrix(const char *filename);
+
+/**
+ * @brief   Function that releases a matrix from map_matrix().
+ */
+void unmap_matrix(MATRIX *A);
+
+/******************************************************************************/
+/*    PRIVATE DATA                                                            */
+/******************************************************************************/
+
+/* A mapped matrix, matrix comes first to go back from MATRIX* to MAPPING* */
+typedef struct Mapping
+{
+    MATRIX matrix;
+    void   *base;
+    size_t length;
+} MAPPING;
+
+/******************************************************************************/
+/*    STATIC FUNCTION PROTOTYPES                                              */
+/******************************************************************************/
+
+static STORAGE_HEADER make_header(uint32_t rows, uint32_t cols);
+
+static uint32_t check_header(const STORAGE_HEADER *header, size_t length);
+
+static MATRIX* copy_rows(MAPPING *mapping, const STORAGE_HEADER *header);
+
+/******************************************************************************/
+/*    IMPLEMENTATION                                                          */
+/******************************************************************************/
+
+STORAGE* open_storage(const char *filename, uint32_t rows, uint32_t cols)
+{
+    STORAGE *storage = (STORAGE*)malloc(sizeof(STORAGE));
+
+    if (storage == NULL)
+    {
+        LOG_WARNING("Storage for %s was not created.", filename);
+        return NULL;
+    }
+
+    storage->descriptor = fopen(filename, "wb");
+    storage->header = make_header(rows, cols);
+    storage->written = 0U;
+
+    /* Header, then a gap (a hole in most filesystems) up to the payload */
+    if ((storage->descriptor == NULL) ||
+        (fwrite(&storage->header, sizeof(STORAGE_HEADER), 1U, storage->descriptor) != 1U) ||
+        (fseek(storage->descriptor, (long)storage->header.offset, SEEK_SET) != 0))
+    {
+        LOG_WARNING("File %s was not opened. [CODE %d]", filename, errno);
+        if (storage->descriptor != NULL)
+        {
+            fclose(storage->descriptor);
+        }
+        free(storage);
+        return NULL;
+    }
+
+    LOG_INFO("File %s is open for [%ux%u].", filename, rows, cols);
+    return storage;
+}
+
+uint32_t write_rows(STORAGE *storage, const float *val, uint32_t rows)
+{
+    if ((storage == NULL) || (val == NULL))
+    {
+        return 0U;
+    }
+
+    /* Not writing past the rows in the header */
+    if ((storage->header.rows - storage->written) < rows)
+    {
+        LOG_WARNING("Only %u of %u rows fit.", storage->header.rows - storage->written, rows);
+        rows = storage->header.rows - storage->written;
+    }
+
+    size_t count = fwrite(val, sizeof(float) * storage->header.cols, rows, storage->descriptor);
+    storage->written += (uint32_t)count;
+
+    return (uint32_t)count;
+}
+
+int32_t close_storage(STORAGE *storage)
+{
+    int32_t code = 0;
+
+    if (storage == NULL)
+    {
+        return EINVAL;
+    }
+
+    if (storage->written != storage->header.rows)
+    {
+        LOG_WARNING("Only %u of %u rows were written.", storage->written, storage->header.rows);
+        code = EIO;
+    }
+
+    if ((fclose(storage->descriptor) != 0) && (code == 0))
+    {
+        code = errno;
+    }
+    free(storage);
+
+    return code;
+}
+
+MATRIX* save_matrix(const char *filename, MATRIX *A)
+{
+    if (A == NULL)
+    {
+        return NULL;
+    }
+
+    STORAGE *storage = open_storage(filename, A->rows, A->cols);
+    write_rows(storage, A->val, A->rows);
+
+    return (close_storage(storage) == 0) ? A : NULL;
+}
+
+MATRIX* map_matrix(const char *filename)
+{
+    MAPPING *mapping = NULL;
+    STORAGE_HEADER *header = NULL;
+    struct stat info;
+    FILE *descriptor = fopen(filename, "rb");
+
+    if ((descriptor == NULL) || (fstat(fileno(descriptor), &info) != 0) ||
+        ((size_t)info.st_size < sizeof(STORAGE_HEADER)))
+    {
+        LOG_WARNING("File %s was not opened. [CODE %d]", filename, errno);
+        if (descriptor != NULL)
+        {
+            fclose(descriptor);
+        }
+        return NULL;
+    }
+
+    mapping = (MAPPING*)malloc(sizeof(MAPPING));
+    if (mapping != NULL)
+    {
+        /* Private pages are copied on write, the file is never modified */
+        mapping->length = (size_t)info.st_size;
+        mapping->base = mmap(NULL, mapping->length, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                             fileno(descriptor), 0);
+    }
+    /* The mapping holds its own reference to the file */
+    fclose(descriptor);
+
+    if ((mapping == NULL) || (mapping->base == MAP_FAILED))
+    {
+        LOG_WARNING("File %s was not mapped. [CODE %d]", filename, errno);
+        free(mapping);
+        return NULL;
+    }
+
+    header = (STORAGE_HEADER*)mapping->base;
+    if (check_header(header, mapping->length) == 0U)
+    {
+        LOG_WARNING("File %s is not a valid matrix.", filename);
+        munmap(mapping->base, mapping->length);
+        free(mapping);
+        return NULL;
+    }
+
+    mapping->matrix.rows = header->rows;
+    mapping->matrix.cols = header->cols;
+
+    /* Padded rows are not c-contiguous, they are copied */
+    if (header->ld != header->cols)
+    {
+        LOG_INFO("File %s has padded rows (ld = %u), copying them.", filename, header->ld);
+        return copy_rows(mapping, header);
+    }
+
+    mapping->matrix.val = (float*)((char*)mapping->base + header->offset);
+    LOG_INFO("File %s was mapped as [%ux%u].", filename, header->rows, header->cols);
+
+    return &mapping->matrix;
+}
+
+void unmap_matrix(MATRIX *A)
+{
+    MAPPING *mapping = (MAPPING*)A;
+
+    if (mapping == NULL)
+    {
+        return;
+    }
+
+    if (mapping->base != NULL)
+    {
+        munmap(mapping->base, mapping->length);
+    }
+    else
+    {
+        /* Rows that were copied by copy_rows() */
+        free(mapping->matrix.val);
+    }
+    free(mapping);
+}
+
+static STORAGE_HEADER make_header(uint32_t rows, uint32_t cols)
+{
+    STORAGE_HEADER header = {STORAGE_MAGIC, STORAGE_VERSION, STORAGE_ENDIAN,
+                             STORAGE_DTYPE_FLOAT32, rows, cols, cols, STORAGE_ALIGN, 0U};
+
+    /* First aligned offset after the header */
+    header.offset = ((sizeof(STORAGE_HEADER) + STORAGE_ALIGN - 1U) / STORAGE_ALIGN) * STORAGE_ALIGN;
+
+    return header;
+}
+
+static uint32_t check_header(const STORAGE_HEADER *header, size_t length)
+{
+    if ((memcmp(header->magic, STORAGE_MAGIC, sizeof(header->magic)) != 0) ||
+        (header->version != STORAGE_VERSION) || (header->endian != STORAGE_ENDIAN) ||
+        (header->dtype != STORAGE_DTYPE_FLOAT32) || (header->ld < header->cols) ||
+        (header->alignment != STORAGE_ALIGN) || (header->offset < sizeof(STORAGE_HEADER)) ||
+        ((header->offset % sizeof(float)) != 0U) || (header->offset > length))
+    {
+        return 0U;
+    }
+
+    /* The last row needs cols elements, not ld. They are compared with what
+     * is left after offset, offset + bytes would wrap on a hostile header */
+    size_t elements = (header->rows == 0U) ? 0U :
+                      (size_t)header->ld * (header->rows - 1U) + header->cols;
+
+    return (elements <= (length - header->offset) / sizeof(float)) ? 1U : 0U;
+}
+
+static MATRIX* copy_rows(MAPPING *mapping, const STORAGE_HEADER *header)
+{
+    const float *src = (const float*)((char*)mapping->base + header->offset);
+    float *val = (float*)malloc(sizeof(float) * (size_t)header->rows * header->cols);
+
+    if (val != NULL)
+    {
+        for (uint32_t i = 0U; i < header->rows; i++)
+        {
+            memcpy(&val[(size_t)header->cols * i], &src[(size_t)header->ld * i], sizeof(float) * header->cols);
+        }
+    }
+
+    munmap(mapping->base, mapping->length);
+    mapping->base = NULL;
+    mapping->matrix.val = val;
+
+    if (val == NULL)
+    {
+        free(mapping);
+        return NULL;
+    }
+
+    return &mapping->matrix;
+}
+
+#pragma pop_macro("LOG_MODULE")
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STORAGE_H_ */
@@ -0,0 +1,419 @@
+/******************************************************************************/
+/*    INCLUDED FILES                                                          */
+/******************************************************************************/
+
+#include <float.h>
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "kernels.h"
+
+/******************************************************************************/
+/*    PRIVATE DATA                                                            */
+/******************************************************************************/
+
+/* With -DALGEBRA_OPENMP=ON, the next loop is split among threads when its
+ * count elements are enough. Every element is computed as in one thread */
+#ifdef _OPENMP
+    #define PARALLEL_PRAGMA(x)  _Pragma(#x)
+    #define PARALLEL_FOR(count) \
+        PARALLEL_PRAGMA(omp parallel for schedule(static) if((count) >= KERNEL_PARALLEL_MIN))
+#else
+    #define PARALLEL_FOR(count)
+#endif
+
+/******************************************************************************/
+/*    STATIC FUNCTION PROTOTYPES                                              */
+/******************************************************************************/
+
+static const float* pack_block(uint32_t trans, const float *X, uint32_t ldx, uint32_t r0, uint32_t c0,
+                               uint32_t rows, uint32_t cols, float *buffer, uint32_t *ld);
+static void swap_rows(uint32_t n, float *x, float *y);
+
+/******************************************************************************/
+/*    IMPLEMENTATION                                                          */
+/******************************************************************************/
+
+float blas_dot(uint32_t n, const float *x, uint32_t incx, const float *y, uint32_t incy)
+{
+    float sum = 0.0F;
+
+    if ((incx == 1U) && (incy == 1U))
+    {
+        float lanes[BLAS_LANES] = {0.0F};
+        uint32_t i = 0U;
+
+        for (; i + BLAS_LANES <= n; i += BLAS_LANES)
+        {
+            for (uint32_t l = 0U; l < BLAS_LANES; l++)
+            {
+                lanes[l] += x[i + l] * y[i + l];
+            }
+        }
+        for (; i < n; i++)
+        {
+            sum += x[i] * y[i];
+        }
+        for (uint32_t l = 0U; l < BLAS_LANES; l++)
+        {
+            sum += lanes[l];
+        }
+    }
+    else
+    {
+        for (uint32_t i = 0U; i < n; i++)
+        {
+            sum += x[(size_t)incx * i] * y[(size_t)incy * i];
+        }
+    }
+
+    return sum;
+}
+
+void blas_axpy(uint32_t n, float alpha, const float *restrict x, uint32_t incx, float *restrict y, uint32_t incy)
+{
+    if ((incx == 1U) && (incy == 1U))
+    {
+        for (uint32_t i = 0U; i < n; i++)
+        {
+            y[i] += alpha * x[i];
+        }
+    }
+    else
+    {
+        for (uint32_t i = 0U; i < n; i++)
+        {
+            y[(size_t)incy * i] += alpha * x[(size_t)incx * i];
+        }
+    }
+}
+
+void blas_scal(uint32_t n, float alpha, float *x, uint32_t incx)
+{
+    if (incx == 1U)
+    {
+        for (uint32_t i = 0U; i < n; i++)
+        {
+            x[i] *= alpha;
+        }
+    }
+    else
+    {
+        for (uint32_t i = 0U; i < n; i++)
+        {
+            x[(size_t)incx * i] *= alpha;
+        }
+    }
+}
+
+float blas_nrm2(uint32_t n, const float *x, uint32_t incx)
+{
+    double lanes[BLAS_LANES] = {0.0};
+    double sum = 0.0;
+    uint32_t i = 0U;
+
+    for (; i + BLAS_LANES <= n; i += BLAS_LANES)
+    {
+        for (uint32_t l = 0U; l < BLAS_LANES; l++)
+        {
+            const double value = (double)x[(size_t)incx * (i + l)];
+            lanes[l] += value * value;
+        }
+    }
+    for (; i < n; i++)
+    {
+        const double value = (double)x[(size_t)incx * i];
+        sum += value * value;
+    }
+    for (uint32_t l = 0U; l < BLAS_LANES; l++)
+    {
+        sum += lanes[l];
+    }
+
+    return (float)sqrt(sum);
+}
+
+uint32_t blas_iamax(uint32_t n, const float *x, uint32_t incx)
+{
+    uint32_t index = 0U;
+    float max = -1.0F;
+
+    for (uint32_t i = 0U; i < n; i++)
+    {
+        const float value = fabsf(x[(size_t)incx * i]);
+        if (value > max)
+        {
+            max = value;
+            index = i;
+        }
+    }
+
+    return index;
+}
+
+void kernel_gemm(uint32_t transA, uint32_t transB, uint32_t m, uint32_t n, uint32_t k, float alpha,
+                 const float *restrict A, uint32_t lda, const float *restrict B, uint32_t ldb,
+                 float beta, float *restrict C, uint32_t ldc)
+{
+    /* Transposed blocks are packed here, 2 x 9KB of stack */
+    float aPack[MULT_BLOCK * MULT_BLOCK];
+    float bPack[MULT_BLOCK * MULT_BLOCK];
+
+    /* 1) C := beta C, as in the BLAS it is not read when beta is 0 */
+    for (uint32_t i = 0U; i < m; i++)
+    {
+        float *restrict cRow = &C[(size_t)ldc * i];
+        if (beta == 0.0F)
+        {
+            memset(cRow, 0U, sizeof(float) * n);
+        }
+        else if (beta != 1.0F)
+        {
+            for (uint32_t j = 0U; j < n; j++)
+            {
+                cRow[j] *= beta;
+            }
+        }
+    }
+
+    if (alpha == 0.0F)
+    {
+        return;
+    }
+
+    /* 2) C += alpha op(A) op(B), blocks of op(A), op(B) and C stay in cache,
+     *    the inner loop runs along rows of op(B) and C, which the compiler
+     *    vectorizes */
+    for (uint32_t i0 = 0U; i0 < m; i0 += MULT_BLOCK)
+    {
+        const uint32_t iLen = (m - i0 < MULT_BLOCK) ? m - i0 : MULT_BLOCK;
+        for (uint32_t p0 = 0U; p0 < k; p0 += MULT_BLOCK)
+        {
+            const uint32_t pLen = (k - p0 < MULT_BLOCK) ? k - p0 : MULT_BLOCK;
+            uint32_t ldaBlock = 0U;
+            const float *restrict aBlock = pack_block(transA, A, lda, i0, p0, iLen, pLen, aPack, &ldaBlock);
+            for (uint32_t j0 = 0U; j0 < n; j0 += MULT_BLOCK)
+            {
+                const uint32_t jLen = (n - j0 < MULT_BLOCK) ? n - j0 : MULT_BLOCK;
+                uint32_t ldbBlock = 0U;
+                const float *restrict bBlock = pack_block(transB, B, ldb, p0, j0, pLen, jLen, bPack, &ldbBlock);
+                for (uint32_t i = 0U; i < iLen; i++)
+                {
+                    float *restrict cRow = &C[(size_t)ldc * (i0 + i) + j0];
+                    for (uint32_t p = 0U; p < pLen; p++)
+                    {
+                        const float aip = alpha * aBlock[(size_t)ldaBlock * i + p];
+                        const float *restrict bRow = &bBlock[(size_t)ldbBlock * p];
+                        for (uint32_t j = 0U; j < jLen; j++)
+                        {
+                            cRow[j] += aip * bRow[j];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void kernel_transpose(uint32_t rows, uint32_t cols, const float *restrict A, uint32_t lda,
+                      float *restrict B, uint32_t ldb)
+{
+    /* TRANSPOSE_BLOCK x TRANSPOSE_BLOCK blocks, so that the strided
+     * side reuses its cache lines instead of missing on every entry */
+    PARALLEL_FOR((size_t)rows * cols)
+    for (uint32_t row0 = 0U; row0 < rows; row0 += TRANSPOSE_BLOCK)
+    {
+        const uint32_t rowEnd = (rows - row0 < TRANSPOSE_BLOCK) ? rows : row0 + TRANSPOSE_BLOCK;
+        for (uint32_t col0 = 0U; col0 < cols; col0 += TRANSPOSE_BLOCK)
+        {
+            const uint32_t colEnd = (cols - col0 < TRANSPOSE_BLOCK) ? cols : col0 + TRANSPOSE_BLOCK;
+            for (uint32_t row = row0; row < rowEnd; row++)
+            {
+                for (uint32_t col = col0; col < colEnd; col++)
+                {
+                    B[(size_t)ldb * col + row] = A[(size_t)lda * row + col];
+                }
+            }
+        }
+    }
+}
+
+void kernel_add(uint32_t rows, uint32_t cols, const float *restrict A, uint32_t lda,
+                const float *restrict B, uint32_t ldb, float *restrict C, uint32_t ldc)
+{
+    const size_t count = (size_t)rows * cols;
+
+    /* c-contiguous operands, one flat loop */
+    if ((lda == cols) && (ldb == cols) && (ldc == cols))
+    {
+        PARALLEL_FOR(count)
+        for (size_t i = 0U; i < count; i++)
+        {
+            C[i] = A[i] + B[i];
+        }
+        return;
+    }
+
+    PARALLEL_FOR(count)
+    for (uint32_t i = 0U; i < rows; i++)
+    {
+        for (uint32_t j = 0U; j < cols; j++)
+        {
+            C[(size_t)ldc * i + j] = A[(size_t)lda * i + j] + B[(size_t)ldb * i + j];
+        }
+    }
+}
+
+void kernel_sub(uint32_t rows, uint32_t cols, const float *restrict A, uint32_t lda,
+                const float *restrict B, uint32_t ldb, float *restrict C, uint32_t ldc)
+{
+    const size_t count = (size_t)rows * cols;
+
+    /* c-contiguous operands, one flat loop */
+    if ((lda == cols) && (ldb == cols) && (ldc == cols))
+    {
+        PARALLEL_FOR(count)
+        for (size_t i = 0U; i < count; i++)
+        {
+            C[i] = A[i] - B[i];
+        }
+        return;
+    }
+
+    PARALLEL_FOR(count)
+    for (uint32_t i = 0U; i < rows; i++)
+    {
+        for (uint32_t j = 0U; j < cols; j++)
+        {
+            C[(size_t)ldc * i + j] = A[(size_t)lda * i + j] - B[(size_t)ldb * i + j];
+        }
+    }
+}
+
+void kernel_scale(uint32_t rows, uint32_t cols, float alpha, const float *restrict A, uint32_t lda,
+                  float *restrict B, uint32_t ldb)
+{
+    const size_t count = (size_t)rows * cols;
+
+    /* c-contiguous operands, one flat loop */
+    if ((lda == cols) && (ldb == cols))
+    {
+        PARALLEL_FOR(count)
+        for (size_t i = 0U; i < count; i++)
+        {
+            B[i] = alpha * A[i];
+        }
+        return;
+    }
+
+    PARALLEL_FOR(count)
+    for (uint32_t i = 0U; i < rows; i++)
+    {
+        for (uint32_t j = 0U; j < cols; j++)
+        {
+            B[(size_t)ldb * i + j] = alpha * A[(size_t)lda * i + j];
+        }
+    }
+}
+
+uint32_t kernel_getrf(uint32_t rows, uint32_t cols, float *A, uint32_t lda, uint32_t *piv)
+{
+    const uint32_t steps = (rows < cols) ? rows : cols;
+    uint32_t info = 0U;
+
+    for (uint32_t k = 0U; k < steps; k++)
+    {
+        /* 1) max-abs entry of the k-th column, on or below the diagonal */
+        const uint32_t p = k + blas_iamax(rows - k, &A[(size_t)lda * k + k], lda);
+
+        /* A column that is not eliminated does not swap rows either */
+        if (fabsf(A[(size_t)lda * p + k]) < FLT_EPSILON)
+        {
+            if (piv != NULL)
+            {
+                piv[k] = k;
+            }
+            info = (info == 0U) ? k + 1U : info;
+            continue;
+        }
+        if (piv != NULL)
+        {
+            piv[k] = p;
+        }
+
+        /* 2) swapping rows k and p */
+        if (p != k)
+        {
+            swap_rows(cols, &A[(size_t)lda * k], &A[(size_t)lda * p]);
+        }
+
+        /* 3) L(k+1:,k), then the trailing rows along the rows */
+        blas_scal(rows - k - 1U, 1.0F / A[(size_t)lda * k + k], &A[(size_t)lda * (k + 1U) + k], lda);
+        for (uint32_t i = k + 1U; i < rows; i++)
+        {
+            blas_axpy(cols - k - 1U, -A[(size_t)lda * i + k], &A[(size_t)lda * k + k + 1U], 1U,
+                      &A[(size_t)lda * i + k + 1U], 1U);
+        }
+    }
+
+    return info;
+}
+
+void kernel_getrs(uint32_t n, uint32_t nrhs, const float *LU, uint32_t lda, const uint32_t *piv,
+                  float *B, uint32_t ldb)
+{
+    /* 1) B := P B, with the swaps in the order of kernel_getrf() */
+    for (uint32_t k = 0U; k < n; k++)
+    {
+        if (piv[k] != k)
+        {
+            swap_rows(nrhs, &B[(size_t)ldb * k], &B[(size_t)ldb * piv[k]]);
+        }
+    }
+
+    /* 2) L Y = B, rows of B at a time, L has a unit diagonal */
+    for (uint32_t i = 1U; i < n; i++)
+    {
+        for (uint32_t j = 0U; j < i; j++)
+        {
+            blas_axpy(nrhs, -LU[(size_t)lda * i + j], &B[(size_t)ldb * j], 1U, &B[(size_t)ldb * i], 1U);
+        }
+    }
+
+    /* 3) U X = Y, from the last row up */
+    for (uint32_t i = n; 0U < i--; )
+    {
+        for (uint32_t j = i + 1U; j < n; j++)
+        {
+            blas_axpy(nrhs, -LU[(size_t)lda * i + j], &B[(size_t)ldb * j], 1U, &B[(size_t)ldb * i], 1U);
+        }
+        blas_scal(nrhs, 1.0F / LU[(size_t)lda * i + i], &B[(size_t)ldb * i], 1U);
+    }
+}
+
+/* Block rows x cols of op(X) at (r0, c0). It is read in place when op(X) is X,
+ * else it is transposed into buffer, whose rows are MULT_BLOCK apart */
+static const float* pack_block(uint32_t trans, const float *X, uint32_t ldx, uint32_t r0, uint32_t c0,
+                               uint32_t rows, uint32_t cols, float *buffer, uint32_t *ld)
+{
+    if (trans == BLAS_NO_TRANS)
+    {
+        *ld = ldx;
+        return &X[(size_t)ldx * r0 + c0];
+    }
+
+    kernel_transpose(cols, rows, &X[(size_t)ldx * c0 + r0], ldx, buffer, MULT_BLOCK);
+    *ld = MULT_BLOCK;
+    return buffer;
+}
+
+static void swap_rows(uint32_t n, float *restrict x, float *restrict y)
+{
+    for (uint32_t j = 0U; j < n; j++)
+    {
+        const float tmp = x[j];
+        x[j] = y[j];
+        y[j] = tmp;
+    }
+}
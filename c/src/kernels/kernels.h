@@ -0,0 +1,152 @@
+/*******************************************************************************
+*
+* Matrix kernels
+*
+*   SUMMARY
+*       This module is the compiled backend of both algebras, the MATRIX of
+*       c/src/algebra and the Matrix of cpp/src/algebra hand their values
+*       to it without copying them. Its C ABI works on raw pointers:
+*
+*       a) BLAS level-1 over strided vectors, blas_dot() ... blas_iamax(),
+*       b) kernel_gemm() of op(A) op(B), kernel_transpose(), kernel_add(),
+*          kernel_sub() and kernel_scale() over row-major matrices, whose
+*          rows are ld elements apart (ld = cols when they are c-contiguous),
+*       c) kernel_getrf() and kernel_getrs() to factor and solve in place.
+*
+*       It neither allocates nor logs, so it depends on neither front end.
+*       The outputs do not overlap the inputs. With -DALGEBRA_OPENMP=ON the
+*       elementwise kernels and the transpose are split among threads.
+*
+*******************************************************************************/
+
+#ifndef KERNELS_H_
+#define KERNELS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/*    INCLUDED FILES                                                          */
+/******************************************************************************/
+
+#include <stdint.h>
+
+/******************************************************************************/
+/*    DEFINITIONS                                                             */
+/******************************************************************************/
+
+/* op(A) of blas_gemv() and kernel_gemm() */
+#define BLAS_NO_TRANS       (0U)
+#define BLAS_TRANS          (1U)
+
+/* Partial sums of the reductions, one 256-bit register of floats */
+#define BLAS_LANES          (8U)
+
+/* Side of the blocks of kernel_gemm(), three of them fit in a 32KB L1 cache */
+#define MULT_BLOCK          (48U)
+
+/* Side of the blocks of kernel_transpose(), a block of A and one of AT are cached */
+#define TRANSPOSE_BLOCK     (8U)
+
+/* Loops over fewer elements than this are not worth waking OpenMP threads */
+#define KERNEL_PARALLEL_MIN (64U * 1024U)
+
+/******************************************************************************/
+/*    API                                                                     */
+/******************************************************************************/
+
+/**
+ * @brief   Function that computes x^T y of n elements.
+ */
+float blas_dot(uint32_t n, const float *x, uint32_t incx, const float *y, uint32_t incy);
+
+/**
+ * @brief   Function that computes y := alpha x + y of n elements.
+ */
+void blas_axpy(uint32_t n, float alpha, const float *x, uint32_t incx, float *y, uint32_t incy);
+
+/**
+ * @brief   Function that computes x := alpha x of n elements.
+ */
+void blas_scal(uint32_t n, float alpha, float *x, uint32_t incx);
+
+/**
+ * @brief   Function that computes the euclidean norm of n elements, the
+ *          squares are summed in double so that they do not overflow.
+ */
+float blas_nrm2(uint32_t n, const float *x, uint32_t incx);
+
+/**
+ * @brief   Function that finds the first element of max-abs value.
+ *
+ * @return  Its index in 0...n - 1, 0 when n is 0.
+ */
+uint32_t blas_iamax(uint32_t n, const float *x, uint32_t incx);
+
+/**
+ * @brief   Function that computes C := alpha op(A) op(B) + beta C, op(A) is
+ *          m x k, op(B) is k x n and C is m x n. op(X) is X or X^T as trans
+ *          is BLAS_NO_TRANS or BLAS_TRANS, transposed blocks are packed on
+ *          the fly, X^T is never formed. C is not read when beta is 0.
+ *
+ * @examples kernel_gemm(BLAS_TRANS, BLAS_NO_TRANS, n, n, m, 1.0F, A, n, A, n, 0.0F, G, n);
+ */
+void kernel_gemm(uint32_t transA, uint32_t transB, uint32_t m, uint32_t n, uint32_t k, float alpha,
+                 const float *A, uint32_t lda, const float *B, uint32_t ldb,
+                 float beta, float *C, uint32_t ldc);
+
+/**
+ * @brief   Function that writes the transpose of A, rows x cols, into B,
+ *          cols x rows.
+ */
+void kernel_transpose(uint32_t rows, uint32_t cols, const float *A, uint32_t lda,
+                      float *B, uint32_t ldb);
+
+/**
+ * @brief   Function that computes C := A + B, all of them rows x cols.
+ */
+void kernel_add(uint32_t rows, uint32_t cols, const float *A, uint32_t lda,
+                const float *B, uint32_t ldb, float *C, uint32_t ldc);
+
+/**
+ * @brief   Function that computes C := A - B, all of them rows x cols.
+ */
+void kernel_sub(uint32_t rows, uint32_t cols, const float *A, uint32_t lda,
+                const float *B, uint32_t ldb, float *C, uint32_t ldc);
+
+/**
+ * @brief   Function that computes B := alpha A, both of them rows x cols.
+ */
+void kernel_scale(uint32_t rows, uint32_t cols, float alpha, const float *A, uint32_t lda,
+                  float *B, uint32_t ldb);
+
+/**
+ * @brief   Function that factors A, rows x cols, in place as PA = LU with
+ *          partial pivoting, rows are swapped to bring the max-abs entry of
+ *          each column to the diagonal. U is on and above the diagonal and
+ *          L, whose unit diagonal is implicit, below it.
+ *
+ * @param   piv     row k was swapped with row piv[k], it holds
+ *                  min(rows, cols) entries. NULL when P is not needed.
+ *                  piv[k] = k for a column that is not eliminated.
+ *
+ * @return  0 when U is invertible, k + 1 when U(k,k) is the first pivot
+ *          below FLT_EPSILON, its column is not eliminated.
+ */
+uint32_t kernel_getrf(uint32_t rows, uint32_t cols, float *A, uint32_t lda, uint32_t *piv);
+
+/**
+ * @brief   Function that solves A X = B in place of B, n x nrhs, with the
+ *          LU and piv of an invertible n x n A from kernel_getrf().
+ *
+ * @examples if (kernel_getrf(n, n, LU, n, piv) == 0U) kernel_getrs(n, 1U, LU, n, piv, b, 1U);
+ */
+void kernel_getrs(uint32_t n, uint32_t nrhs, const float *LU, uint32_t lda, const uint32_t *piv,
+                  float *B, uint32_t ldb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KERNELS_H_ */
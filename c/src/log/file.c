@@ -2,9 +2,17 @@
 /*    INCLUDED FILES                                                          */
 /******************************************************************************/
 
+#include <sched.h>
+
 #include "file.h"
 #include "levels.h"
 
+/* fallocate() through syscall(), <fcntl.h> would clash with open() */
+#ifdef __linux__
+    #include <linux/falloc.h>
+    #include <sys/syscall.h>
+#endif
+
 /******************************************************************************/
 /*    PRIVATE DATA                                                            */
 /******************************************************************************/
@@ -13,13 +21,67 @@
 
 #define FORCED_INIT_VAL     NULL
 
+/* States of the sinks, they are opened by the first message */
+#define LOG_INIT_NONE       (0U)
+#define LOG_INIT_BUSY       (1U)
+#define LOG_INIT_DONE       (2U)
+
+/* Only the last {NULL, NULL} is a sentinel,
+ * the second for the actual LOG* file */
+static LOG logs[3U] = {{NULL, "stderr", NULL}, {NULL, NULL, NULL}, {NULL, NULL, NULL}};
+
+static ROTATION rotation = {LOG_FILE_SEGMENT_LEN, LOG_FILE_MAX_AGE, LOG_FILE_MAX_FILES};
+
+static uint32_t initState = LOG_INIT_NONE;
+
+/* Set while this thread opens the sinks, its own messages go to stderr */
+#ifndef LOG_UNIT_TEST
+static _Thread_local uint32_t opening = 0U;
+#endif
+
+/* Set while this thread swaps the file under drainLock, its own messages
+ * go to stderr only, they would wait on drainLock otherwise */
+static _Thread_local uint32_t swapping = 0U;
+/* Odd while log_set_file() swaps the file, the sinks read without drainLock
+ * are trusted only when it did not change meanwhile */
+static uint32_t swaps = 0U;
+
+/* From log_set_file(), NULL for $LOG_FILE or the default name */
+static char *fileName = NULL;
+
+/* Rings of every thread that logged, the ones of exited threads are reused */
+static RING *rings = NULL;
+static _Thread_local RING *threadRing = NULL;
+
+/* Key whose destructor releases threadRing at thread exit */
+static pthread_key_t  ringKey;
+static pthread_once_t ringOnce = PTHREAD_ONCE_INIT;
+
+/* One thread drains the rings at a time, the writer or one with a full ring */
+static pthread_mutex_t drainLock = PTHREAD_MUTEX_INITIALIZER;
+
+/* The writer thread sleeps LOG_RING_PERIOD_MS, or until a ring is half full */
+static pthread_t       writer;
+static uint32_t        writerState = LOG_WRITER_STOPPED;
+static uint32_t        writerStop = 0U;
+static pthread_mutex_t writerLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  writerWake = PTHREAD_COND_INITIALIZER;
+
 /******************************************************************************/
 /*    IMPLEMENTATION                                                          */
 /******************************************************************************/
 
 void constructor(void)
 {
+#ifndef LOG_UNIT_TEST
+    /* Claiming initState as the first message does, the messages of init()
+     * do not open the sinks again, they would wait on drainLock */
+    log_sinks();
+#else
     init(LOG_TO_FILE);
+    start_writer();
+    __atomic_store_n(&initState, LOG_INIT_DONE, __ATOMIC_RELEASE);
+#endif
     LOG_DEBUG("Calling constructor().");
 
     return;
@@ -27,45 +89,232 @@ void constructor(void)
 
 void destructor(void)
 {
+    /* Nothing was logged, nothing was opened */
+    if (__atomic_load_n(&initState, __ATOMIC_ACQUIRE) == LOG_INIT_NONE)
+    {
+        return;
+    }
+
     LOG *file = get();
     LOG_DEBUG("Calling destructor().");
 
-    file++;
-    if (file->name != NULL)
+    /* What was queued goes first, the rest is written at once. As in
+     * log_set_file(), the threads that still log do not write a freed sink */
+    __atomic_add_fetch(&swaps, 1U, __ATOMIC_SEQ_CST);
+    stop_writer();
+    pthread_mutex_lock(&drainLock);
+    swapping = 1U;
+    close_file(++file);
+    swapping = 0U;
+    pthread_mutex_unlock(&drainLock);
+    __atomic_add_fetch(&swaps, 1U, __ATOMIC_SEQ_CST);
+
+    LOG_DEBUG("Freeing \"static LOG *files\".");
+    return;
+}
+
+LOG* get()
+{
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+
+    /* stderr is not a constant expression */
+    pthread_once(&once, set_stderr);
+
+    return logs;
+}
+
+LOG* log_sinks(void)
+{
+#ifndef LOG_UNIT_TEST
+    if ((__atomic_load_n(&initState, __ATOMIC_ACQUIRE) != LOG_INIT_DONE) && (opening == 0U))
     {
-        LOG_INFO("Closing file %s", file->name);
-        free(file->name);
-        file->name = NULL;
+        uint32_t expected = LOG_INIT_NONE;
+
+        if (__atomic_compare_exchange_n(&initState, &expected, LOG_INIT_BUSY, 0,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE))
+        {
+            opening = 1U;
+            init(LOG_TO_FILE);
+            start_writer();
+            opening = 0U;
+            __atomic_store_n(&initState, LOG_INIT_DONE, __ATOMIC_RELEASE);
+        }
+        else
+        {
+            /* Another thread is opening them */
+            while (__atomic_load_n(&initState, __ATOMIC_ACQUIRE) != LOG_INIT_DONE)
+            {
+                sched_yield();
+            }
+        }
     }
+#endif
 
-    if (file->descriptor != NULL)
+    return get();
+}
+
+void log_set_file(const char *filename)
+{
+    LOG *file = &get()[1U];
+    char *name = (filename == NULL) ? NULL : strdup(filename);
+
+    /* init() reads the name and opens the file under drainLock, so either
+     * it opens the new name or the file it opened is seen here */
+    pthread_mutex_lock(&drainLock);
+    free(fileName);
+    fileName = name;
+    const uint32_t opened = (file->descriptor != NULL) ? 1U : 0U;
+    pthread_mutex_unlock(&drainLock);
+
+    /* Before the first message, the name waits for log_sinks(). Later, the
+     * threads that log meanwhile wait on drainLock, then write the new file */
+    if (opened != 0U)
     {
-        LOG_INFO("Flushing file %p", file->descriptor);
-        fflush(file->descriptor);
-        fclose(file->descriptor);
-        file->descriptor = NULL;
+        __atomic_add_fetch(&swaps, 1U, __ATOMIC_SEQ_CST);
+        const uint32_t running = stop_writer();
+        pthread_mutex_lock(&drainLock);
+        swapping = 1U;
+        close_file(file);
+        init(1U);
+        swapping = 0U;
+        pthread_mutex_unlock(&drainLock);
+        if (running != 0U)
+        {
+            start_writer();
+        }
+        __atomic_add_fetch(&swaps, 1U, __ATOMIC_SEQ_CST);
     }
+}
 
-    LOG_DEBUG("Freeing \"static LOG *files\".");
-    return;
+void log_set_rotation(const size_t maxSize, const uint32_t maxAge, const uint32_t maxFiles)
+{
+    rotation.maxSize = maxSize;
+    rotation.maxAge = maxAge;
+    rotation.maxFiles = maxFiles;
+    LOG_INFO("Rotating log files at %zu bytes or %u seconds, keeping %u files.",
+             maxSize, maxAge, maxFiles);
 }
 
-LOG* get()
+void log_file_write(LOG *file, const struct iovec *record, const uint32_t count)
 {
-    /* Only the last {NULL, NULL} is a sentinel,
-     * the second for the actual LOG* file */
-    const LOG initial[3U] = {{stderr, "stderr"}, {NULL, NULL}, {NULL, NULL}};
+    SINK *sink = file->sink;
+    size_t total = 0U;
 
-    static LOG *files = NULL;
-    if (files == NULL)
+    /* No logging in here, LOG_* would come back and deadlock on sink->lock */
+    pthread_mutex_lock(&sink->lock);
+    for (uint32_t i = 0U; i < count; i++)
     {
-        files = malloc(sizeof(LOG) * 3U);
-        memcpy(files, initial, sizeof(LOG) * 3U);
+        const char *src = record[i].iov_base;
+        size_t len = record[i].iov_len;
+
+        total += len;
+        while (len > 0U)
+        {
+            size_t chunk = LOG_FILE_BUFFER_LEN - sink->used;
+            chunk = (len < chunk) ? len : chunk;
+
+            memcpy(&sink->buffer[sink->used], src, chunk);
+            sink->used += chunk;
+            src += chunk;
+            len -= chunk;
+
+            if (sink->used == LOG_FILE_BUFFER_LEN)
+            {
+                flush(file);
+            }
+        }
     }
 
+    /* Rotating between records, so that a record is never split */
+    sink->segment += total;
+    if (((rotation.maxSize != 0U) && (rotation.maxSize <= sink->segment)) ||
+        ((rotation.maxAge != 0U) && (rotation.maxAge <= (time(NULL) - sink->opened))))
+    {
+        rotate(file);
+    }
+    pthread_mutex_unlock(&sink->lock);
+}
+
+uint32_t log_file_publish(const struct iovec *record, const uint32_t count)
+{
+    uint32_t files = 0U;
+    uint64_t len = 0U;
+
+    if (swapping != 0U)
+    {
+        return 0U;
+    }
+
+    /* Acquire loads, swaps is read again after them */
+    const uint32_t swap = __atomic_load_n(&swaps, __ATOMIC_ACQUIRE);
+    for (LOG *itr = get(); __atomic_load_n(&itr->name, __ATOMIC_ACQUIRE) != NULL; itr++)
+    {
+        files += (__atomic_load_n(&itr->sink, __ATOMIC_ACQUIRE) != NULL) ? 1U : 0U;
+    }
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        len += record[i].iov_len;
+    }
+
+    /* Without a file, unless it is being swapped, then under drainLock */
+    if ((files == 0U) && ((swap & 1U) == 0U) &&
+        (__atomic_load_n(&swaps, __ATOMIC_ACQUIRE) == swap))
+    {
+        return 0U;
+    }
+
+    if ((__atomic_load_n(&writerState, __ATOMIC_ACQUIRE) == LOG_WRITER_RUNNING) &&
+        (sizeof(RING_RECORD) + len <= LOG_RING_LEN))
+    {
+        RING *ring = get_ring();
+        if (ring != NULL)
+        {
+            /* Either stop_writer() waits for this push, or it is seen stopped */
+            __atomic_store_n(&ring->pushing, 1U, __ATOMIC_SEQ_CST);
+            if (__atomic_load_n(&writerState, __ATOMIC_SEQ_CST) == LOG_WRITER_RUNNING)
+            {
+                push_record(ring, record, count, len);
+                __atomic_store_n(&ring->pushing, 0U, __ATOMIC_RELEASE);
+                return files;
+            }
+            __atomic_store_n(&ring->pushing, 0U, __ATOMIC_RELEASE);
+        }
+    }
+
+    /* After what this thread queued, so that its records keep their order */
+    pthread_mutex_lock(&drainLock);
+    drain();
+    files = 0U;
+    for (LOG *itr = get(); itr->name != NULL; itr++)
+    {
+        if (itr->sink != NULL)
+        {
+            log_file_write(itr, record, count);
+            files++;
+        }
+    }
+    pthread_mutex_unlock(&drainLock);
+
     return files;
 }
 
+void log_flush(void)
+{
+    /* Under drainLock, log_set_file() does not free the sinks meanwhile */
+    pthread_mutex_lock(&drainLock);
+    drain();
+    for (LOG *itr = get(); itr->name != NULL; itr++)
+    {
+        if (itr->sink != NULL)
+        {
+            pthread_mutex_lock(&itr->sink->lock);
+            flush(itr);
+            pthread_mutex_unlock(&itr->sink->lock);
+        }
+    }
+    pthread_mutex_unlock(&drainLock);
+}
+
 STATIC LOG* set(LOG *newFile)
 {
     /* file is "static LOG *files" */
@@ -77,6 +326,7 @@ STATIC LOG* set(LOG *newFile)
     {
         tmp->descriptor = FORCED_INIT_VAL;
         tmp->name = FORCED_INIT_VAL;
+        tmp->sink = FORCED_INIT_VAL;
     }
     else
     {
@@ -142,13 +392,15 @@ STATIC LOG* open(char *filename)
     file->descriptor = fopen(filename, "w");
     if (file->descriptor == NULL)
     {
-        LOG_WARNING("File %s was not created! [CODE %d]", file->name, errno);
+        LOG_WARNING("File %s was not created! [CODE %d]", filename, errno);
         free(file);
         file = NULL;
     }
     else
     {
         file->name = filename;
+        /* Without a sink, the file is written directly */
+        file->sink = make_sink(file->descriptor);
         LOG_INFO("File %s:%p was created.", file->name, file->descriptor);
     }
 
@@ -164,18 +416,446 @@ STATIC LOG* init(uint32_t toFileFlag)
     }
     else
     {
-        make("tmp");
-        char *name = make_name("tmp/%ld.log");
-        if (name != NULL)
+        LOG *newFile = NULL;
+
+        /* fileName and the file change under drainLock, log_set_file() holds
+         * it already. Messages in here go to stderr only, no file is set yet */
+        if (swapping == 0U)
+        {
+            pthread_mutex_lock(&drainLock);
+        }
+        if (files[1U].descriptor == NULL)
         {
-            LOG *newFile = open(name);
-            /* Copying newFile into files[1U] entry(initial variable) */
-            files = set(newFile);
-            LOG_INFO("Logging into stderr and %s file.", files[1U].name);
+            const char *path = (fileName != NULL) ? fileName : getenv(LOG_FILE_ENV_VAR);
+            char *name = NULL;
+            if ((path != NULL) && (path[0U] != '\0'))
+            {
+                name = strdup(path);
+            }
+            else
+            {
+                make("tmp");
+                name = make_name("tmp/%ld.log");
+            }
 
+            if (name != NULL)
+            {
+                newFile = open(name);
+                /* Copying newFile into files[1U] entry(initial variable) */
+                files = set(newFile);
+            }
+        }
+        if (swapping == 0U)
+        {
+            pthread_mutex_unlock(&drainLock);
+        }
+
+        if (newFile != NULL)
+        {
+            LOG_INFO("Logging into stderr and %s file.", newFile->name);
             free(newFile);
         }
     }
 
     return files;
 }
+
+STATIC void set_stderr(void)
+{
+    logs[0U].descriptor = stderr;
+}
+
+STATIC void close_file(LOG *file)
+{
+    if (file->name != NULL)
+    {
+        LOG_INFO("Closing file %s", file->name);
+        free(file->name);
+        file->name = NULL;
+    }
+
+    if (file->descriptor != NULL)
+    {
+        LOG_INFO("Flushing file %p", file->descriptor);
+        if (file->sink != NULL)
+        {
+            flush(file);
+            trim(file->descriptor);
+            free_sink(file->sink);
+            file->sink = NULL;
+        }
+        fflush(file->descriptor);
+        fclose(file->descriptor);
+        file->descriptor = NULL;
+    }
+}
+
+STATIC SINK* make_sink(FILE *descriptor)
+{
+    SINK *sink = malloc(sizeof(SINK));
+    if (sink == NULL)
+    {
+        LOG_WARNING("Sink for %p was not created.", descriptor);
+        return NULL;
+    }
+
+    if (posix_memalign((void**)&sink->buffer, LOG_FILE_ALIGN, LOG_FILE_BUFFER_LEN) != 0)
+    {
+        LOG_WARNING("Buffer of %u bytes for %p was not created.", LOG_FILE_BUFFER_LEN, descriptor);
+        free(sink);
+        return NULL;
+    }
+
+    sink->used = 0U;
+    sink->segment = 0U;
+    sink->opened = time(NULL);
+    pthread_mutex_init(&sink->lock, NULL);
+    preallocate(descriptor, rotation.maxSize);
+
+    return sink;
+}
+
+STATIC void free_sink(SINK *sink)
+{
+    pthread_mutex_destroy(&sink->lock);
+    free(sink->buffer);
+    free(sink);
+}
+
+STATIC void flush(LOG *file)
+{
+    SINK *sink = file->sink;
+    size_t done = 0U;
+
+    while (done < sink->used)
+    {
+        ssize_t written = write(fileno(file->descriptor), &sink->buffer[done], sink->used - done);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            /* Dropping the buffer, there is nowhere to report it */
+            break;
+        }
+        done += (size_t)written;
+    }
+
+    sink->used = 0U;
+}
+
+STATIC int32_t rotate(LOG *file)
+{
+    char from[MAX_STR_LEN], to[MAX_STR_LEN];
+    FILE *descriptor = NULL;
+
+    flush(file);
+
+    /* "<name>.(n-1)" -> "<name>.n", ..., "<name>" -> "<name>.1", "<name>.n" is dropped */
+    if (rotation.maxFiles == 0U)
+    {
+        remove(file->name);
+    }
+    else
+    {
+        snprintf(to, MAX_STR_LEN, "%s.%u", file->name, rotation.maxFiles);
+        remove(to);
+        for (uint32_t i = rotation.maxFiles - 1U; 0U < i; i--)
+        {
+            snprintf(from, MAX_STR_LEN, "%s.%u", file->name, i);
+            snprintf(to, MAX_STR_LEN, "%s.%u", file->name, i + 1U);
+            rename(from, to);
+        }
+        snprintf(to, MAX_STR_LEN, "%s.1", file->name);
+        rename(file->name, to);
+    }
+
+    /* On failure, it keeps on writing into the renamed file */
+    errno = 0;
+    descriptor = fopen(file->name, "w");
+    if (descriptor != NULL)
+    {
+        trim(file->descriptor);
+        fclose(file->descriptor);
+        file->descriptor = descriptor;
+        preallocate(descriptor, rotation.maxSize);
+    }
+
+    file->sink->segment = 0U;
+    file->sink->opened = time(NULL);
+
+    return errno;
+}
+
+STATIC void preallocate(FILE *descriptor, const size_t size)
+{
+#ifdef __linux__
+    /* Reserving the segment without changing the file size, failing is harmless */
+    if (size != 0U)
+    {
+        (void)syscall(SYS_fallocate, fileno(descriptor), FALLOC_FL_KEEP_SIZE, (off_t)0, (off_t)size);
+    }
+#else
+    (void)descriptor;
+    (void)size;
+#endif
+}
+
+STATIC void trim(FILE *descriptor)
+{
+    struct stat info;
+
+    /* Truncating to its own size releases what was preallocated past the end */
+    if (fstat(fileno(descriptor), &info) == 0)
+    {
+        (void)ftruncate(fileno(descriptor), info.st_size);
+    }
+}
+
+STATIC RING* get_ring(void)
+{
+    if (threadRing != NULL)
+    {
+        return threadRing;
+    }
+
+    pthread_once(&ringOnce, make_ring_key);
+
+    /* Reusing the ring of an exited thread, once it was drained */
+    for (RING *itr = __atomic_load_n(&rings, __ATOMIC_ACQUIRE); itr != NULL; itr = itr->next)
+    {
+        uint32_t dead = 0U;
+        if ((__atomic_load_n(&itr->tail, __ATOMIC_ACQUIRE) == __atomic_load_n(&itr->head, __ATOMIC_ACQUIRE)) &&
+            __atomic_compare_exchange_n(&itr->alive, &dead, 1U, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            threadRing = itr;
+            break;
+        }
+    }
+
+    if (threadRing == NULL)
+    {
+        RING *ring = malloc(sizeof(RING));
+        if (ring == NULL)
+        {
+            return NULL;
+        }
+        if (posix_memalign((void**)&ring->buffer, LOG_FILE_ALIGN, LOG_RING_LEN) != 0)
+        {
+            free(ring);
+            return NULL;
+        }
+        ring->head = 0U;
+        ring->tail = 0U;
+        ring->end = 0U;
+        ring->alive = 1U;
+        ring->pushing = 0U;
+
+        /* Rings are only pushed, never removed, so there is no ABA */
+        ring->next = __atomic_load_n(&rings, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&rings, &ring->next, ring, 1,
+                                            __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+        {
+        }
+        threadRing = ring;
+    }
+
+    pthread_setspecific(ringKey, threadRing);
+    return threadRing;
+}
+
+STATIC void release_ring(void *ring)
+{
+    /* A log from a later key destructor of this thread takes a ring again */
+    threadRing = NULL;
+    __atomic_store_n(&((RING*)ring)->alive, 0U, __ATOMIC_RELEASE);
+}
+
+STATIC void make_ring_key(void)
+{
+    pthread_key_create(&ringKey, release_ring);
+}
+
+STATIC uint64_t ring_copy(RING *ring, uint64_t at, const void *src, const size_t len)
+{
+    const size_t offset = (size_t)(at % LOG_RING_LEN);
+    const size_t first = (len < LOG_RING_LEN - offset) ? len : LOG_RING_LEN - offset;
+
+    /* Wrapping around the end of the buffer */
+    memcpy(&ring->buffer[offset], src, first);
+    memcpy(ring->buffer, (const char*)src + first, len - first);
+
+    return at + len;
+}
+
+STATIC void push_record(RING *ring, const struct iovec *record, const uint32_t count,
+                        const uint64_t len)
+{
+    RING_RECORD header = {0U, len};
+    const uint64_t need = sizeof(RING_RECORD) + len;
+    uint64_t at = ring->head;
+    struct timespec now;
+
+    /* Full, draining it here instead of waiting for the writer empties it */
+    if (LOG_RING_LEN - (at - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE)) < need)
+    {
+        pthread_mutex_lock(&drainLock);
+        drain();
+        pthread_mutex_unlock(&drainLock);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    header.stamp = (uint64_t)now.tv_sec * 1000000000U + (uint64_t)now.tv_nsec;
+
+    at = ring_copy(ring, at, &header, sizeof(RING_RECORD));
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        at = ring_copy(ring, at, record[i].iov_base, record[i].iov_len);
+    }
+    const uint64_t before = ring->head;
+    __atomic_store_n(&ring->head, at, __ATOMIC_RELEASE);
+
+    /* Waking the writer when the ring gets half full, a lost wake-up only waits a period */
+    const uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    if ((2U * (at - tail) >= LOG_RING_LEN) && (2U * (before - tail) < LOG_RING_LEN))
+    {
+        pthread_cond_signal(&writerWake);
+    }
+}
+
+STATIC void drain(void)
+{
+    /* No logging in here, it runs under drainLock. Up to the heads of now,
+     * so that the threads that keep on logging do not hold it forever */
+    for (RING *itr = __atomic_load_n(&rings, __ATOMIC_ACQUIRE); itr != NULL; itr = itr->next)
+    {
+        itr->end = __atomic_load_n(&itr->head, __ATOMIC_ACQUIRE);
+    }
+
+    for (;;)
+    {
+        RING *next = NULL;
+        RING_RECORD header = {0U, 0U};
+
+        /* The oldest record at the tail of a ring goes first */
+        for (RING *itr = __atomic_load_n(&rings, __ATOMIC_ACQUIRE); itr != NULL; itr = itr->next)
+        {
+            const uint64_t tail = __atomic_load_n(&itr->tail, __ATOMIC_RELAXED);
+            if (tail != itr->end)
+            {
+                RING_RECORD candidate;
+                const size_t offset = (size_t)(tail % LOG_RING_LEN);
+                const size_t first = (sizeof(RING_RECORD) < LOG_RING_LEN - offset) ?
+                                     sizeof(RING_RECORD) : LOG_RING_LEN - offset;
+
+                memcpy(&candidate, &itr->buffer[offset], first);
+                memcpy((char*)&candidate + first, itr->buffer, sizeof(RING_RECORD) - first);
+                if ((next == NULL) || (candidate.stamp < header.stamp))
+                {
+                    next = itr;
+                    header = candidate;
+                }
+            }
+        }
+
+        if (next == NULL)
+        {
+            break;
+        }
+
+        /* The record is written from the ring, in two pieces when it wraps */
+        const uint64_t start = __atomic_load_n(&next->tail, __ATOMIC_RELAXED) + sizeof(RING_RECORD);
+        const size_t offset = (size_t)(start % LOG_RING_LEN);
+        const size_t first = (header.len < LOG_RING_LEN - offset) ? header.len : LOG_RING_LEN - offset;
+        const struct iovec record[2U] =
+        {
+            {&next->buffer[offset], first},
+            {next->buffer, header.len - first}
+        };
+
+        for (LOG *itr = get(); itr->name != NULL; itr++)
+        {
+            if (itr->sink != NULL)
+            {
+                log_file_write(itr, record, 2U);
+            }
+        }
+        __atomic_store_n(&next->tail, start + header.len, __ATOMIC_RELEASE);
+    }
+}
+
+STATIC void* write_loop(void *arg)
+{
+    struct timespec deadline;
+    (void)arg;
+
+    pthread_mutex_lock(&writerLock);
+    while (writerStop == 0U)
+    {
+        pthread_mutex_unlock(&writerLock);
+        pthread_mutex_lock(&drainLock);
+        drain();
+        pthread_mutex_unlock(&drainLock);
+        pthread_mutex_lock(&writerLock);
+
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += (long)LOG_RING_PERIOD_MS * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        if (writerStop == 0U)
+        {
+            pthread_cond_timedwait(&writerWake, &writerLock, &deadline);
+        }
+    }
+    pthread_mutex_unlock(&writerLock);
+
+    return NULL;
+}
+
+STATIC void start_writer(void)
+{
+    /* Only from the thread that opens the sinks, without a file it is not needed */
+    if ((__atomic_load_n(&writerState, __ATOMIC_ACQUIRE) == LOG_WRITER_STOPPED) &&
+        (get()[1U].sink != NULL) && (pthread_create(&writer, NULL, write_loop, NULL) == 0))
+    {
+        __atomic_store_n(&writerState, LOG_WRITER_RUNNING, __ATOMIC_RELEASE);
+    }
+}
+
+STATIC uint32_t stop_writer(void)
+{
+    if (__atomic_load_n(&writerState, __ATOMIC_ACQUIRE) != LOG_WRITER_RUNNING)
+    {
+        return 0U;
+    }
+
+    /* New records are written at once from now on */
+    __atomic_store_n(&writerState, LOG_WRITER_STOPPED, __ATOMIC_SEQ_CST);
+
+    pthread_mutex_lock(&writerLock);
+    writerStop = 1U;
+    pthread_cond_signal(&writerWake);
+    pthread_mutex_unlock(&writerLock);
+    pthread_join(writer, NULL);
+    writerStop = 0U;
+
+    /* The pushes that saw it running end up in the rings, not after the drain */
+    for (RING *itr = __atomic_load_n(&rings, __ATOMIC_SEQ_CST); itr != NULL; itr = itr->next)
+    {
+        while (__atomic_load_n(&itr->pushing, __ATOMIC_ACQUIRE) != 0U)
+        {
+            sched_yield();
+        }
+    }
+
+    /* What was queued before and while it stopped */
+    pthread_mutex_lock(&drainLock);
+    drain();
+    pthread_mutex_unlock(&drainLock);
+
+    return 1U;
+}
@@ -5,13 +5,24 @@
 *   SUMMARY
 *       This submodule implements three basic APIs to enable logging to a file.
 *
-*       a) constructor that starts up stderr and an optional FILE-stream.
+*       a) log_sinks() starts up stderr and an optional FILE-stream on the
+*          first message, once for all threads. Processes that never log
+*          do not create any file. constructor() does it right away.
 *
 *       b) destructor does the opposite of the constructor to shut down all
 *          strams gracefully.
 *
 *       c) get() is a getter around the stream/file handlers.
 *
+*       d) the log file is written through a large aligned buffer, its
+*          segments are preallocated and rotated by size or by age, keeping
+*          a bounded number of files.
+*
+*       e) log_file_publish() queues whole records in a ring of the calling
+*          thread, with a timestamp. One writer thread merges the rings by
+*          timestamp into the log files, so the threads that log do not
+*          share a lock and each one's records keep their order.
+*
 *******************************************************************************/
 
 #ifndef FILE_H_
@@ -26,7 +37,9 @@ extern "C" {
 /******************************************************************************/
 
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <errno.h>
+#include <pthread.h>
 #include <time.h>
 
 #include "levels.h"
@@ -35,23 +48,77 @@ extern "C" {
 /*    PUBLIC TYPES                                                            */
 /******************************************************************************/
 
+/* Write buffer of a log file, streams without it are written directly */
+typedef struct Sink
+{
+    char            *buffer;
+    size_t          used;
+    size_t          segment;
+    time_t          opened;
+    pthread_mutex_t lock;
+} SINK;
+
 typedef struct Log
 {
     FILE *descriptor;
     char *name;
+    SINK *sink;
 } LOG;
 
+/* Records of a thread on their way to the log files, head is only written
+ * by its thread and tail by the thread that drains it. Both count bytes.
+ * pushing is set by its thread while it pushes a record */
+typedef struct Ring
+{
+    char        *buffer;
+    uint64_t    head;
+    uint64_t    tail;
+    uint64_t    end;
+    uint32_t    alive;
+    uint32_t    pushing;
+    struct Ring *next;
+} RING;
+
+/* Header of a record in a RING, followed by its len bytes */
+typedef struct RingRecord
+{
+    uint64_t stamp;
+    uint64_t len;
+} RING_RECORD;
+
+/* When to rotate the log file, and how many rotated files to keep */
+typedef struct Rotation
+{
+    size_t   maxSize;
+    uint32_t maxAge;
+    uint32_t maxFiles;
+} ROTATION;
+
 /******************************************************************************/
 /*    DEFINITIONS                                                             */
 /******************************************************************************/
 
-/* Using C-attribute to force init(c'tor) and shutdown(d'tor) of a file. */
-#ifdef LOG_TO_FILE
-    #define LOG_CONSTRUCTOR __attribute__((constructor))
-#else
-    #define LOG_CONSTRUCTOR
-#endif
+/* Buffers' magic numbers, a page-aligned 64KiB buffer and 64MiB segments */
+#define LOG_FILE_ALIGN        (4096U)
+#define LOG_FILE_BUFFER_LEN   (64U * 1024U)
+#define LOG_FILE_SEGMENT_LEN  (64U * 1024U * 1024U)
+
+/* Default rotation, no age limit and four rotated files "<name>.1" ... */
+#define LOG_FILE_MAX_AGE      (0U)
+#define LOG_FILE_MAX_FILES    (4U)
 
+/* Ring of each thread, and how often the writer thread drains them */
+#define LOG_RING_LEN          (64U * 1024U)
+#define LOG_RING_PERIOD_MS    (20U)
+
+/* States of the writer thread */
+#define LOG_WRITER_STOPPED    (0U)
+#define LOG_WRITER_RUNNING    (1U)
+
+/* Environment variable with the name of the log file, log_set_file() overrides it */
+#define LOG_FILE_ENV_VAR      "LOG_FILE"
+
+/* Using C-attribute to force shutdown(d'tor) of a file. */
 #ifdef LOG_TO_FILE
     #define LOG_DESTRUCTOR __attribute__((destructor))
 #else
@@ -70,18 +137,17 @@ typedef struct Log
 /******************************************************************************/
 
 #ifdef LOG_UNIT_TEST
-    #define CONSTRUCTOR
     #define DESTRUCTOR
 #else
-    #define CONSTRUCTOR    LOG_CONSTRUCTOR
     #define DESTRUCTOR     LOG_DESTRUCTOR
 #endif
 
 /**
- * @brief   Function that is called before main(), and it should NOT be
- *          called explicitly
+ * @brief   Function that opens the sinks now instead of on the first
+ *          message, as that message would. Once they are open, it does
+ *          nothing. Unit tests open them again on every call.
  */
-CONSTRUCTOR void constructor(void);
+void constructor(void);
 
 /**
  * @brief   Function that is called after main(), and it should NOY be
@@ -94,6 +160,55 @@ DESTRUCTOR void destructor(void);
  */
 LOG* get();
 
+/**
+ * @brief   Function that opens the sinks on its first call, the callers
+ *          racing it wait for them. Unit tests open them explicitly.
+ *
+ * @return  get()
+ */
+LOG* log_sinks(void);
+
+/**
+ * @brief   Function that sets the name of the log file, NULL restores the
+ *          default one. An open file is closed and the new one is opened
+ *          under drainLock, the records of other threads wait for the new
+ *          one. What the calling thread logs meanwhile goes to stderr only.
+ *          The name is swapped under drainLock too, so it may race the
+ *          first message.
+ *
+ * @examples log_set_file("tmp/echelon.log");
+ */
+void log_set_file(const char *filename);
+
+/**
+ * @brief   Function that sets when the log file rotates, by size in bytes
+ *          and/or by age in seconds (0U disables it), and how many rotated
+ *          files are kept.
+ */
+void log_set_rotation(const size_t maxSize, const uint32_t maxAge, const uint32_t maxFiles);
+
+/**
+ * @brief   Function that writes a record into a buffered log file, it
+ *          flushes and rotates the file when needed.
+ */
+void log_file_write(LOG *file, const struct iovec *record, const uint32_t count);
+
+/**
+ * @brief   Function that hands a record over to the log files. With the
+ *          writer thread running, it is queued in the ring of the calling
+ *          thread, otherwise (or when it does not fit in a ring) it is
+ *          written after what was queued.
+ *
+ * @return  The number of log files.
+ */
+uint32_t log_file_publish(const struct iovec *record, const uint32_t count);
+
+/**
+ * @brief   Function that writes the queued and buffered records of every
+ *          log file.
+ */
+void log_flush(void);
+
 /******************************************************************************/
 /*    STATIC FUNCTION PROTOTYPES                                              */
 /******************************************************************************/
@@ -108,6 +223,41 @@ STATIC LOG* open(char *filename);
 
 STATIC LOG* init(uint32_t toFileFlag);
 
+STATIC void set_stderr(void);
+
+STATIC void close_file(LOG *file);
+
+STATIC SINK* make_sink(FILE *descriptor);
+
+STATIC void free_sink(SINK *sink);
+
+STATIC void flush(LOG *file);
+
+STATIC int32_t rotate(LOG *file);
+
+STATIC void preallocate(FILE *descriptor, const size_t size);
+
+STATIC void trim(FILE *descriptor);
+
+STATIC RING* get_ring(void);
+
+STATIC void release_ring(void *ring);
+
+STATIC void make_ring_key(void);
+
+STATIC uint64_t ring_copy(RING *ring, uint64_t at, const void *src, const size_t len);
+
+STATIC void push_record(RING *ring, const struct iovec *record, const uint32_t count,
+                        const uint64_t len);
+
+STATIC void drain(void);
+
+STATIC void* write_loop(void *arg);
+
+STATIC void start_writer(void);
+
+STATIC uint32_t stop_writer(void);
+
 #ifdef __cplusplus
 }
 #endif
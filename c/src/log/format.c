@@ -0,0 +1,354 @@
+/******************************************************************************/
+/*    INCLUDED FILES                                                          */
+/******************************************************************************/
+
+#include "format.h"
+
+/******************************************************************************/
+/*    PRIVATE DATA                                                            */
+/******************************************************************************/
+
+/* IEEE-754 binary32 layout */
+#define FLOAT_MANTISSA_BITS     (23U)
+#define FLOAT_EXPONENT_MASK     (0xFFU)
+#define FLOAT_BIAS              (127)
+
+/* Precision of the tables, they hold 2^k / 5^q and 5^i / 2^k in 64 bits */
+#define POW5_INV_BITCOUNT       (59)
+#define POW5_BITCOUNT           (61)
+
+/* floor(2^(59 + ceil(log2(5^q)) - 1) / 5^q) + 1 for q in [0, 31) */
+static const uint64_t pow5InvSplit[31U] =
+{
+    576460752303423489U, 461168601842738791U, 368934881474191033U,
+    295147905179352826U, 472236648286964522U, 377789318629571618U,
+    302231454903657294U, 483570327845851670U, 386856262276681336U,
+    309485009821345069U, 495176015714152110U, 396140812571321688U,
+    316912650057057351U, 507060240091291761U, 405648192073033409U,
+    324518553658426727U, 519229685853482763U, 415383748682786211U,
+    332306998946228969U, 531691198313966350U, 425352958651173080U,
+    340282366920938464U, 544451787073501542U, 435561429658801234U,
+    348449143727040987U, 557518629963265579U, 446014903970612463U,
+    356811923176489971U, 570899077082383953U, 456719261665907162U,
+    365375409332725730U
+};
+
+/* floor(5^i / 2^(ceil(log2(5^i)) - 61)) for i in [0, 48) */
+static const uint64_t pow5Split[48U] =
+{
+    1152921504606846976U, 1441151880758558720U, 1801439850948198400U,
+    2251799813685248000U, 1407374883553280000U, 1759218604441600000U,
+    2199023255552000000U, 1374389534720000000U, 1717986918400000000U,
+    2147483648000000000U, 1342177280000000000U, 1677721600000000000U,
+    2097152000000000000U, 1310720000000000000U, 1638400000000000000U,
+    2048000000000000000U, 1280000000000000000U, 1600000000000000000U,
+    2000000000000000000U, 1250000000000000000U, 1562500000000000000U,
+    1953125000000000000U, 1220703125000000000U, 1525878906250000000U,
+    1907348632812500000U, 1192092895507812500U, 1490116119384765625U,
+    1862645149230957031U, 1164153218269348144U, 1455191522836685180U,
+    1818989403545856475U, 2273736754432320594U, 1421085471520200371U,
+    1776356839400250464U, 2220446049250313080U, 1387778780781445675U,
+    1734723475976807094U, 2168404344971008868U, 1355252715606880542U,
+    1694065894508600678U, 2117582368135750847U, 1323488980084844279U,
+    1654361225106055349U, 2067951531382569187U, 1292469707114105741U,
+    1615587133892632177U, 2019483917365790221U, 1262177448353618888U
+};
+
+/******************************************************************************/
+/*    PRIVATE FUNCTIONS                                                       */
+/******************************************************************************/
+
+/* ceil(log2(5^e)), floor(log10(2^e)) and floor(log10(5^e)) for small e */
+static inline int32_t pow5_bits(const int32_t e)
+{
+    return (int32_t)(((uint32_t)e * 1217359U) >> 19U) + 1;
+}
+
+static inline uint32_t log10_pow2(const int32_t e)
+{
+    return ((uint32_t)e * 78913U) >> 18U;
+}
+
+static inline uint32_t log10_pow5(const int32_t e)
+{
+    return ((uint32_t)e * 732923U) >> 20U;
+}
+
+static inline uint32_t is_pow5_multiple(uint32_t value, const uint32_t p)
+{
+    uint32_t count = 0U;
+
+    while ((value != 0U) && ((value % 5U) == 0U))
+    {
+        value /= 5U;
+        count++;
+    }
+
+    return (count >= p) ? 1U : 0U;
+}
+
+static inline uint32_t is_pow2_multiple(const uint32_t value, const uint32_t p)
+{
+    return ((value & ((1U << p) - 1U)) == 0U) ? 1U : 0U;
+}
+
+/* (m * factor) >> shift, with shift > 32 */
+static inline uint32_t mul_shift(const uint32_t m, const uint64_t factor, const int32_t shift)
+{
+    const uint64_t low = (uint64_t)m * (uint32_t)factor;
+    const uint64_t high = (uint64_t)m * (uint32_t)(factor >> 32U);
+
+    return (uint32_t)(((low >> 32U) + high) >> (shift - 32));
+}
+
+/******************************************************************************/
+/*    IMPLEMENTATION                                                          */
+/******************************************************************************/
+
+uint32_t format_float(char *str, const float value)
+{
+    uint32_t bits = 0U, k = 0U;
+    memcpy(&bits, &value, sizeof(bits));
+
+    const uint32_t ieeeMantissa = bits & ((1U << FLOAT_MANTISSA_BITS) - 1U);
+    const uint32_t ieeeExponent = (bits >> FLOAT_MANTISSA_BITS) & FLOAT_EXPONENT_MASK;
+
+    if ((ieeeExponent == FLOAT_EXPONENT_MASK) && (ieeeMantissa != 0U))
+    {
+        memcpy(str, "nan", 4U);
+        return 3U;
+    }
+
+    if ((bits >> 31U) != 0U)
+    {
+        str[k++] = '-';
+    }
+
+    if (ieeeExponent == FLOAT_EXPONENT_MASK)
+    {
+        memcpy(&str[k], "inf", 4U);
+        return k + 3U;
+    }
+
+    if ((ieeeExponent == 0U) && (ieeeMantissa == 0U))
+    {
+        memcpy(&str[k], "0.0", 4U);
+        return k + 3U;
+    }
+
+    const DECIMAL decimal = to_decimal(ieeeMantissa, ieeeExponent);
+    uint32_t length = 1U;
+    for (uint32_t pow10 = 10U; (length < 10U) && (decimal.mantissa >= pow10); pow10 *= 10U)
+    {
+        length++;
+    }
+    const int32_t exponent = decimal.exponent + (int32_t)length - 1;
+
+    if ((exponent < FORMAT_FIXED_MIN) || (FORMAT_FIXED_MAX < exponent))
+    {
+        /* Building "d.ddde-xx", float exponents have two digits at most */
+        write_digits(&str[k + 1U], decimal.mantissa, length);
+        str[k] = str[k + 1U];
+        str[k + 1U] = '.';
+        k += (length == 1U) ? 1U : (length + 1U);
+
+        const uint32_t absExponent = (uint32_t)((exponent < 0) ? -exponent : exponent);
+        str[k++] = 'e';
+        str[k++] = (exponent < 0) ? '-' : '+';
+        k += write_digits(&str[k], absExponent, 2U);
+    }
+    else if (exponent < 0)
+    {
+        /* Building "0.000ddd" */
+        str[k++] = '0';
+        str[k++] = '.';
+        for (int32_t i = exponent + 1; i < 0; i++)
+        {
+            str[k++] = '0';
+        }
+        k += write_digits(&str[k], decimal.mantissa, length);
+    }
+    else if ((uint32_t)exponent + 1U < length)
+    {
+        /* Building "ddd.ddd" */
+        write_digits(&str[k + 1U], decimal.mantissa, length);
+        memmove(&str[k], &str[k + 1U], (size_t)exponent + 1U);
+        str[k + (uint32_t)exponent + 1U] = '.';
+        k += length + 1U;
+    }
+    else
+    {
+        /* Building "ddd000.0" */
+        k += write_digits(&str[k], decimal.mantissa, length);
+        for (uint32_t i = length; i <= (uint32_t)exponent; i++)
+        {
+            str[k++] = '0';
+        }
+        str[k++] = '.';
+        str[k++] = '0';
+    }
+
+    str[k] = '\0';
+    return k;
+}
+
+STATIC DECIMAL to_decimal(const uint32_t ieeeMantissa, const uint32_t ieeeExponent)
+{
+    /* value = m2 * 2^e2, with two extra bits for the halfway bounds */
+    const int32_t e2 = ((ieeeExponent == 0U) ? 1 : (int32_t)ieeeExponent) -
+                       FLOAT_BIAS - (int32_t)FLOAT_MANTISSA_BITS - 2;
+    const uint32_t m2 = (ieeeExponent == 0U) ? ieeeMantissa :
+                        ((1U << FLOAT_MANTISSA_BITS) | ieeeMantissa);
+    const uint32_t acceptBounds = ((m2 & 1U) == 0U) ? 1U : 0U;
+
+    /* Value and its lower/upper halfway points to the next floats */
+    const uint32_t mmShift = ((ieeeMantissa != 0U) || (ieeeExponent <= 1U)) ? 1U : 0U;
+    const uint32_t mv = 4U * m2;
+    const uint32_t mp = 4U * m2 + 2U;
+    const uint32_t mm = 4U * m2 - 1U - mmShift;
+
+    uint32_t vr = 0U, vp = 0U, vm = 0U;
+    uint32_t vmIsTrailingZeros = 0U, vrIsTrailingZeros = 0U;
+    uint32_t lastRemovedDigit = 0U;
+    int32_t e10 = 0;
+
+    /* 1) Scaling the interval to base 10, with vr = mv * 2^e2 / 10^e10 */
+    if (e2 >= 0)
+    {
+        const uint32_t q = log10_pow2(e2);
+        const int32_t k = POW5_INV_BITCOUNT + pow5_bits((int32_t)q) - 1;
+        const int32_t i = -e2 + (int32_t)q + k;
+
+        e10 = (int32_t)q;
+        vr = mul_shift(mv, pow5InvSplit[q], i);
+        vp = mul_shift(mp, pow5InvSplit[q], i);
+        vm = mul_shift(mm, pow5InvSplit[q], i);
+
+        if ((q != 0U) && ((vp - 1U) / 10U <= vm / 10U))
+        {
+            /* The loop below may not run, but the rounding needs this digit */
+            const int32_t l = POW5_INV_BITCOUNT + pow5_bits((int32_t)q - 1) - 1;
+            lastRemovedDigit = mul_shift(mv, pow5InvSplit[q - 1U], -e2 + (int32_t)q - 1 + l) % 10U;
+        }
+
+        if (q <= 9U)
+        {
+            /* Only one of mp, mv and mm can be a multiple of 5 */
+            if ((mv % 5U) == 0U)
+            {
+                vrIsTrailingZeros = is_pow5_multiple(mv, q);
+            }
+            else if (acceptBounds != 0U)
+            {
+                vmIsTrailingZeros = is_pow5_multiple(mm, q);
+            }
+            else
+            {
+                vp -= is_pow5_multiple(mp, q);
+            }
+        }
+    }
+    else
+    {
+        const uint32_t q = log10_pow5(-e2);
+        const int32_t i = -e2 - (int32_t)q;
+        int32_t j = (int32_t)q - (pow5_bits(i) - POW5_BITCOUNT);
+
+        e10 = (int32_t)q + e2;
+        vr = mul_shift(mv, pow5Split[i], j);
+        vp = mul_shift(mp, pow5Split[i], j);
+        vm = mul_shift(mm, pow5Split[i], j);
+
+        if ((q != 0U) && ((vp - 1U) / 10U <= vm / 10U))
+        {
+            j = (int32_t)q - 1 - (pow5_bits(i + 1) - POW5_BITCOUNT);
+            lastRemovedDigit = mul_shift(mv, pow5Split[i + 1], j) % 10U;
+        }
+
+        if (q <= 1U)
+        {
+            /* mv = 4 * m2 has two trailing zero bits, mm has one iff mmShift */
+            vrIsTrailingZeros = 1U;
+            if (acceptBounds != 0U)
+            {
+                vmIsTrailingZeros = mmShift;
+            }
+            else
+            {
+                vp--;
+            }
+        }
+        else if (q < 31U)
+        {
+            vrIsTrailingZeros = is_pow2_multiple(mv, q - 1U);
+        }
+    }
+
+    /* 2) Removing digits while the interval holds more than one candidate */
+    int32_t removed = 0;
+    uint32_t output = 0U;
+
+    if ((vmIsTrailingZeros != 0U) || (vrIsTrailingZeros != 0U))
+    {
+        /* Exact ties, rare */
+        while (vp / 10U > vm / 10U)
+        {
+            vmIsTrailingZeros &= ((vm % 10U) == 0U) ? 1U : 0U;
+            vrIsTrailingZeros &= (lastRemovedDigit == 0U) ? 1U : 0U;
+            lastRemovedDigit = vr % 10U;
+            vr /= 10U;
+            vp /= 10U;
+            vm /= 10U;
+            removed++;
+        }
+
+        if (vmIsTrailingZeros != 0U)
+        {
+            while ((vm % 10U) == 0U)
+            {
+                vrIsTrailingZeros &= (lastRemovedDigit == 0U) ? 1U : 0U;
+                lastRemovedDigit = vr % 10U;
+                vr /= 10U;
+                vp /= 10U;
+                vm /= 10U;
+                removed++;
+            }
+        }
+
+        if ((vrIsTrailingZeros != 0U) && (lastRemovedDigit == 5U) && ((vr % 2U) == 0U))
+        {
+            /* Rounding half to even */
+            lastRemovedDigit = 4U;
+        }
+
+        output = vr + ((((vr == vm) && ((acceptBounds == 0U) || (vmIsTrailingZeros == 0U))) ||
+                        (lastRemovedDigit >= 5U)) ? 1U : 0U);
+    }
+    else
+    {
+        /* Common case */
+        while (vp / 10U > vm / 10U)
+        {
+            lastRemovedDigit = vr % 10U;
+            vr /= 10U;
+            vp /= 10U;
+            vm /= 10U;
+            removed++;
+        }
+
+        output = vr + (((vr == vm) || (lastRemovedDigit >= 5U)) ? 1U : 0U);
+    }
+
+    return (DECIMAL){output, e10 + removed};
+}
+
+STATIC uint32_t write_digits(char *str, uint32_t mantissa, const uint32_t length)
+{
+    for (uint32_t i = length; i > 0U; i--)
+    {
+        str[i - 1U] = (char)('0' + (mantissa % 10U));
+        mantissa /= 10U;
+    }
+
+    return length;
+}
@@ -0,0 +1,83 @@
+/*******************************************************************************
+*
+* LOGGING SYSTEM - format submodule
+*
+*   SUMMARY
+*       This submodule implements the formatting of numbers for the logs.
+*
+*       a) format_float() prints the shortest decimal that reads back as the
+*          same float, after Ulf Adams' Ryu. It uses a few 64-bit products
+*          instead of the long arithmetic of printf("%.7f").
+*
+*******************************************************************************/
+
+#ifndef FORMAT_H_
+#define FORMAT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/*    INCLUDED FILES                                                          */
+/******************************************************************************/
+
+#include <stdint.h>
+#include <string.h>
+
+/******************************************************************************/
+/*    PUBLIC TYPES                                                            */
+/******************************************************************************/
+
+/* A float as mantissa * 10^exponent, mantissa has at most nine digits */
+typedef struct Decimal
+{
+    uint32_t mantissa;
+    int32_t  exponent;
+} DECIMAL;
+
+/******************************************************************************/
+/*    DEFINITIONS                                                             */
+/******************************************************************************/
+
+/* Longest output, i.e. "-1.23456789e-38", plus '\0' */
+#define FORMAT_FLOAT_LEN    (16U)
+
+/* Scientific exponents printed in fixed notation, i.e. 0.0001 and 123456789.0 */
+#define FORMAT_FIXED_MIN    (-4)
+#define FORMAT_FIXED_MAX    (8)
+
+/* Macro to expose static functions to unit test runners */
+#ifdef LOG_UNIT_TEST
+    #define STATIC
+#else
+    #define STATIC static
+#endif
+
+/******************************************************************************/
+/*    API                                                                     */
+/******************************************************************************/
+
+/**
+ * @brief   Function that prints the shortest decimal that round-trips to
+ *          value, str needs FORMAT_FLOAT_LEN chars.
+ *
+ * @return  The length of str, without '\0'.
+ *
+ * @examples format_float(str, 0.1f); // "0.1"
+ */
+uint32_t format_float(char *str, const float value);
+
+/******************************************************************************/
+/*    STATIC FUNCTION PROTOTYPES                                              */
+/******************************************************************************/
+
+STATIC DECIMAL to_decimal(const uint32_t ieeeMantissa, const uint32_t ieeeExponent);
+
+STATIC uint32_t write_digits(char *str, uint32_t mantissa, const uint32_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FORMAT_H_ */
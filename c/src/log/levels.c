@@ -17,97 +17,485 @@ static const char *levelFormat[] =
     PURPLE("[ TRACE ] %s:%d")
 };
 
+/* Names accepted by log_parse_levels(), indexed by level and module */
+static const char *levelName[] = {"ERROR", "WARNING", "INFO", "DEBUG", "TRACE"};
+
+static const char *moduleName[] = {"algebra", "memory", "log"};
+
+/* Thread-local record buffer, it only grows so steady state does not malloc */
+static _Thread_local char  *tlsBuffer = NULL;
+static _Thread_local size_t tlsSize = 0U;
+
+/* Key whose destructor frees tlsBuffer at thread exit */
+static pthread_key_t  bufferKey;
+static pthread_once_t bufferOnce = PTHREAD_ONCE_INIT;
+
+static void make_buffer_key(void);
+
+/* How log_matrix() writes the values, see log_set_matrix_mode() */
+static uint32_t matrixMode = LOG_MATRIX_TEXT;
+
+/* Every module starts at the compile-time ceiling */
+uint32_t logLevels[LOG_MODULE_ALL] = {LOG_CONFIG, LOG_CONFIG, LOG_CONFIG};
+
 /******************************************************************************/
 /*    IMPLEMENTATION                                                          */
 /******************************************************************************/
 
+/* Reading LOG_ENV_VAR before main(), it is a no-op when it is not set */
+__attribute__((constructor)) static void levels_constructor(void)
+{
+    const char *config = getenv(LOG_ENV_VAR);
+
+    if (config != NULL)
+    {
+        log_parse_levels(config);
+    }
+}
+
 void log_print(const uint32_t level, const char *src, const uint32_t line,
                const char *format, ...)
 {
-    char  *srcStr = get_src(level, src, line);
-    char *msgStr = NULL;
-    char buffer[MAX_STR_LEN];
+    size_t size = MAX_STR_LEN;
+    char *buffer = get_buffer(&size);
+    size_t srcLen = 0U, msgLen = 0U;
+    va_list args, retry;
+
+    if (buffer == NULL)
+    {
+        return;
+    }
 
-    va_list args;
+    /* 1) "[ LEVEL ] file:line", growing the buffer if it did not fit */
+    srcLen = get_src(buffer, size, level, src, line);
+    if (srcLen >= size)
+    {
+        size = srcLen + MAX_STR_LEN;
+        buffer = get_buffer(&size);
+        if (buffer == NULL)
+        {
+            return;
+        }
+        get_src(buffer, size, level, src, line);
+    }
+
+    /* 2) message, right after the src in the same buffer */
     va_start(args, format);
-    msgStr = get_msg(format, args);
+    va_copy(retry, args);
+    msgLen = get_msg(&buffer[srcLen], size - srcLen, format, args);
+    if (msgLen >= size - srcLen)
+    {
+        size = srcLen + msgLen + 1U;
+        buffer = get_buffer(&size);
+        if (buffer != NULL)
+        {
+            get_msg(&buffer[srcLen], size - srcLen, format, retry);
+        }
+    }
+    va_end(retry);
     va_end(args);
 
-    sprintf(buffer, "%s "BOLD_GRAY("%s")"\n", srcStr, msgStr);
-    log_tee(buffer);
-
-    free(srcStr);
-    free(msgStr);
+    if (buffer != NULL)
+    {
+        /* 3) "src "BOLD_GRAY("msg")"\n" without copying src nor msg */
+        struct iovec record[4U] =
+        {
+            {buffer, srcLen},
+            {MSG_START, strlen(MSG_START)},
+            {&buffer[srcLen], msgLen},
+            {MSG_END, strlen(MSG_END)}
+        };
+        log_writev(record, 4U);
+    }
 }
 
 void log_matrix(const uint32_t level, const char *src, const uint32_t line,
                 const char *name, const float *val, const uint32_t rows,
                 const uint32_t cols)
 {
-    /* Building " A = " */
-    char word[MAX_STR_LEN / 10U];
-    char buffer[MAX_STR_LEN];
+    const uint32_t binary = (__atomic_load_n(&matrixMode, __ATOMIC_RELAXED) == LOG_MATRIX_BINARY) &&
+                            (count_files() != 0U);
+
+    log_print(level, src, line, BOLD_GRAY("(MATRIX)%s in [%ux%u]%s"), name, rows, cols,
+              (binary != 0U) ? " as binary" : "");
+
+    if (binary != 0U)
+    {
+        log_dump_matrix(name, val, rows, cols);
+        return;
+    }
+
+    /* One buffer, sized to the longest row, for all the rows */
+    size_t size = get_row_len(name, cols);
+    char *buffer = get_buffer(&size);
+    if (buffer == NULL)
+    {
+        return;
+    }
+
+    for (uint32_t i = 0U; i < rows; i++)
+    {
+        /* Only the first row shows the name */
+        struct iovec record = {buffer, 0U};
+        record.iov_len = get_row(buffer, size, (i == 0U) ? name : "", &val[cols * i], cols);
+        log_writev(&record, 1U);
+    }
+}
+
+uint32_t log_dump_matrix(const char *name, const float *val, const uint32_t rows,
+                         const uint32_t cols)
+{
+    const LOG_DUMP header = {LOG_DUMP_MAGIC, LOG_DUMP_VERSION, rows, cols,
+                             (uint32_t)strlen(name), (uint32_t)sizeof(float)};
+    const struct iovec record[3U] =
+    {
+        {(void*)&header, sizeof(header)},
+        {(void*)name, header.nameLen},
+        {(void*)val, sizeof(float) * (size_t)rows * (size_t)cols}
+    };
+
+    /* Opening the sinks when it is the first message */
+    log_sinks();
+
+    return log_file_publish(record, 3U);
+}
+
+uint32_t log_set_matrix_mode(const uint32_t mode)
+{
+    return __atomic_exchange_n(&matrixMode, mode, __ATOMIC_RELAXED);
+}
+
+void log_tee(const char *str)
+{
+    struct iovec record = {(void*)str, strlen(str)};
+
+    log_writev(&record, 1U);
+}
+
+void log_writev(const struct iovec *record, const uint32_t count)
+{
+    struct iovec iov[MAX_IOV_LEN];
+    const uint32_t n = (count < MAX_IOV_LEN) ? count : MAX_IOV_LEN;
+
+    /* Streams are written at once, with one writev() per record */
+    for (LOG *itr = log_sinks(); itr->name != NULL; itr++)
+    {
+        if (itr->sink == NULL)
+        {
+            /* write_all() consumes iov on partial writes */
+            memcpy(iov, record, sizeof(struct iovec) * n);
+            write_all(fileno(itr->descriptor), iov, n);
+        }
+    }
+
+    /* Files are written by the writer thread */
+    log_file_publish(record, n);
+}
+
+uint32_t log_sample(LOG_SITE *site, const uint32_t policy, const uint64_t n,
+                    uint64_t *suppressed)
+{
+    const uint64_t limit = (n == 0U) ? 1U : n;
+    const uint64_t hit = __atomic_fetch_add(&site->hits, 1U, __ATOMIC_RELAXED);
+    uint32_t sampled = 0U;
+
+    switch (policy)
+    {
+        case LOG_SAMPLE_EVERY_N:
+            sampled = ((hit % limit) == 0U) ? 1U : 0U;
+            break;
+        case LOG_SAMPLE_PER_SECOND:
+        {
+            const uint64_t second = get_second();
 
-    log_print(level, src, line, BOLD_GRAY("(MATRIX)%s in [%ux%u]"), name, rows, cols);
-    sprintf(word, "%5s = ", name);
+            /* Racing threads may reset it twice, the limit is approximate */
+            if (__atomic_exchange_n(&site->second, second, __ATOMIC_RELAXED) != second)
+            {
+                __atomic_store_n(&site->inSecond, 0U, __ATOMIC_RELAXED);
+            }
+            sampled = (__atomic_fetch_add(&site->inSecond, 1U, __ATOMIC_RELAXED) < limit) ? 1U : 0U;
+            break;
+        }
+        case LOG_SAMPLE_FIRST_N:
+        default:
+            sampled = (hit < limit) ? 1U : 0U;
+            break;
+    }
 
-    for (uint32_t i = 0U, k = 0U; i < rows; i++, k = 0U)
+    if (sampled == 0U)
     {
-        /* Building "    " */
-        k += sprintf(&buffer[k], BOLD_GRAY("%8s["), word);
+        const uint64_t dropped = __atomic_add_fetch(&site->suppressed, 1U, __ATOMIC_RELAXED);
+        const uint64_t second = get_second();
+        uint64_t last = __atomic_load_n(&site->reported, __ATOMIC_RELAXED);
+
+        /* The first drop, then one per period, the CAS elects one reporter */
+        if (((last == 0U) || (second >= last + LOG_SAMPLE_REPORT_S)) &&
+            __atomic_compare_exchange_n(&site->reported, &last, second, 0,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        {
+            *suppressed = dropped;
+        }
+    }
+
+    return sampled;
+}
+
+uint32_t log_set_level(const uint32_t module, const uint32_t level)
+{
+    /* LOG_CONFIG is an upper bound, what is compiled out cannot be enabled */
+    const uint32_t newLevel = (level < LOG_CONFIG) ? level : LOG_CONFIG;
 
-        for (uint32_t j = 0U; j < (cols - 1U); j++)
+    if (module < LOG_MODULE_ALL)
+    {
+        __atomic_store_n(&logLevels[module], newLevel, __ATOMIC_RELAXED);
+    }
+    else
+    {
+        for (uint32_t i = 0U; i < LOG_MODULE_ALL; i++)
         {
-            /* Building " d.ddddddd, " in a 11-char column */
-            uint32_t pos = cols * i + j;
-            sprintf(word, "%.7f", val[pos]);
-            k += sprintf(&buffer[k], WHITE("%11s, "), word);
+            __atomic_store_n(&logLevels[i], newLevel, __ATOMIC_RELAXED);
         }
+    }
 
-        /* Building last column " d.ddddddd]" */
-        sprintf(word, "%.7f", val[cols * i + cols - 1U]);
-        k += sprintf(&buffer[k], WHITE("%11s")BOLD_GRAY("]")"\n", word);
+    return newLevel;
+}
 
-        log_tee(buffer);
-        /* Clearing word with "    "  */
-        sprintf(word, "%8s", "");
+uint32_t log_get_level(const uint32_t module)
+{
+    if (module < LOG_MODULE_ALL)
+    {
+        return __atomic_load_n(&logLevels[module], __ATOMIC_RELAXED);
     }
+
+    return LOG_CONFIG;
 }
 
-void log_tee(const char *str)
+uint32_t log_parse_levels(const char *config)
 {
-    LOG *file = get();
-    char buffer[MAX_STR_LEN];
+    uint32_t errors = 0U;
 
-    for (LOG *itr = file; itr->name != NULL; itr++)
+    for (const char *entry = config; (entry != NULL) && (*entry != '\0');)
     {
-        fprintf(itr->descriptor, "%s", str);
+        const char *end = strchr(entry, ',');
+        size_t length = (end == NULL) ? strlen(entry) : (size_t)(end - entry);
+        const char *equal = memchr(entry, '=', length);
+        uint32_t module = LOG_MODULE_ALL;
+        uint32_t level = LOG_LEVEL_FULL + 1U;
+
+        if (equal == NULL)
+        {
+            /* "LEVEL" applies to all modules */
+            level = get_level_id(entry, length);
+        }
+        else
+        {
+            /* "module=LEVEL" applies to one module */
+            module = get_module_id(entry, (size_t)(equal - entry));
+            level = get_level_id(equal + 1, length - (size_t)(equal - entry) - 1U);
+            if (module == LOG_MODULE_ALL)
+            {
+                level = LOG_LEVEL_FULL + 1U;
+            }
+        }
+
+        if (level <= LOG_LEVEL_FULL)
+        {
+            log_set_level(module, level);
+        }
+        else if (length != 0U)
+        {
+            errors++;
+        }
+
+        entry = (end == NULL) ? NULL : end + 1;
     }
+
+    return errors;
 }
 
-STATIC char* get_src(const uint32_t level, const char *src, const uint32_t line)
+STATIC size_t get_src(char *str, const size_t size, const uint32_t level,
+                      const char *src, const uint32_t line)
 {
-    /* "65535" and "\0" are const strings of longest string for the cases */
-    size_t size = strlen(src) + strlen("65535") + strlen("\0");
-    const char *format = NULL;
-    char *str = NULL;
+    int32_t len = 0;
 
     if (level <= LOG_LEVEL_FULL)
     {
-        size += strlen(levelFormat[level]);
-        str = malloc(sizeof(char) * size);
-        sprintf(str, levelFormat[level], src, line);
+        len = snprintf(str, size, levelFormat[level], src, line);
+    }
+    else if (size != 0U)
+    {
+        str[0U] = '\0';
+    }
+
+    return (len < 0) ? 0U : (size_t)len;
+}
+
+STATIC size_t get_msg(char *str, const size_t size, const char *format, va_list args)
+{
+    int32_t len = vsnprintf(str, size, format, args);
+
+    return (len < 0) ? 0U : (size_t)len;
+}
+
+STATIC char* get_buffer(size_t *size)
+{
+    if (*size > tlsSize)
+    {
+        size_t newSize = (tlsSize == 0U) ? MAX_RECORD_LEN : tlsSize;
+        char *newBuffer = NULL;
+
+        while (newSize < *size)
+        {
+            newSize *= 2U;
+        }
+
+        newBuffer = realloc(tlsBuffer, newSize);
+        if (newBuffer == NULL)
+        {
+            return NULL;
+        }
+
+        /* The key's destructor frees the buffer when the thread exits */
+        pthread_once(&bufferOnce, make_buffer_key);
+        pthread_setspecific(bufferKey, newBuffer);
+        tlsBuffer = newBuffer;
+        tlsSize = newSize;
+    }
+
+    *size = tlsSize;
+    return tlsBuffer;
+}
+
+STATIC size_t get_row_len(const char *name, const uint32_t cols)
+{
+    /* "%5s = [" at most, the colors, and the widest float with ", " per column */
+    return strlen(name) + strlen(BOLD_GRAY("%5s = [")) + strlen(ROW_START) +
+           strlen(ROW_END) + (size_t)cols * (FORMAT_FLOAT_LEN + 2U);
+}
+
+STATIC size_t get_row(char *str, const size_t size, const char *name,
+                      const float *val, const uint32_t cols)
+{
+    char word[FORMAT_FLOAT_LEN];
+    int32_t len = 0;
+    size_t k = 0U;
+
+    if (size < get_row_len(name, cols))
+    {
+        return 0U;
+    }
+
+    /* Building "    A = [" or "        [" */
+    len = (name[0U] != '\0') ? snprintf(str, size, BOLD_GRAY("%5s = ["), name) :
+                               snprintf(str, size, BOLD_GRAY("%8s["), "");
+    k = (len < 0) ? 0U : (size_t)len;
+    memcpy(&str[k], ROW_START, strlen(ROW_START));
+    k += strlen(ROW_START);
+
+    for (uint32_t j = 0U; j < cols; j++)
+    {
+        /* Building "  d.ddddddd, " in a LOG_MATRIX_WIDTH-char column */
+        const uint32_t wordLen = format_float(word, val[j]);
+
+        if (j != 0U)
+        {
+            str[k++] = ',';
+            str[k++] = ' ';
+        }
+        if (wordLen < LOG_MATRIX_WIDTH)
+        {
+            memset(&str[k], ' ', LOG_MATRIX_WIDTH - wordLen);
+            k += LOG_MATRIX_WIDTH - wordLen;
+        }
+        memcpy(&str[k], word, wordLen);
+        k += wordLen;
+    }
+
+    memcpy(&str[k], ROW_END, strlen(ROW_END));
+    k += strlen(ROW_END);
+
+    return k;
+}
+
+STATIC uint32_t count_files(void)
+{
+    uint32_t count = 0U;
+
+    for (LOG *itr = log_sinks(); itr->name != NULL; itr++)
+    {
+        count += (itr->sink != NULL) ? 1U : 0U;
+    }
+
+    return count;
+}
+
+STATIC void write_all(const int32_t fd, struct iovec *iov, uint32_t count)
+{
+    while (count > 0U)
+    {
+        ssize_t written = writev(fd, iov, (int32_t)count);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+
+        /* Skipping what was written, partial writes are rare */
+        while ((count > 0U) && ((size_t)written >= iov->iov_len))
+        {
+            written -= (ssize_t)iov->iov_len;
+            iov++;
+            count--;
+        }
+
+        if (count > 0U)
+        {
+            iov->iov_base = (char*)iov->iov_base + written;
+            iov->iov_len -= (size_t)written;
+        }
     }
+}
 
-    return str;
+STATIC uint64_t get_second(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec + 1U;
+}
+
+static void make_buffer_key(void)
+{
+    pthread_key_create(&bufferKey, free);
 }
 
-STATIC char* get_msg(const char *format, const va_list args)
+STATIC uint32_t get_level_id(const char *name, const size_t length)
 {
-    /* refactor to compute actual length of ellipsis ... */
-    char *str = malloc(sizeof(char) * MAX_STR_LEN);
+    for (uint32_t level = 0U; level <= LOG_LEVEL_FULL; level++)
+    {
+        if ((strlen(levelName[level]) == length) &&
+            (strncasecmp(levelName[level], name, length) == 0))
+        {
+            return level;
+        }
+    }
+
+    return LOG_LEVEL_FULL + 1U;
+}
 
-    vsprintf(str, format, args);
+STATIC uint32_t get_module_id(const char *name, const size_t length)
+{
+    for (uint32_t module = 0U; module < LOG_MODULE_ALL; module++)
+    {
+        if ((strlen(moduleName[module]) == length) &&
+            (strncasecmp(moduleName[module], name, length) == 0))
+        {
+            return module;
+        }
+    }
 
-    return str;
+    return LOG_MODULE_ALL;
 }
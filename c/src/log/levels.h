@@ -6,13 +6,23 @@
 *       This submodule implements two APIs for logging-purpose.
 *
 *       a) log_print() is a function that logs text within five levels, in
-*          different colors.
+*          different colors. It formats into a thread-local buffer and writes
+*          each record with one writev() per stream, the log files get it
+*          through the ring of the thread.
 *
 *       b) log_matrix() is a specialization for logging the MATRIX typedef.
+*          It prints the shortest round-trip floats, or dumps them as binary
+*          into the log files with log_set_matrix_mode(LOG_MATRIX_BINARY).
 *
 *       c) a set of macros conseal the main APIs to ease the use of this
 *          submodule.
 *
+*       d) log_set_level() and log_parse_levels() adjust the level of each
+*          module at runtime, LOG_CONFIG remains the compile-time ceiling.
+*
+*       e) LOG_EVERY_N(), LOG_PER_SECOND() and LOG_FIRST_N() sample the logs
+*          of a call site in hot loops, and report what they suppressed.
+*
 *******************************************************************************/
 
 #ifndef LEVELS_H_
@@ -27,11 +37,17 @@ extern "C" {
 /******************************************************************************/
 
 #include <stdarg.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <stdio.h>
+#include <pthread.h>
+#include <sys/uio.h>
+#include <unistd.h>
 
 #include "file.h"
+#include "format.h"
 
 /******************************************************************************/
 /*    DEFINITIONS                                                             */
@@ -52,6 +68,30 @@ extern "C" {
     #define LOG_CONFIG      LOG_LEVEL_ERROR
 #endif
 
+/* Define log modules, each one has its own runtime level */
+#define LOG_MODULE_ALGEBRA  (0U)
+#define LOG_MODULE_MEMORY   (1U)
+#define LOG_MODULE_LOG      (2U)
+
+/* Define module boundaries, it also selects every module at once */
+#define LOG_MODULE_ALL      (3U)
+
+/* Set default module (if not previously defined), (sub)modules set their own */
+#ifndef LOG_MODULE
+    #define LOG_MODULE      LOG_MODULE_LOG
+#endif
+
+/* Name of the environment variable read at start-up, i.e. "INFO,algebra=TRACE" */
+#define LOG_ENV_VAR   "LOG_LEVEL"
+
+/* Define sampling policies for a call site */
+#define LOG_SAMPLE_EVERY_N      (0U)
+#define LOG_SAMPLE_PER_SECOND   (1U)
+#define LOG_SAMPLE_FIRST_N      (2U)
+
+/* Seconds between two reports of the messages a call site suppressed */
+#define LOG_SAMPLE_REPORT_S     (1U)
+
 /* Macro to expose static functions to unit test runners */
 #ifdef LOG_UNIT_TEST
     #define STATIC
@@ -60,7 +100,20 @@ extern "C" {
 #endif
 
 /* Buffers' magic numbers */
-#define MAX_STR_LEN   (256U)
+#define MAX_STR_LEN     (256U)
+#define MAX_RECORD_LEN  (4096U)
+#define MAX_IOV_LEN     (16U)
+
+/* Define how log_matrix() writes the values */
+#define LOG_MATRIX_TEXT     (0U)
+#define LOG_MATRIX_BINARY   (1U)
+
+/* Text columns are 11 chars wide, longer floats widen their column */
+#define LOG_MATRIX_WIDTH    (11U)
+
+/* Binary dumps start with "MTRX" and version 1U, see LOG_DUMP */
+#define LOG_DUMP_MAGIC      "MTRX"
+#define LOG_DUMP_VERSION    (1U)
 
 /* Colors for matrix*/
 #define BOLD_GRAY(fmt) "\x1b[1;90m"fmt"\x1b[0m"
@@ -73,18 +126,62 @@ extern "C" {
 #define CYAN(fmt)      "\x1b[36m"fmt"\x1b[0m"
 #define PURPLE(fmt)    "\x1b[94m"fmt"\x1b[0m"
 
+/* " "BOLD_GRAY() around a message, split to write it without copying */
+#define MSG_START      " \x1b[1;90m"
+#define MSG_END        "\x1b[0m\n"
+
+/* WHITE() around the values of a matrix row, then BOLD_GRAY("]") */
+#define ROW_START      "\x1b[37m"
+#define ROW_END        "\x1b[0m"BOLD_GRAY("]")"\n"
+
+/******************************************************************************/
+/*    PUBLIC TYPES                                                            */
+/******************************************************************************/
+
+/* State of a sampled call site, one static instance per LOG_SAMPLED() */
+typedef struct LogSite
+{
+    uint64_t hits;
+    uint64_t suppressed;
+    uint64_t second;
+    uint64_t inSecond;
+    uint64_t reported;
+} LOG_SITE;
+
+/* Header of a binary dump in native endianness, followed by nameLen chars
+ * of name and by rows * cols values of elemSize bytes, row by row */
+typedef struct LogDump
+{
+    char     magic[4U];
+    uint32_t version;
+    uint32_t rows;
+    uint32_t cols;
+    uint32_t nameLen;
+    uint32_t elemSize;
+} LOG_DUMP;
+
 /******************************************************************************/
 /*    PUBLIC MACROS                                                           */
 /******************************************************************************/
 
+/**
+ * @brief   Macro to check the runtime level of the current LOG_MODULE, it is
+ *          a single relaxed load, so disabled logs do not evaluate arguments.
+ *          It is written with < and + 1U, level <= runtime would compare
+ *          LOG_LEVEL_ERROR, 0U, as always true under -Wtype-limits.
+ */
+#define LOG_ENABLED(level) \
+    ((level) < __atomic_load_n(&logLevels[LOG_MODULE], __ATOMIC_RELAXED) + 1U)
+
 /**
  * @example    LOG_ERROR("socket: %s", strerror(errno));
  */
 #if LOG_LEVEL_ERROR <= LOG_CONFIG
     #define LOG_ERROR(...) \
-        log_print(LOG_LEVEL_ERROR, __FILE__, __LINE__, __VA_ARGS__)
+        do { if (LOG_ENABLED(LOG_LEVEL_ERROR)) \
+            log_print(LOG_LEVEL_ERROR, __FILE__, __LINE__, __VA_ARGS__); } while (0)
 #else
-    #define LOG_ERROR(...)
+    #define LOG_ERROR(...) do {} while (0)
 #endif
 
 /**
@@ -92,9 +189,10 @@ extern "C" {
  */
 #if LOG_LEVEL_WARNING <= LOG_CONFIG
     #define LOG_WARNING(...) \
-        log_print(LOG_LEVEL_WARNING, __FILE__, __LINE__, __VA_ARGS__)
+        do { if (LOG_ENABLED(LOG_LEVEL_WARNING)) \
+            log_print(LOG_LEVEL_WARNING, __FILE__, __LINE__, __VA_ARGS__); } while (0)
 #else
-    #define LOG_WARNING(...)
+    #define LOG_WARNING(...) do {} while (0)
 #endif
 
 /**
@@ -102,9 +200,10 @@ extern "C" {
  */
 #if LOG_LEVEL_INFO <= LOG_CONFIG
     #define LOG_INFO(...) \
-        log_print(LOG_LEVEL_INFO, __FILE__, __LINE__, __VA_ARGS__)
+        do { if (LOG_ENABLED(LOG_LEVEL_INFO)) \
+            log_print(LOG_LEVEL_INFO, __FILE__, __LINE__, __VA_ARGS__); } while (0)
 #else
-    #define LOG_INFO(...)
+    #define LOG_INFO(...) do {} while (0)
 #endif
 
 /**
@@ -112,9 +211,10 @@ extern "C" {
  */
 #if LOG_LEVEL_DEBUG <= LOG_CONFIG
     #define LOG_DEBUG(...) \
-        log_print(LOG_LEVEL_DEBUG, __FILE__, __LINE__, __VA_ARGS__)
+        do { if (LOG_ENABLED(LOG_LEVEL_DEBUG)) \
+            log_print(LOG_LEVEL_DEBUG, __FILE__, __LINE__, __VA_ARGS__); } while (0)
 #else
-    #define LOG_DEBUG(...)
+    #define LOG_DEBUG(...) do {} while (0)
 #endif
 
 /**
@@ -122,19 +222,54 @@ extern "C" {
  */
 #if LOG_LEVEL_TRACE <= LOG_CONFIG
     #define LOG_TRACE(...) \
-        log_print(LOG_LEVEL_TRACE, __FILE__, __LINE__, __VA_ARGS__)
+        do { if (LOG_ENABLED(LOG_LEVEL_TRACE)) \
+            log_print(LOG_LEVEL_TRACE, __FILE__, __LINE__, __VA_ARGS__); } while (0)
 #else
-    #define LOG_TRACE(...)
+    #define LOG_TRACE(...) do {} while (0)
 #endif
 
+/**
+ * @brief   Macro to run a LOG_* statement only when the call site is sampled,
+ *          the suppressed messages are reported at the first drop, then at
+ *          most once every LOG_SAMPLE_REPORT_S seconds.
+ *
+ * @example    LOG_SAMPLED(TRACE, LOG_SAMPLE_FIRST_N, 2U, LOG_TRACE_MATRIX(A));
+ */
+#define LOG_SAMPLED(LEVEL, policy, n, statement) \
+    do { if ((LOG_LEVEL_##LEVEL <= LOG_CONFIG) && LOG_ENABLED(LOG_LEVEL_##LEVEL)) { \
+        static LOG_SITE site = {0U}; \
+        uint64_t suppressed = 0U; \
+        if (log_sample(&site, policy, n, &suppressed) != 0U) { statement; } \
+        if (suppressed != 0U) { log_print(LOG_LEVEL_##LEVEL, __FILE__, __LINE__, \
+            "%llu messages suppressed so far.", (unsigned long long)suppressed); } } } while (0)
+
+/**
+ * @example    LOG_EVERY_N(TRACE, 1000U, "C[%u,%u] := %f", row, col, c);
+ */
+#define LOG_EVERY_N(LEVEL, n, ...) \
+    LOG_SAMPLED(LEVEL, LOG_SAMPLE_EVERY_N, n, LOG_##LEVEL(__VA_ARGS__))
+
+/**
+ * @example    LOG_PER_SECOND(DEBUG, 10U, "Pivot in row %u", row);
+ */
+#define LOG_PER_SECOND(LEVEL, n, ...) \
+    LOG_SAMPLED(LEVEL, LOG_SAMPLE_PER_SECOND, n, LOG_##LEVEL(__VA_ARGS__))
+
+/**
+ * @example    LOG_FIRST_N(WARNING, 3U, "Matrix is singular.");
+ */
+#define LOG_FIRST_N(LEVEL, n, ...) \
+    LOG_SAMPLED(LEVEL, LOG_SAMPLE_FIRST_N, n, LOG_##LEVEL(__VA_ARGS__))
+
 /**
  * @example    LOG_WARNING_MATRIX(A);
  */
 #if LOG_LEVEL_WARNING <= LOG_CONFIG
     #define LOG_WARNING_MATRIX(A) \
-        log_matrix(LOG_LEVEL_WARNING, __FILE__, __LINE__, #A, A->val, A->rows, A->cols)
+        do { if (LOG_ENABLED(LOG_LEVEL_WARNING)) \
+            log_matrix(LOG_LEVEL_WARNING, __FILE__, __LINE__, #A, A->val, A->rows, A->cols); } while (0)
 #else
-    #define LOG_WARNING_MATRIX(A)
+    #define LOG_WARNING_MATRIX(A) do {} while (0)
 #endif
 
 /**
@@ -142,9 +277,10 @@ extern "C" {
  */
 #if LOG_LEVEL_INFO <= LOG_CONFIG
     #define LOG_INFO_MATRIX(A) \
-        log_matrix(LOG_LEVEL_INFO, __FILE__, __LINE__, #A, A->val, A->rows, A->cols)
+        do { if (LOG_ENABLED(LOG_LEVEL_INFO)) \
+            log_matrix(LOG_LEVEL_INFO, __FILE__, __LINE__, #A, A->val, A->rows, A->cols); } while (0)
 #else
-    #define LOG_INFO_MATRIX(A)
+    #define LOG_INFO_MATRIX(A) do {} while (0)
 #endif
 
 /**
@@ -152,9 +288,10 @@ extern "C" {
  */
 #if LOG_LEVEL_DEBUG <= LOG_CONFIG
     #define LOG_DEBUG_MATRIX(A) \
-        log_matrix(LOG_LEVEL_DEBUG, __FILE__, __LINE__, #A, A->val, A->rows, A->cols)
+        do { if (LOG_ENABLED(LOG_LEVEL_DEBUG)) \
+            log_matrix(LOG_LEVEL_DEBUG, __FILE__, __LINE__, #A, A->val, A->rows, A->cols); } while (0)
 #else
-    #define LOG_DEBUG_MATRIX(A)
+    #define LOG_DEBUG_MATRIX(A) do {} while (0)
 #endif
 
 /**
@@ -162,11 +299,19 @@ extern "C" {
  */
 #if LOG_LEVEL_TRACE <= LOG_CONFIG
     #define LOG_TRACE_MATRIX(A) \
-        log_matrix(LOG_LEVEL_TRACE, __FILE__, __LINE__, #A, A->val, A->rows, A->cols)
+        do { if (LOG_ENABLED(LOG_LEVEL_TRACE)) \
+            log_matrix(LOG_LEVEL_TRACE, __FILE__, __LINE__, #A, A->val, A->rows, A->cols); } while (0)
 #else
-    #define LOG_TRACE_MATRIX(A)
+    #define LOG_TRACE_MATRIX(A) do {} while (0)
 #endif
 
+/******************************************************************************/
+/*    PUBLIC DATA                                                             */
+/******************************************************************************/
+
+/* Runtime level per module, read through LOG_ENABLED() */
+extern uint32_t logLevels[LOG_MODULE_ALL];
+
 /******************************************************************************/
 /*    API                                                                     */
 /******************************************************************************/
@@ -188,6 +333,27 @@ void log_matrix(const uint32_t level, const char *src, const uint32_t line,
                 const char *name, const float *val, const uint32_t rows,
                 const uint32_t cols);
 
+/**
+ * @brief   Function that dumps a matrix as a binary record, a LOG_DUMP
+ *          header and its payload, into every log file. stderr is skipped.
+ *
+ * @return  The number of log files that were written.
+ *
+ * @examples log_dump_matrix("A", A->val, A->rows, A->cols);
+ */
+uint32_t log_dump_matrix(const char *name, const float *val, const uint32_t rows,
+                         const uint32_t cols);
+
+/**
+ * @brief   Function that sets how log_matrix() writes the values, without a
+ *          log file LOG_MATRIX_BINARY falls back to text.
+ *
+ * @return  The previous mode.
+ *
+ * @examples log_set_matrix_mode(LOG_MATRIX_BINARY);
+ */
+uint32_t log_set_matrix_mode(const uint32_t mode);
+
 /**
  * @brief   Function that prints to stderr and FILE* streams
  *
@@ -195,13 +361,79 @@ void log_matrix(const uint32_t level, const char *src, const uint32_t line,
  */
 void log_tee(const char *str);
 
+/**
+ * @brief   Function that writes a record, made of count pieces, to every
+ *          stream with a single writev() per stream, and hands it over to
+ *          the log files with log_file_publish().
+ *
+ * @examples log_writev(record, 4U);
+ */
+void log_writev(const struct iovec *record, const uint32_t count);
+
+/**
+ * @brief   Function that decides if a sampled call site logs, n = 0 is taken
+ *          as n = 1. It sets suppressed to the drops so far when a report is
+ *          due, at the first drop and then once per LOG_SAMPLE_REPORT_S.
+ *
+ * @return  1U to log, 0U to suppress.
+ *
+ * @examples log_sample(&site, LOG_SAMPLE_EVERY_N, 100U, &suppressed);
+ */
+uint32_t log_sample(LOG_SITE *site, const uint32_t policy, const uint64_t n,
+                    uint64_t *suppressed);
+
+/**
+ * @brief   Function that sets the runtime level of a module, or of all of
+ *          them with LOG_MODULE_ALL. The level is clipped to LOG_CONFIG.
+ *
+ * @return  The level that was actually set.
+ *
+ * @examples log_set_level(LOG_MODULE_ALGEBRA, LOG_LEVEL_INFO);
+ */
+uint32_t log_set_level(const uint32_t module, const uint32_t level);
+
+/**
+ * @brief   Function that gets the runtime level of a module.
+ *
+ * @examples log_get_level(LOG_MODULE_MEMORY);
+ */
+uint32_t log_get_level(const uint32_t module);
+
+/**
+ * @brief   Function that sets the runtime levels from a comma-separated list,
+ *          a bare level applies to all modules and "module=level" to one.
+ *
+ * @return  The number of entries that were not understood.
+ *
+ * @examples log_parse_levels("WARNING,algebra=DEBUG");
+ */
+uint32_t log_parse_levels(const char *config);
+
 /******************************************************************************/
 /*    STATIC FUNCTION PROTOTYPES                                              */
 /******************************************************************************/
 
-STATIC char* get_src(const uint32_t level, const char *src, const uint32_t line);
+STATIC size_t get_src(char *str, const size_t size, const uint32_t level,
+                      const char *src, const uint32_t line);
+
+STATIC size_t get_msg(char *str, const size_t size, const char *format, va_list args);
+
+STATIC char* get_buffer(size_t *size);
+
+STATIC size_t get_row_len(const char *name, const uint32_t cols);
+
+STATIC size_t get_row(char *str, const size_t size, const char *name,
+                      const float *val, const uint32_t cols);
+
+STATIC uint32_t count_files(void);
+
+STATIC void write_all(const int32_t fd, struct iovec *iov, uint32_t count);
+/* Monotonic seconds offset by one, zero is the initial "no second yet" */
+STATIC uint64_t get_second(void);
+
+STATIC uint32_t get_level_id(const char *name, const size_t length);
 
-STATIC char* get_msg(const char *format, const va_list args);
+STATIC uint32_t get_module_id(const char *name, const size_t length);
 
 #ifdef __cplusplus
 }
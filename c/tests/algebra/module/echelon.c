@@ -8,6 +8,13 @@
 /* TARGET LIBRARY */
 #include "echelon.h"
 
+/******************************************************************************/
+/*    DEFINITIONS                                                             */
+/******************************************************************************/
+
+/* Rounding errors of entries up to ~64 */
+#define TOLERANCE   (64.0F * FLT_EPSILON)
+
 /******************************************************************************/
 /*    PRELUDE                                                                 */
 /******************************************************************************/
@@ -32,94 +39,6 @@ __attribute__((constructor)) void init_submodule(void)
 /*    TEST FUNCTIONS                                                          */
 /******************************************************************************/
 
-void test_get_new_pivot(void)
-{
-    MATRIX *B = push_matrix(5U, 5U);
-    log_info(__FUNCTION__);
-
-    float vals[25U] = {-4.0000000F, -2.0000000F, 0.0000000F, 0.0000000F, 0.0000000F,
-                        0.0000000F,  0.0000000F, 0.0000000F, 0.0000000F, 0.0000000F,
-                        0.0000000F,  0.0000000F, 0.0000000F, 0.0000000F, 0.0000000F,
-                        0.0000000F,  1.0000000F, 0.0000000F, 0.0000000F, 0.0000000F,
-                 2.0F * FLT_EPSILON, 0.0000000F, 0.0000000F, 1.0000000F, 0.0000000F};
-    uint32_t expRow[5U] = {0U, 2U, 3U, 1U, 1U};
-    memcpy(B->val, vals, sizeof(float) * B->rows * B->cols);
-
-    LOG_DEBUG_MATRIX(B);
-    for (uint32_t i = 0U; i < B->rows; i++)
-    {
-        MATRIX *A = GET_BLOCK_MATRIX(B, i);
-        LOG_DEBUG_MATRIX(A);
-        uint32_t row = get_new_pivot(A);
-        TEST_ASSERT_EQUAL_UINT32(expRow[i], row);
-    }
-}
-
-void test_get_permutation(void)
-{
-    MATRIX *B = push_matrix(5U, 5U);
-    log_info(__FUNCTION__);
-
-    float vals[25U] = {-4.0000000F, -2.0000000F, 0.0000000F, 0.0000000F, 0.0000000F,
-                        0.0000000F,  0.0000000F, 0.0000000F, 0.0000000F, 0.0000000F,
-                        0.0000000F,  0.0000000F, 0.0000000F, 0.0000000F, 0.0000000F,
-                        0.0000000F,  1.0000000F, 0.0000000F, 0.0000000F, 0.0000000F,
-                 2.0F * FLT_EPSILON, 0.0000000F, 0.0000000F, 1.0000000F, 0.0000000F};
-    void *expP[5U] = {NULL, (void*)1U, NULL, (void*)1U, NULL};
-    memcpy(B->val, vals, sizeof(float) * B->rows * B->cols);
-
-    for (uint32_t i = 0U; i < B->rows; i++)
-    {
-        MATRIX *A = GET_BLOCK_MATRIX(B, i);
-        LOG_DEBUG_MATRIX(A);
-        MATRIX *P = get_permutation(A);
-        if (expP[i] != NULL)
-        {
-            TEST_ASSERT_NOT_NULL(P);
-            LOG_DEBUG_MATRIX(P);
-        }
-        else
-        {
-            TEST_ASSERT_NULL(P);
-        }
-    }
-}
-
-void test_get_lower_triangular(void)
-{
-    MATRIX *PA = push_matrix(4U, 4U);
-    log_info(__FUNCTION__);
-
-    float vals[16U] = {-50.0000000F, 0.0000000F, 16.6666679F, 25.0000000F,
-                       30.0000019F, 33.3333359F, 35.7142868F, 37.5000000F,
-                       38.8888893F, 40.0000000F, 40.9090919F, 41.6666641F,
-                       42.3076935F, 42.8571434F, 43.3333321F, 43.7500000F};
-    MATRIX *LVecs = push_matrix(4U, 4U);
-    float expLs[16U] = {1.0000000F,  0.0000000F,  0.0000000F, 0.0000000F,
-                        0.6000000F,  1.0000000F,  0.0000000F, 0.0000000F,
-                        0.7777778F, -1.1999999F,  1.0000000F, 0.0000000F,
-                        0.8461539F, -1.2857141F, -1.3598906F, -1.0000000F};
-    memcpy(PA->val, vals, sizeof(float) * PA->rows * PA->cols);
-    memcpy(LVecs->val, expLs, sizeof(float) * LVecs->rows * LVecs->cols);
-
-    LOG_DEBUG_MATRIX(PA);
-    for (uint32_t i = 0U; i < LVecs->rows; i++)
-    {
-        MATRIX *L;
-        L = get_lower_triangular(PA);
-        for (uint32_t j = i; j < LVecs->rows; j++)
-        {
-            TEST_ASSERT_EQUAL_FLOAT(expLs[TO_C_CONT(LVecs, j, i)], L->val[TO_C_CONT(L, (j - i), 0U)]);
-        }
-        LOG_DEBUG_MATRIX(L);
-        LOG_DEBUG_MATRIX(PA);
-        LOG_DEBUG("LPA = L * PA");
-        MATRIX *LPA = mult(L, PA);
-        LOG_DEBUG_MATRIX(LPA);
-        PA = GET_BLOCK_MATRIX(LPA, 1U);
-    }
-}
-
 void test_get_inverse_lower_triag(void)
 {
     log_info(__FUNCTION__);
@@ -179,7 +98,7 @@ void test_echelon_2x2_matrix(void)
     MATRIX *A = push_matrix(2U, 2U);
     log_info(__FUNCTION__);
     float simple[4U] = {1.0F, 2.0F, 3.0F, 4.0F};
-    float expSimple[4U] = {1.0F, 2.0F, 0.0F, -2.0F};
+    float expSimple[4U] = {3.0F, 4.0F, 0.0F, 2.0F / 3.0F};
     memcpy(A->val, simple, sizeof(float) * A->rows * A->cols);
     A = echelon(A);
     TEST_ASSERT_EQUAL_FLOAT_ARRAY(expSimple, A->val, A->rows * A->cols);
@@ -234,9 +153,9 @@ void test_echelon_perfect_matrix(void)
                        38.8888893F, 40.0000000F, 40.9090919F, 41.6666641F,
                        42.3076935F, 42.8571434F, 43.3333321F, 43.7500000F};
     float expected[16U] = {-50.0000000F, 0.0000000F, 16.6666679F, 25.0000000F,
-                            0.0000000F, 33.3333359F, 45.7142868F, 52.5000000F,
-                             0.0000000F, 0.0000000F, -0.9850845F, -1.8888893F,
-                             0.0000000F, 0.0000000F, 0.0000000F, -0.02746296F};
+                             0.0000000F, 42.8571434F, 57.4358976F, 64.9038467F,
+                             0.0000000F, 0.0000000F, 1.0419205F, 2.0192281F,
+                             0.0000000F, 0.0000000F, 0.0000000F, 0.0201952F};
     memcpy(A->val, vals, sizeof(float) * A->rows * A->cols);
 
     LOG_INFO_MATRIX(A);
@@ -245,7 +164,7 @@ void test_echelon_perfect_matrix(void)
 
     for (uint32_t i = 0U; i < 4U * 4U; i++)
     {
-        TEST_ASSERT_FLOAT_WITHIN(FLT_EPSILON, expected[i], A->val[i]);
+        TEST_ASSERT_FLOAT_WITHIN(TOLERANCE, expected[i], A->val[i]);
     }
 
     do {
@@ -270,15 +189,16 @@ void test_echelon_singular_matrix(void)
     LOG_INFO_MATRIX(A);
     A = echelon(A);
     LOG_INFO_MATRIX(A);
-    float expA[25U] = {-12.0000000F, -9.5000000F, -7.0000000F, -4.5000000F, -2.0000000F,
-                          0.0000000F, 2.6041667F, 5.2083335F, 7.8125000F, 10.4166670F,
-                          0.0000000F, 0.0000000F, -1.4000015F, -2.1000004F, -2.8000031F,
-                          0.0000000F, 0.0000000F, 0.0000000F, 0.0000019F, 0.0000019F,
-                          0.0000000F, 0.0000000F, 0.0000000F, 0.0000000F, 0.0000000F};
+    /* Rank 3, the last two pivots are rounding errors */
+    float expA[25U] = {38.0000000F, 40.5000000F, 43.0000000F, 45.5000000F, 48.0000000F,
+                        0.0000000F, 3.2894737F, 6.5789474F, 9.8684211F, 13.1578947F,
+                        0.0000000F, 0.0000000F, -1.4000015F, -2.1000023F, -2.8000031F,
+                        0.0000000F, 0.0000000F, 0.0000000F, 0.0000000F, 0.0000000F,
+                        0.0000000F, 0.0000000F, 0.0000000F, 0.0000000F, 0.0000000F};
 
     for (uint32_t i = 0; i < 5U * 5U; i++)
     {
-        TEST_ASSERT_FLOAT_WITHIN(FLT_EPSILON, expA[i], A->val[i]);
+        TEST_ASSERT_FLOAT_WITHIN(TOLERANCE, expA[i], A->val[i]);
     }
 
     do {
@@ -287,13 +207,138 @@ void test_echelon_singular_matrix(void)
     } while(stack != NULL);
 }
 
+void test_lu_factor(void)
+{
+    MATRIX *A = push_matrix(4U, 4U);
+    log_info(__FUNCTION__);
+
+    float vals[16U] = {-50.0000000F, 0.0000000F, 16.6666679F, 25.0000000F,
+                       30.0000019F, 33.3333359F, 35.7142868F, 37.5000000F,
+                       38.8888893F, 40.0000000F, 40.9090919F, 41.6666641F,
+                       42.3076935F, 42.8571434F, 43.3333321F, 43.7500000F};
+    /* L below the diagonal, U on and above it */
+    float expLU[16U] = {-50.0000000F, 0.0000000F, 16.6666679F, 25.0000000F,
+                         -0.8461539F, 42.8571434F, 57.4358976F, 64.9038467F,
+                         -0.6000000F, 0.7777778F, 1.0419205F, 2.0192281F,
+                         -0.7777778F, 0.9333333F, 0.2545481F, 0.0201952F};
+    uint32_t expPiv[4U] = {0U, 3U, 3U, 3U};
+    uint32_t piv[4U] = {0U};
+    memcpy(A->val, vals, sizeof(float) * A->rows * A->cols);
+
+    /* Wrong input */
+    TEST_ASSERT_EQUAL_UINT32(LU_INVALID, lu_factor(NULL, piv));
+
+    /* No matrix is pushed */
+    ITEM *top = stack;
+    TEST_ASSERT_EQUAL_UINT32(0U, lu_factor(A, piv));
+    TEST_ASSERT_EQUAL_PTR(top, stack);
+    LOG_INFO_MATRIX(A);
+
+    TEST_ASSERT_EQUAL_UINT32_ARRAY(expPiv, piv, 4U);
+    for (uint32_t i = 0U; i < 4U * 4U; i++)
+    {
+        TEST_ASSERT_FLOAT_WITHIN(TOLERANCE, expLU[i], A->val[i]);
+    }
+
+    /* PA = LU, applying the swaps to the rows of the input */
+    for (uint32_t k = 0U; k < 4U; k++)
+    {
+        for (uint32_t j = 0U; j < 4U; j++)
+        {
+            float tmp = vals[4U * k + j];
+            vals[4U * k + j] = vals[4U * piv[k] + j];
+            vals[4U * piv[k] + j] = tmp;
+        }
+    }
+    for (uint32_t i = 0U; i < 4U; i++)
+    {
+        for (uint32_t j = 0U; j < 4U; j++)
+        {
+            float sum = (i <= j) ? A->val[TO_C_CONT(A, i, j)] : 0.0F;
+            for (uint32_t k = 0U; (k < i) && (k <= j); k++)
+            {
+                sum += A->val[TO_C_CONT(A, i, k)] * A->val[TO_C_CONT(A, k, j)];
+            }
+            TEST_ASSERT_FLOAT_WITHIN(TOLERANCE, vals[4U * i + j], sum);
+        }
+    }
+
+    do {
+        TEST_ASSERT_NOT_NULL(stack);
+        stack = pop_matrix(stack);
+    } while(stack != NULL);
+}
+
+void test_lu_factor_singular(void)
+{
+    MATRIX *A = push_matrix(3U, 4U);
+    log_info(__FUNCTION__);
+
+    /* The second column is twice the first one */
+    float vals[12U] = {1.0F, 2.0F, 3.0F, 4.0F,
+                       2.0F, 4.0F, 1.0F, 0.0F,
+                       4.0F, 8.0F, 5.0F, 2.0F};
+    uint32_t piv[3U] = {0U};
+    memcpy(A->val, vals, sizeof(float) * A->rows * A->cols);
+
+    TEST_ASSERT_EQUAL_UINT32(2U, lu_factor(A, piv));
+    LOG_INFO_MATRIX(A);
+
+    /* The zero pivot is skipped without a swap, the next column is still
+     * eliminated */
+    TEST_ASSERT_EQUAL_UINT32(2U, piv[0U]);
+    TEST_ASSERT_EQUAL_UINT32(1U, piv[1U]);
+    TEST_ASSERT_FLOAT_WITHIN(TOLERANCE, 0.0F, A->val[TO_C_CONT(A, 1U, 1U)]);
+    TEST_ASSERT_FLOAT_WITHIN(TOLERANCE, 0.0F, A->val[TO_C_CONT(A, 2U, 1U)]);
+
+    do {
+        TEST_ASSERT_NOT_NULL(stack);
+        stack = pop_matrix(stack);
+    } while(stack != NULL);
+}
+
+void test_solve(void)
+{
+    MATRIX *A = push_matrix(3U, 3U);
+    MATRIX *B = push_matrix(3U, 1U);
+    log_info(__FUNCTION__);
+
+    /* x = (1, 2, -1), A(0,0) is zero */
+    float vals[9U] = {0.0F, 2.0F, 1.0F,
+                      1.0F, 1.0F, 1.0F,
+                      4.0F, 2.0F, -1.0F};
+    float b[3U] = {3.0F, 2.0F, 9.0F};
+    float x[3U] = {1.0F, 2.0F, -1.0F};
+    memcpy(A->val, vals, sizeof(vals));
+    memcpy(B->val, b, sizeof(b));
+
+    MATRIX *X = solve(A, B);
+    TEST_ASSERT_NOT_NULL(X);
+    TEST_ASSERT_EQUAL_PTR(X, stack->matrix);
+    for (uint32_t i = 0U; i < 3U; i++)
+    {
+        TEST_ASSERT_FLOAT_WITHIN(TOLERANCE, x[i], X->val[i]);
+        /* A and B are left as they were */
+        TEST_ASSERT_EQUAL_FLOAT(b[i], B->val[i]);
+    }
+    TEST_ASSERT_EQUAL_FLOAT(0.0F, A->val[0U]);
+
+    /* Singular, nothing is left on the stack */
+    A->val[TO_C_CONT(A, 1U, 0U)] = 0.0F;
+    A->val[TO_C_CONT(A, 2U, 0U)] = 0.0F;
+    TEST_ASSERT_NULL(solve(A, B));
+    TEST_ASSERT_EQUAL_PTR(X, stack->matrix);
+
+    do {
+        TEST_ASSERT_NOT_NULL(stack);
+        stack = pop_matrix(stack);
+    } while(stack != NULL);
+}
+
 int main(void)
 {
     UNITY_BEGIN();
 
-    RUN_TEST(test_get_new_pivot);
-    RUN_TEST(test_get_permutation);
-    RUN_TEST(test_get_lower_triangular);
     RUN_TEST(test_get_inverse_lower_triag);
     RUN_TEST(test_echelon_rect_matrix);
     RUN_TEST(test_echelon_scalar_matrix);
@@ -301,6 +346,9 @@ int main(void)
     RUN_TEST(test_echelon_only_permutations);
     RUN_TEST(test_echelon_perfect_matrix);
     RUN_TEST(test_echelon_singular_matrix);
+    RUN_TEST(test_lu_factor);
+    RUN_TEST(test_lu_factor_singular);
+    RUN_TEST(test_solve);
 
     return UNITY_END();
 }
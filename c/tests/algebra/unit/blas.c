@@ -0,0 +1,228 @@
+/******************************************************************************/
+/*    INCLUDED FILES                                                          */
+/******************************************************************************/
+
+#include <float.h>
+
+#include "unity.h"
+#include "utilities.h"
+/* TARGET LIBRARY */
+#include "blas.h"
+
+/******************************************************************************/
+/*    PRELUDE                                                                 */
+/******************************************************************************/
+
+/* setUp() and tearDown() are required by Unity */
+void setUp(void)
+{
+    return;
+}
+
+void tearDown(void)
+{
+    return;
+}
+
+__attribute__((constructor)) void init_submodule(void)
+{
+    log_init(__FILE__);
+}
+
+/******************************************************************************/
+/*    TEST FUNCTIONS                                                          */
+/******************************************************************************/
+
+void test_dot(void)
+{
+    /* 19 elements, two full BLAS_LANES and a tail */
+    float x[19U], y[19U];
+    float expected = 0.0F;
+    log_info(__FUNCTION__);
+
+    for (uint32_t i = 0U; i < 19U; i++)
+    {
+        x[i] = (float)i;
+        y[i] = 2.0F;
+        expected += 2.0F * (float)i;
+    }
+
+    TEST_ASSERT_EQUAL_FLOAT(expected, blas_dot(19U, x, 1U, y, 1U));
+    TEST_ASSERT_EQUAL_FLOAT(0.0F, blas_dot(0U, x, 1U, y, 1U));
+
+    /* x(0), x(3), x(6) with y(0), y(2), y(4) */
+    TEST_ASSERT_EQUAL_FLOAT(18.0F, blas_dot(3U, x, 3U, y, 2U));
+}
+
+void test_axpy_and_scal(void)
+{
+    MATRIX *A = push_matrix(3U, 4U);
+    log_info(__FUNCTION__);
+
+    for (uint32_t i = 0U; i < A->rows * A->cols; i++)
+    {
+        A->val[i] = (float)i;
+    }
+
+    /* row 2 += -2 row 0 */
+    blas_axpy(A->cols, -2.0F, &A->val[0U], 1U, &A->val[TO_C_CONT(A, 2U, 0U)], 1U);
+    float expRow[4U] = {8.0F, 7.0F, 6.0F, 5.0F};
+    TEST_ASSERT_EQUAL_FLOAT_ARRAY(expRow, &A->val[TO_C_CONT(A, 2U, 0U)], 4U);
+
+    /* column 1 *= 0.5 */
+    blas_scal(A->rows, 0.5F, &A->val[1U], A->cols);
+    TEST_ASSERT_EQUAL_FLOAT(0.5F, A->val[TO_C_CONT(A, 0U, 1U)]);
+    TEST_ASSERT_EQUAL_FLOAT(2.5F, A->val[TO_C_CONT(A, 1U, 1U)]);
+    TEST_ASSERT_EQUAL_FLOAT(3.5F, A->val[TO_C_CONT(A, 2U, 1U)]);
+    TEST_ASSERT_EQUAL_FLOAT(4.0F, A->val[TO_C_CONT(A, 1U, 0U)]);
+
+    /* column 3 += 1 column 0 */
+    blas_axpy(A->rows, 1.0F, &A->val[0U], A->cols, &A->val[3U], A->cols);
+    TEST_ASSERT_EQUAL_FLOAT(3.0F, A->val[TO_C_CONT(A, 0U, 3U)]);
+    TEST_ASSERT_EQUAL_FLOAT(11.0F, A->val[TO_C_CONT(A, 1U, 3U)]);
+    TEST_ASSERT_EQUAL_FLOAT(13.0F, A->val[TO_C_CONT(A, 2U, 3U)]);
+}
+
+void test_nrm2(void)
+{
+    float x[10U] = {3.0F, 4.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 12.0F};
+    float big[2U] = {3.0e30F, 4.0e30F};
+    log_info(__FUNCTION__);
+
+    TEST_ASSERT_EQUAL_FLOAT(13.0F, blas_nrm2(10U, x, 1U));
+    TEST_ASSERT_EQUAL_FLOAT(3.0F, blas_nrm2(5U, x, 2U));
+    TEST_ASSERT_EQUAL_FLOAT(0.0F, blas_nrm2(0U, x, 1U));
+
+    /* Their squares overflow floats */
+    TEST_ASSERT_FLOAT_WITHIN(1.0e24F, 5.0e30F, blas_nrm2(2U, big, 1U));
+}
+
+void test_iamax(void)
+{
+    float x[6U] = {1.0F, -7.0F, 3.0F, 7.0F, -2.0F, 0.0F};
+    log_info(__FUNCTION__);
+
+    /* The first of the ties */
+    TEST_ASSERT_EQUAL_UINT32(1U, blas_iamax(6U, x, 1U));
+    /* x(0), x(2), x(4) */
+    TEST_ASSERT_EQUAL_UINT32(1U, blas_iamax(3U, x, 2U));
+    TEST_ASSERT_EQUAL_UINT32(0U, blas_iamax(0U, x, 1U));
+}
+
+void test_gemv(void)
+{
+    MATRIX *A = push_matrix(2U, 3U);
+    float val[6U] = {1.0F, 2.0F, 3.0F,
+                     4.0F, 5.0F, 6.0F};
+    float x[3U] = {1.0F, 0.0F, -1.0F};
+    float y[2U] = {10.0F, 20.0F};
+    log_info(__FUNCTION__);
+    memcpy(A->val, val, sizeof(float) * A->rows * A->cols);
+
+    /* Wrong inputs */
+    TEST_ASSERT_NULL(blas_gemv(BLAS_NO_TRANS, 1.0F, NULL, x, 1U, 0.0F, y, 1U));
+
+    /* y := 2 A x + y */
+    TEST_ASSERT_EQUAL_PTR(A, blas_gemv(BLAS_NO_TRANS, 2.0F, A, x, 1U, 1.0F, y, 1U));
+    TEST_ASSERT_EQUAL_FLOAT(6.0F, y[0U]);
+    TEST_ASSERT_EQUAL_FLOAT(16.0F, y[1U]);
+
+    /* z := A^T y, z is not read when beta is 0 */
+    float z[3U] = {NAN, NAN, NAN};
+    float expZ[3U] = {70.0F, 92.0F, 114.0F};
+    blas_gemv(BLAS_TRANS, 1.0F, A, y, 1U, 0.0F, z, 1U);
+    TEST_ASSERT_EQUAL_FLOAT_ARRAY(expZ, z, 3U);
+
+    /* Strided x and y, the columns of a 3x2 matrix */
+    float xy[6U] = {1.0F, 0.0F,
+                    0.0F, 0.0F,
+                    -1.0F, 0.0F};
+    blas_gemv(BLAS_NO_TRANS, 1.0F, A, &xy[0U], 2U, 0.0F, &xy[1U], 2U);
+    TEST_ASSERT_EQUAL_FLOAT(-2.0F, xy[1U]);
+    TEST_ASSERT_EQUAL_FLOAT(-2.0F, xy[3U]);
+    TEST_ASSERT_EQUAL_FLOAT(0.0F, xy[5U]);
+}
+
+void test_gemm(void)
+{
+    /* Sizes that are not multiples of MULT_BLOCK, so that edge blocks are packed */
+    const uint32_t m = MULT_BLOCK + 5U, k = 2U * MULT_BLOCK + 3U, n = MULT_BLOCK - 7U;
+    MATRIX *A = push_matrix(m, k);
+    MATRIX *AT = push_matrix(k, m);
+    MATRIX *B = push_matrix(k, n);
+    MATRIX *BT = push_matrix(n, k);
+    MATRIX *C = push_matrix(m, n);
+    MATRIX *expC = push_matrix(m, n);
+    log_info(__FUNCTION__);
+
+    for (uint32_t i = 0U; i < m * k; i++)
+    {
+        A->val[i] = (float)((i * 7U) % 13U) - 6.0F;
+    }
+    for (uint32_t i = 0U; i < k * n; i++)
+    {
+        B->val[i] = (float)((i * 5U) % 11U) - 5.0F;
+    }
+    kernel_transpose(m, k, A->val, k, AT->val, m);
+    kernel_transpose(k, n, B->val, n, BT->val, k);
+    /* expC := A B + 1, the sums of small integers are exact */
+    for (uint32_t i = 0U; i < m; i++)
+    {
+        for (uint32_t j = 0U; j < n; j++)
+        {
+            float sum = 1.0F;
+            for (uint32_t p = 0U; p < k; p++)
+            {
+                sum += A->val[k * i + p] * B->val[n * p + j];
+            }
+            expC->val[n * i + j] = sum;
+        }
+    }
+
+    /* Wrong inputs */
+    TEST_ASSERT_NULL(blas_gemm(BLAS_NO_TRANS, BLAS_NO_TRANS, 1.0F, A, NULL, 0.0F, C));
+    TEST_ASSERT_NULL(blas_gemm(BLAS_TRANS, BLAS_NO_TRANS, 1.0F, A, B, 0.0F, C));
+    TEST_ASSERT_NULL(blas_gemm(BLAS_NO_TRANS, BLAS_NO_TRANS, 1.0F, A, B, 0.0F, A));
+
+    /* C := op(A) op(B) + C for the four op(), C starts at ones */
+    MATRIX *ops[4U][2U] = {{A, B}, {AT, B}, {A, BT}, {AT, BT}};
+    for (uint32_t t = 0U; t < 4U; t++)
+    {
+        for (uint32_t i = 0U; i < m * n; i++)
+        {
+            C->val[i] = 1.0F;
+        }
+        TEST_ASSERT_EQUAL_PTR(C, blas_gemm(t & 1U, t >> 1U, 1.0F, ops[t][0U], ops[t][1U], 1.0F, C));
+        TEST_ASSERT_EQUAL_FLOAT_ARRAY(expC->val, C->val, m * n);
+    }
+
+    /* G := A^T A is symmetric, G is not read when beta is 0 */
+    MATRIX *G = push_matrix(k, k);
+    for (uint32_t i = 0U; i < k * k; i++)
+    {
+        G->val[i] = NAN;
+    }
+    blas_gemm(BLAS_TRANS, BLAS_NO_TRANS, 1.0F, A, A, 0.0F, G);
+    for (uint32_t i = 0U; i < k; i++)
+    {
+        for (uint32_t j = 0U; j < i; j++)
+        {
+            TEST_ASSERT_EQUAL_FLOAT(G->val[k * j + i], G->val[k * i + j]);
+        }
+    }
+    TEST_ASSERT_EQUAL_FLOAT(blas_dot(m, A->val, k, A->val, k), G->val[0U]);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_dot);
+    RUN_TEST(test_axpy_and_scal);
+    RUN_TEST(test_nrm2);
+    RUN_TEST(test_iamax);
+    RUN_TEST(test_gemv);
+    RUN_TEST(test_gemm);
+
+    return UNITY_END();
+}
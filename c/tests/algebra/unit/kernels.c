@@ -0,0 +1,210 @@
+/******************************************************************************/
+/*    INCLUDED FILES                                                          */
+/******************************************************************************/
+
+#include <float.h>
+#include <math.h>
+
+#include "unity.h"
+#include "utilities.h"
+/* TARGET LIBRARY */
+#include "kernels.h"
+
+/******************************************************************************/
+/*    PRELUDE                                                                 */
+/******************************************************************************/
+
+/* setUp() and tearDown() are required by Unity */
+void setUp(void)
+{
+    return;
+}
+
+void tearDown(void)
+{
+    return;
+}
+
+__attribute__((constructor)) void init_submodule(void)
+{
+    log_init(__FILE__);
+}
+
+/* Padding after the rows of the strided operands, it is never written */
+#define PAD     (-7.0F)
+
+/******************************************************************************/
+/*    TEST FUNCTIONS                                                          */
+/******************************************************************************/
+
+void test_gemm(void)
+{
+    /* A is 3x4 with lda = 6, B is 4x2 with ldb = 3 and C is 3x2 with ldc = 5 */
+    float A[3U * 6U], B[4U * 3U], C[3U * 5U];
+    log_info(__FUNCTION__);
+
+    for (uint32_t i = 0U; i < 3U * 6U; i++)
+    {
+        A[i] = ((i % 6U) < 4U) ? (float)i : PAD;
+    }
+    for (uint32_t i = 0U; i < 4U * 3U; i++)
+    {
+        B[i] = ((i % 3U) < 2U) ? (float)i - 5.0F : PAD;
+    }
+    for (uint32_t i = 0U; i < 3U * 5U; i++)
+    {
+        C[i] = ((i % 5U) < 2U) ? 1.0F : PAD;
+    }
+
+    /* C := 2 A B + 0.5 C */
+    kernel_gemm(BLAS_NO_TRANS, BLAS_NO_TRANS, 3U, 2U, 4U, 2.0F, A, 6U, B, 3U, 0.5F, C, 5U);
+    for (uint32_t i = 0U; i < 3U; i++)
+    {
+        for (uint32_t j = 0U; j < 5U; j++)
+        {
+            float expected = PAD;
+            if (j < 2U)
+            {
+                expected = 0.5F;
+                for (uint32_t k = 0U; k < 4U; k++)
+                {
+                    expected += 2.0F * A[6U * i + k] * B[3U * k + j];
+                }
+            }
+            TEST_ASSERT_EQUAL_FLOAT(expected, C[5U * i + j]);
+        }
+    }
+
+    /* C is not read when beta is 0 */
+    for (uint32_t i = 0U; i < 3U * 5U; i++)
+    {
+        C[i] = NAN;
+    }
+    kernel_gemm(BLAS_NO_TRANS, BLAS_NO_TRANS, 3U, 2U, 4U, 1.0F, A, 6U, B, 3U, 0.0F, C, 5U);
+    TEST_ASSERT_EQUAL_FLOAT(A[0U] * B[0U] + A[1U] * B[3U] + A[2U] * B[6U] + A[3U] * B[9U], C[0U]);
+    TEST_ASSERT_FALSE(isnan(C[5U * 2U + 1U]));
+
+    /* C := A B again from AT, 4x3 with lda = 4, and BT, 2x4 with ldb = 5 */
+    float AT[4U * 4U], BT[2U * 5U], D[3U * 2U];
+    for (uint32_t i = 0U; i < 4U * 4U; i++)
+    {
+        AT[i] = PAD;
+    }
+    for (uint32_t i = 0U; i < 2U * 5U; i++)
+    {
+        BT[i] = PAD;
+    }
+    kernel_transpose(3U, 4U, A, 6U, AT, 4U);
+    kernel_transpose(4U, 2U, B, 3U, BT, 5U);
+    kernel_gemm(BLAS_TRANS, BLAS_TRANS, 3U, 2U, 4U, 1.0F, AT, 4U, BT, 5U, 0.0F, D, 2U);
+    for (uint32_t i = 0U; i < 3U; i++)
+    {
+        for (uint32_t j = 0U; j < 2U; j++)
+        {
+            TEST_ASSERT_EQUAL_FLOAT(C[5U * i + j], D[2U * i + j]);
+        }
+    }
+}
+
+void test_transpose(void)
+{
+    /* A is 3x2 with lda = 4, AT is 2x3 with ldb = 5 */
+    float A[3U * 4U], AT[2U * 5U];
+    log_info(__FUNCTION__);
+
+    for (uint32_t i = 0U; i < 3U * 4U; i++)
+    {
+        A[i] = (float)i;
+    }
+    for (uint32_t i = 0U; i < 2U * 5U; i++)
+    {
+        AT[i] = PAD;
+    }
+
+    kernel_transpose(3U, 2U, A, 4U, AT, 5U);
+    for (uint32_t i = 0U; i < 2U; i++)
+    {
+        for (uint32_t j = 0U; j < 5U; j++)
+        {
+            TEST_ASSERT_EQUAL_FLOAT((j < 3U) ? A[4U * j + i] : PAD, AT[5U * i + j]);
+        }
+    }
+}
+
+void test_elementwise(void)
+{
+    /* 2x3 operands, c-contiguous and with ld = 4 */
+    float A[2U * 4U], B[2U * 4U], C[2U * 4U], D[2U * 4U];
+    log_info(__FUNCTION__);
+
+    for (uint32_t i = 0U; i < 2U * 4U; i++)
+    {
+        A[i] = (float)i;
+        B[i] = 10.0F * (float)i;
+        C[i] = PAD;
+        D[i] = PAD;
+    }
+
+    kernel_add(2U, 3U, A, 3U, B, 3U, C, 3U);
+    for (uint32_t i = 0U; i < 6U; i++)
+    {
+        TEST_ASSERT_EQUAL_FLOAT(11.0F * (float)i, C[i]);
+    }
+
+    kernel_sub(2U, 3U, A, 4U, B, 4U, C, 4U);
+    kernel_scale(2U, 3U, -2.0F, C, 4U, D, 4U);
+    for (uint32_t i = 0U; i < 2U * 4U; i++)
+    {
+        TEST_ASSERT_EQUAL_FLOAT(((i % 4U) < 3U) ? 18.0F * (float)i : PAD, D[i]);
+    }
+}
+
+void test_getrf_and_getrs(void)
+{
+    /* A(0,0) is 0, the first step swaps rows. X is 3x2 with ldb = 3 */
+    float A[3U * 3U] = {0.0F, 2.0F, 1.0F,
+                        1.0F, 1.0F, 1.0F,
+                        4.0F, 2.0F, -1.0F};
+    const float X[3U * 2U] = {1.0F, -2.0F,
+                              2.0F, 0.5F,
+                              -1.0F, 3.0F};
+    float B[3U * 3U];
+    uint32_t piv[3U];
+    log_info(__FUNCTION__);
+
+    for (uint32_t i = 0U; i < 3U; i++)
+    {
+        for (uint32_t j = 0U; j < 2U; j++)
+        {
+            B[3U * i + j] = A[3U * i] * X[j] + A[3U * i + 1U] * X[2U + j] + A[3U * i + 2U] * X[4U + j];
+        }
+        B[3U * i + 2U] = PAD;
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(0U, kernel_getrf(3U, 3U, A, 3U, piv));
+    TEST_ASSERT_EQUAL_UINT32(2U, piv[0U]);
+
+    kernel_getrs(3U, 2U, A, 3U, piv, B, 3U);
+    for (uint32_t i = 0U; i < 3U; i++)
+    {
+        TEST_ASSERT_FLOAT_WITHIN(16.0F * FLT_EPSILON, X[2U * i], B[3U * i]);
+        TEST_ASSERT_FLOAT_WITHIN(16.0F * FLT_EPSILON, X[2U * i + 1U], B[3U * i + 1U]);
+        TEST_ASSERT_EQUAL_FLOAT(PAD, B[3U * i + 2U]);
+    }
+
+    /* Two equal rows, the second pivot is zero */
+    float S[2U * 2U] = {1.0F, 2.0F, 1.0F, 2.0F};
+    TEST_ASSERT_EQUAL_UINT32(2U, kernel_getrf(2U, 2U, S, 2U, NULL));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_gemm);
+    RUN_TEST(test_transpose);
+    RUN_TEST(test_elementwise);
+    RUN_TEST(test_getrf_and_getrs);
+
+    return UNITY_END();
+}
@@ -2,6 +2,8 @@
 /*    INCLUDED FILES                                                          */
 /******************************************************************************/
 
+#include <pthread.h>
+
 #include "unity.h"
 #include "utilities.h"
 /* TARGET LIBRARY */
@@ -27,22 +29,104 @@ __attribute__((constructor)) void init_submodule(void)
     log_init(__FILE__);
 }
 
+/* Each worker fills and checks its own matrices, across several chunks */
+static void* push_and_check(void *arg)
+{
+    const float value = (float)(uintptr_t)arg;
+    uint32_t errors = (stack == NULL) ? 0U : 1U;
+
+    for (uint32_t round = 0U; round < 20U; round++)
+    {
+        MARK mark = mark_stack();
+        for (uint32_t i = 0U; i < 50U; i++)
+        {
+            MATRIX *A = push_matrix(32U, 32U);
+            for (uint32_t j = 0U; j < A->rows * A->cols; j++)
+            {
+                A->val[j] = value;
+            }
+        }
+
+        for (ITEM *itr = stack; itr != mark.top; itr = itr->next)
+        {
+            for (uint32_t j = 0U; j < itr->matrix->rows * itr->matrix->cols; j++)
+            {
+                errors += (itr->matrix->val[j] != value) ? 1U : 0U;
+            }
+        }
+        release_stack(mark);
+    }
+
+    /* Released at exit */
+    push_matrix(8U, 8U);
+
+    return (void*)(uintptr_t)errors;
+}
+
 /******************************************************************************/
 /*    TEST FUNCTIONS                                                          */
 /******************************************************************************/
 
-void test_valid_malloc_and_free(void)
+void test_arena_alignment(void)
 {
-    MATRIX *A = matrix_malloc(4U, 7U);
     log_info(__FUNCTION__);
+    TEST_ASSERT_NULL(stack);
 
+    MATRIX *A = push_matrix(4U, 7U);
+    MATRIX *B = push_matrix(1U, 1U);
     TEST_ASSERT_NOT_NULL(A);
+    TEST_ASSERT_NOT_NULL(B);
     TEST_ASSERT_EQUAL_UINT32(4U, A->rows);
     TEST_ASSERT_EQUAL_UINT32(7U, A->cols);
-    TEST_ASSERT_NOT_NULL(A->val);
 
-    A = matrix_free(A);
-    TEST_ASSERT_NULL(A);
+    /* Values at cache-line boundaries, B right after A */
+    TEST_ASSERT_EQUAL_UINT32(0U, (uintptr_t)A->val % ARENA_ALIGN);
+    TEST_ASSERT_EQUAL_UINT32(0U, (uintptr_t)B->val % ARENA_ALIGN);
+    TEST_ASSERT_EQUAL_PTR((char*)A->val + ARENA_ALIGN_UP(sizeof(float) * 28U), stack);
+
+    /* A block larger than a chunk */
+    MATRIX *C = push_matrix(1024U, 1024U);
+    TEST_ASSERT_NOT_NULL(C);
+    TEST_ASSERT_EQUAL_UINT32(0U, (uintptr_t)C->val % ARENA_ALIGN);
+    C->val[1024U * 1024U - 1U] = 1.0F;
+
+    do {
+        stack = pop_matrix(stack);
+    } while(stack != NULL);
+}
+
+void test_mark_and_release(void)
+{
+    log_info(__FUNCTION__);
+    TEST_ASSERT_NULL(stack);
+
+    MATRIX *A = push_matrix(3U, 3U);
+    MARK mark = mark_stack();
+    TEST_ASSERT_EQUAL_PTR(stack, mark.top);
+
+    /* Enough matrices to span several chunks */
+    for (uint32_t i = 0U; i < 100U; i++)
+    {
+        TEST_ASSERT_NOT_NULL(push_matrix(64U, 64U));
+    }
+
+    release_stack(mark);
+    TEST_ASSERT_EQUAL_PTR(mark.top, stack);
+    TEST_ASSERT_EQUAL_PTR(A, stack->matrix);
+
+    /* The same memory is used again */
+    MATRIX *B = push_matrix(64U, 64U);
+    TEST_ASSERT_EQUAL_PTR((char*)A->val + ARENA_ALIGN_UP(sizeof(float) * 9U), stack);
+    TEST_ASSERT_EQUAL_UINT32(64U, B->rows);
+
+    /* An empty scope */
+    mark = mark_stack();
+    release_stack(mark);
+    TEST_ASSERT_EQUAL_PTR(B, stack->matrix);
+
+    do {
+        stack = pop_matrix(stack);
+    } while(stack != NULL);
 }
 
 void test_matrix_push_and_pop(void)
@@ -203,15 +287,47 @@ void test_set_block_matrix(void)
     TEST_ASSERT_EQUAL_PTR(D,  set_block_matrix(A, 4U, 4U, D));
 }
 
+void test_thread_stacks(void)
+{
+    pthread_t threads[4U];
+    log_info(__FUNCTION__);
+
+    ITEM *below = stack;
+    MATRIX *A = push_matrix(2U, 2U);
+    ITEM *top = stack;
+
+    for (uint32_t round = 0U; round < 2U; round++)
+    {
+        for (uintptr_t i = 0U; i < 4U; i++)
+        {
+            TEST_ASSERT_EQUAL_INT(0, pthread_create(&threads[i], NULL, push_and_check, (void*)(i + 1U)));
+        }
+        for (uint32_t i = 0U; i < 4U; i++)
+        {
+            void *errors = NULL;
+            pthread_join(threads[i], &errors);
+            TEST_ASSERT_EQUAL_UINT32(0U, (uintptr_t)errors);
+        }
+    }
+
+    /* The stack of this thread was not touched */
+    TEST_ASSERT_EQUAL_PTR(top, stack);
+    TEST_ASSERT_EQUAL_PTR(A, stack->matrix);
+    stack = pop_matrix(stack);
+    TEST_ASSERT_EQUAL_PTR(below, stack);
+}
+
 int main(void)
 {
     UNITY_BEGIN();
 
-    RUN_TEST(test_valid_malloc_and_free);
+    RUN_TEST(test_arena_alignment);
+    RUN_TEST(test_mark_and_release);
     RUN_TEST(test_matrix_push_and_pop);
     RUN_TEST(test_push_and_pop);
     RUN_TEST(test_get_block_matrix);
     RUN_TEST(test_set_block_matrix);
+    RUN_TEST(test_thread_stacks);
 
     return UNITY_END();
 }
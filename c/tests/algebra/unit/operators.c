@@ -76,6 +76,31 @@ void test_transpose(void)
     }
 }
 
+void test_transpose_blocks(void)
+{
+    /* Sizes that are not multiples of TRANSPOSE_BLOCK */
+    MATRIX *A = push_matrix(3U * TRANSPOSE_BLOCK + 5U, 2U * TRANSPOSE_BLOCK + 3U);
+    log_info(__FUNCTION__);
+
+    for (uint32_t i = 0U; i < A->rows * A->cols; i++)
+    {
+        A->val[i] = (float)i;
+    }
+
+    MATRIX *AT = transpose(A);
+    TEST_ASSERT_NOT_NULL(AT);
+    TEST_ASSERT_EQUAL_UINT32(A->cols, AT->rows);
+    TEST_ASSERT_EQUAL_UINT32(A->rows, AT->cols);
+
+    for (uint32_t row = 0U; row < A->rows; row++)
+    {
+        for (uint32_t col = 0U; col < A->cols; col++)
+        {
+            TEST_ASSERT_EQUAL_FLOAT(A->val[TO_C_CONT(A, row, col)], AT->val[TO_C_CONT(AT, col, row)]);
+        }
+    }
+}
+
 void test_add(void)
 {
     MATRIX *A = push_matrix(3U, 5U);
@@ -255,6 +280,46 @@ void test_mult(void)
     TEST_ASSERT_NULL(E);
 }
 
+void test_mult_blocks(void)
+{
+    /* Sizes that are not multiples of MULT_BLOCK */
+    MATRIX *A = push_matrix(MULT_BLOCK + 5U, 2U * MULT_BLOCK + 1U);
+    MATRIX *B = push_matrix(2U * MULT_BLOCK + 1U, MULT_BLOCK - 3U);
+    log_info(__FUNCTION__);
+
+    for (uint32_t i = 0U; i < A->rows * A->cols; i++)
+    {
+        A->val[i] = (float)(i % 5U) - 2.0F;
+    }
+    for (uint32_t i = 0U; i < B->rows * B->cols; i++)
+    {
+        B->val[i] = (float)(i % 3U);
+    }
+
+    MATRIX *C = mult(A, B);
+    TEST_ASSERT_NOT_NULL(C);
+    TEST_ASSERT_EQUAL_UINT32(A->rows, C->rows);
+    TEST_ASSERT_EQUAL_UINT32(B->cols, C->cols);
+
+    /* C is the only matrix that was pushed */
+    TEST_ASSERT_EQUAL_PTR(C, stack->matrix);
+    TEST_ASSERT_EQUAL_PTR(B, stack->next->matrix);
+
+    /* Small integers, the sums are exact in any order */
+    for (uint32_t i = 0U; i < C->rows; i++)
+    {
+        for (uint32_t j = 0U; j < C->cols; j++)
+        {
+            float expected = 0.0F;
+            for (uint32_t k = 0U; k < A->cols; k++)
+            {
+                expected += A->val[TO_C_CONT(A, i, k)] * B->val[TO_C_CONT(B, k, j)];
+            }
+            TEST_ASSERT_EQUAL_FLOAT(expected, C->val[TO_C_CONT(C, i, j)]);
+        }
+    }
+}
+
 void test_id(void)
 {
     /* TODO: to improve push when size is 0U */
@@ -319,9 +384,11 @@ int main(void)
     UNITY_BEGIN();
 
     RUN_TEST(test_transpose);
+    RUN_TEST(test_transpose_blocks);
     RUN_TEST(test_add);
     RUN_TEST(test_sub);
     RUN_TEST(test_mult);
+    RUN_TEST(test_mult_blocks);
     RUN_TEST(test_id);
     RUN_TEST(test_permute);
 
@@ -0,0 +1,158 @@
+/******************************************************************************/
+/*    INCLUDED FILES                                                          */
+/******************************************************************************/
+
+#include "unity.h"
+#include "utilities.h"
+/* TARGET LIBRARY */
+#include "storage.h"
+
+/******************************************************************************/
+/*    PRELUDE                                                                 */
+/******************************************************************************/
+
+/* setUp() and tearDown() are required by Unity */
+void setUp(void)
+{
+    return;
+}
+
+void tearDown(void)
+{
+    return;
+}
+
+__attribute__((constructor)) void init_submodule(void)
+{
+    log_init(__FILE__);
+}
+
+/******************************************************************************/
+/*    TEST FUNCTIONS                                                          */
+/******************************************************************************/
+
+void test_make_header(void)
+{
+    STORAGE_HEADER header = make_header(3U, 5U);
+    log_info(__FUNCTION__);
+
+    TEST_ASSERT_EQUAL_MEMORY(STORAGE_MAGIC, header.magic, 4U);
+    TEST_ASSERT_EQUAL_UINT32(STORAGE_VERSION, header.version);
+    TEST_ASSERT_EQUAL_UINT32(5U, header.ld);
+    TEST_ASSERT_EQUAL_UINT64(STORAGE_ALIGN, header.offset);
+    TEST_ASSERT_EQUAL_UINT32(1U, check_header(&header, STORAGE_ALIGN + sizeof(float) * 15U));
+
+    /* Truncated payload, or a file from the other endianness */
+    TEST_ASSERT_EQUAL_UINT32(0U, check_header(&header, STORAGE_ALIGN + sizeof(float) * 14U));
+    header.endian = 0x04030201U;
+    TEST_ASSERT_EQUAL_UINT32(0U, check_header(&header, STORAGE_ALIGN + sizeof(float) * 15U));
+
+    /* An offset that would wrap offset + payload, or another alignment */
+    header = make_header(3U, 5U);
+    header.offset = UINT64_MAX - 3U;
+    TEST_ASSERT_EQUAL_UINT32(0U, check_header(&header, STORAGE_ALIGN + sizeof(float) * 15U));
+    header = make_header(3U, 5U);
+    header.alignment = 64U;
+    TEST_ASSERT_EQUAL_UINT32(0U, check_header(&header, STORAGE_ALIGN + sizeof(float) * 15U));
+    /* Rows and ld whose byte count wraps */
+    header = make_header(UINT32_MAX, 5U);
+    header.ld = UINT32_MAX;
+    TEST_ASSERT_EQUAL_UINT32(0U, check_header(&header, STORAGE_ALIGN + sizeof(float) * 15U));
+}
+
+void test_save_and_map_matrix(void)
+{
+    MATRIX *A = push_matrix(4U, 3U);
+    MATRIX *B = NULL;
+    log_info(__FUNCTION__);
+
+    for (uint32_t i = 0U; i < 12U; i++)
+    {
+        A->val[i] = (float)i * 0.5F;
+    }
+
+    TEST_ASSERT_EQUAL_PTR(A, save_matrix("A.m2s", A));
+    B = map_matrix("A.m2s");
+    TEST_ASSERT_NOT_NULL(B);
+    TEST_ASSERT_EQUAL_UINT32(4U, B->rows);
+    TEST_ASSERT_EQUAL_UINT32(3U, B->cols);
+    TEST_ASSERT_EQUAL_FLOAT_ARRAY(A->val, B->val, 12U);
+    /* Zero-copy, the values are the page after the header */
+    TEST_ASSERT_EQUAL_PTR((char*)((MAPPING*)B)->base + STORAGE_ALIGN, B->val);
+
+    /* Writing to the pages does not change the file */
+    B->val[0U] = 100.0F;
+    unmap_matrix(B);
+    B = map_matrix("A.m2s");
+    TEST_ASSERT_EQUAL_FLOAT(0.0F, B->val[0U]);
+
+    unmap_matrix(B);
+    stack = pop_matrix(stack);
+    remove("A.m2s");
+}
+
+void test_write_rows(void)
+{
+    const float val[6U] = {1.0F, 2.0F, 3.0F, 4.0F, 5.0F, 6.0F};
+    STORAGE *storage = open_storage("rows.m2s", 3U, 2U);
+    MATRIX *A = NULL;
+    log_info(__FUNCTION__);
+
+    /* Streaming one row, and then the rest, but no more */
+    TEST_ASSERT_NOT_NULL(storage);
+    TEST_ASSERT_EQUAL_UINT32(1U, write_rows(storage, val, 1U));
+    TEST_ASSERT_EQUAL_UINT32(2U, write_rows(storage, &val[2U], 3U));
+    TEST_ASSERT_EQUAL_INT32(0, close_storage(storage));
+
+    A = map_matrix("rows.m2s");
+    TEST_ASSERT_NOT_NULL(A);
+    TEST_ASSERT_EQUAL_FLOAT_ARRAY(val, A->val, 6U);
+    unmap_matrix(A);
+
+    /* Missing rows make close_storage() fail, and the file is not mapped */
+    storage = open_storage("rows.m2s", 3U, 2U);
+    write_rows(storage, val, 2U);
+    TEST_ASSERT_EQUAL_INT32(EIO, close_storage(storage));
+    TEST_ASSERT_NULL(map_matrix("rows.m2s"));
+
+    TEST_ASSERT_NULL(map_matrix("missing.m2s"));
+    remove("rows.m2s");
+}
+
+void test_map_padded_rows(void)
+{
+    /* Rows of 2 floats, 3 floats apart */
+    const float val[6U] = {1.0F, 2.0F, -1.0F, 3.0F, 4.0F, -1.0F};
+    const float expVal[4U] = {1.0F, 2.0F, 3.0F, 4.0F};
+    STORAGE_HEADER header = make_header(2U, 2U);
+    FILE *file = fopen("padded.m2s", "wb");
+    MATRIX *A = NULL;
+    log_info(__FUNCTION__);
+
+    header.ld = 3U;
+    fwrite(&header, sizeof(header), 1U, file);
+    fseek(file, (long)header.offset, SEEK_SET);
+    fwrite(val, sizeof(val), 1U, file);
+    fclose(file);
+
+    /* They are copied into c-contiguous rows */
+    A = map_matrix("padded.m2s");
+    TEST_ASSERT_NOT_NULL(A);
+    TEST_ASSERT_NULL(((MAPPING*)A)->base);
+    TEST_ASSERT_EQUAL_FLOAT_ARRAY(expVal, A->val, 4U);
+
+    unmap_matrix(A);
+    remove("padded.m2s");
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_make_header);
+    RUN_TEST(test_save_and_map_matrix);
+    RUN_TEST(test_write_rows);
+    RUN_TEST(test_map_padded_rows);
+
+    return UNITY_END();
+}
@@ -0,0 +1,414 @@
+/*******************************************************************************
+*
+* Benchmarks of the C library
+*
+*   SUMMARY
+*       Microbenchmarks of the memory, operators, blas, echelon and log modules.
+*       Every run releases the matrices it pushed, so their pop_matrix() is
+*       part of the time. The cubic cases stop at smaller sizes.
+*
+*       bench [--format=table|csv|json] [--out=FILE] [--filter=NAME,...]
+*             [--min-size=N] [--max-size=N]
+*
+*       --filter takes a comma-separated list of names, a case runs when
+*       its name contains one of them.
+*
+*       Logs of the algebra are turned down to errors, the log cases call
+*       log_print() and log_matrix() directly with stderr into /dev/null.
+*
+*******************************************************************************/
+
+/******************************************************************************/
+/*    INCLUDED FILES                                                          */
+/******************************************************************************/
+
+#include <unistd.h>
+
+#include "levels.h"
+#include "bench.h"
+/* TARGET LIBRARY */
+#include "blas.h"
+#include "echelon.h"
+
+/******************************************************************************/
+/*    PRIVATE DATA                                                            */
+/******************************************************************************/
+
+#define MAX_CUBIC_SIZE      (256U)
+#define MAX_ECHELON_SIZE    (256U)
+#define MAX_LOG_SIZE        (256U)
+
+/* Inputs of a run, the stack is released down to mark after each run */
+typedef struct Inputs
+{
+    uint32_t size;
+    MATRIX   *A;
+    MATRIX   *B;
+    ITEM     *base;
+    ITEM     *mark;
+    char     *msg;
+    int      stderrFd;
+} INPUTS;
+
+/******************************************************************************/
+/*    SETUP AND TEARDOWN                                                      */
+/******************************************************************************/
+
+/* A diagonally dominant matrix, its pivots are never zero */
+static void fill(MATRIX *A)
+{
+    for (uint32_t i = 0U; i < A->rows * A->cols; i++)
+    {
+        A->val[i] = (float)(i % 7U) + 1.0F;
+    }
+    for (uint32_t i = 0U; (i < A->rows) && (i < A->cols); i++)
+    {
+        A->val[TO_C_CONT(A, i, i)] += 8.0F * (float)A->cols;
+    }
+}
+
+static void release(ITEM *mark)
+{
+    while (stack != mark)
+    {
+        stack = pop_matrix(stack);
+    }
+}
+
+static void* setup_square(uint32_t size)
+{
+    INPUTS *inputs = (INPUTS*)calloc(1U, sizeof(INPUTS));
+
+    if (inputs != NULL)
+    {
+        inputs->size = size;
+        inputs->base = stack;
+        inputs->A = push_matrix(size, size);
+        inputs->B = push_matrix(size, size);
+        fill(inputs->A);
+        fill(inputs->B);
+        inputs->mark = stack;
+        inputs->stderrFd = -1;
+    }
+
+    return inputs;
+}
+
+/* stderr is a sink of the log, it goes to /dev/null while timing */
+static void* setup_log(uint32_t size)
+{
+    INPUTS *inputs = (INPUTS*)setup_square((size < MAX_LOG_SIZE) ? size : MAX_LOG_SIZE);
+    FILE *null = fopen("/dev/null", "w");
+
+    if ((inputs != NULL) && (null != NULL))
+    {
+        inputs->size = size;
+        inputs->msg = (char*)malloc(size);
+        memset(inputs->msg, 'x', size);
+
+        fflush(stderr);
+        inputs->stderrFd = dup(STDERR_FILENO);
+        dup2(fileno(null), STDERR_FILENO);
+    }
+    if (null != NULL)
+    {
+        fclose(null);
+    }
+
+    return inputs;
+}
+
+static void teardown(void *inputs)
+{
+    INPUTS *in = (INPUTS*)inputs;
+
+    if (in->stderrFd >= 0)
+    {
+        dup2(in->stderrFd, STDERR_FILENO);
+        close(in->stderrFd);
+    }
+    release(in->base);
+    free(in->msg);
+    free(in);
+}
+
+/******************************************************************************/
+/*    RUNS                                                                    */
+/******************************************************************************/
+
+static void run_push_pop(void *inputs)
+{
+    INPUTS *in = (INPUTS*)inputs;
+    push_matrix(in->size, in->size);
+    release(in->mark);
+}
+
+static void run_get_block(void *inputs)
+{
+    INPUTS *in = (INPUTS*)inputs;
+    GET_BLOCK_MATRIX(in->A, 1U);
+    release(in->mark);
+}
+
+static void run_set_block(void *inputs)
+{
+    INPUTS *in = (INPUTS*)inputs;
+    set_block_matrix(in->A, 0U, 0U, in->B);
+}
+
+static void run_transpose(void *inputs)
+{
+    INPUTS *in = (INPUTS*)inputs;
+    transpose(in->A);
+    release(in->mark);
+}
+
+static void run_add(void *inputs)
+{
+    INPUTS *in = (INPUTS*)inputs;
+    add(in->A, in->B);
+    release(in->mark);
+}
+
+static void run_sub(void *inputs)
+{
+    INPUTS *in = (INPUTS*)inputs;
+    sub(in->A, in->B);
+    release(in->mark);
+}
+
+static void run_mult(void *inputs)
+{
+    INPUTS *in = (INPUTS*)inputs;
+    mult(in->A, in->B);
+    release(in->mark);
+}
+
+/* y := A x, x and y are the first two rows of B */
+static void run_gemv(void *inputs)
+{
+    INPUTS *in = (INPUTS*)inputs;
+    blas_gemv(BLAS_NO_TRANS, 1.0F, in->A, in->B->val, 1U, 0.0F, &in->B->val[in->size], 1U);
+}
+
+static void run_id(void *inputs)
+{
+    INPUTS *in = (INPUTS*)inputs;
+    id(in->size);
+    release(in->mark);
+}
+
+/* Swapping the first and last rows in place */
+static void run_permute(void *inputs)
+{
+    INPUTS *in = (INPUTS*)inputs;
+    permute(in->A, 0U, in->size - 1U);
+}
+
+static void run_echelon(void *inputs)
+{
+    INPUTS *in = (INPUTS*)inputs;
+    echelon(in->A);
+    release(in->mark);
+}
+
+static void run_log_print(void *inputs)
+{
+    INPUTS *in = (INPUTS*)inputs;
+    log_print(LOG_LEVEL_INFO, __FILE__, __LINE__, "%.*s", (int)in->size, in->msg);
+}
+
+static void run_log_matrix(void *inputs)
+{
+    INPUTS *in = (INPUTS*)inputs;
+    log_matrix(LOG_LEVEL_INFO, __FILE__, __LINE__, "A", in->A->val, in->A->rows, in->A->cols);
+}
+
+/******************************************************************************/
+/*    WORK PER RUN                                                            */
+/******************************************************************************/
+
+static double square_flops(uint32_t size)
+{
+    return (double)size * size;
+}
+
+static double cubic_flops(uint32_t size)
+{
+    return 2.0 * size * size * size;
+}
+
+static double gemv_flops(uint32_t size)
+{
+    return 2.0 * size * size;
+}
+
+/* lu_factor(), a rank-1 update of the trailing rows at every step */
+static double echelon_flops(uint32_t size)
+{
+    return 2.0 * size * size * size / 3.0;
+}
+
+static double one_matrix(uint32_t size)
+{
+    return sizeof(float) * (double)size * size;
+}
+
+static double two_matrices(uint32_t size)
+{
+    return 2.0 * one_matrix(size);
+}
+
+static double three_matrices(uint32_t size)
+{
+    return 3.0 * one_matrix(size);
+}
+
+static double two_rows(uint32_t size)
+{
+    return 2.0 * 2.0 * sizeof(float) * size;
+}
+
+static double message(uint32_t size)
+{
+    return (double)size;
+}
+
+static double log_bytes(uint32_t size)
+{
+    return one_matrix((size < MAX_LOG_SIZE) ? size : MAX_LOG_SIZE);
+}
+
+/******************************************************************************/
+/*    CASES                                                                   */
+/******************************************************************************/
+
+static const BENCH_CASE cases[] =
+{
+    {"push_pop",   1024U,            setup_square, run_push_pop,   teardown, NULL,          NULL},
+    {"get_block",  1024U,            setup_square, run_get_block,  teardown, NULL,          two_matrices},
+    {"set_block",  1024U,            setup_square, run_set_block,  teardown, NULL,          two_matrices},
+    {"transpose",  1024U,            setup_square, run_transpose,  teardown, NULL,          two_matrices},
+    {"add",        1024U,            setup_square, run_add,        teardown, square_flops,  three_matrices},
+    {"sub",        1024U,            setup_square, run_sub,        teardown, square_flops,  three_matrices},
+    {"mult",       MAX_CUBIC_SIZE,   setup_square, run_mult,       teardown, cubic_flops,   three_matrices},
+    {"gemv",       1024U,            setup_square, run_gemv,       teardown, gemv_flops,    one_matrix},
+    {"id",         1024U,            setup_square, run_id,         teardown, NULL,          one_matrix},
+    {"permute",    1024U,            setup_square, run_permute,    teardown, NULL,          two_rows},
+    {"echelon",    MAX_ECHELON_SIZE, setup_square, run_echelon,    teardown, echelon_flops, one_matrix},
+    {"log_print",  1024U,            setup_log,    run_log_print,  teardown, NULL,          message},
+    {"log_matrix", MAX_LOG_SIZE,     setup_log,    run_log_matrix, teardown, NULL,          log_bytes},
+};
+
+#define CASES_LEN (sizeof(cases) / sizeof(cases[0U]))
+
+/******************************************************************************/
+/*    MAIN                                                                    */
+/******************************************************************************/
+
+static uint32_t is_selected(const char *name, const char *filter)
+{
+    char entry[64U];
+
+    while ((filter != NULL) && (*filter != '\0'))
+    {
+        const char *end = strchr(filter, ',');
+        size_t length = (end == NULL) ? strlen(filter) : (size_t)(end - filter);
+
+        if ((length != 0U) && (length < sizeof(entry)))
+        {
+            memcpy(entry, filter, length);
+            entry[length] = '\0';
+            if (strstr(name, entry) != NULL)
+            {
+                return 1U;
+            }
+        }
+        filter = (end == NULL) ? NULL : end + 1;
+    }
+
+    return 0U;
+}
+
+int main(int argc, char **argv)
+{
+    static BENCH_RESULT results[CASES_LEN * BENCH_SIZES_LEN];
+    const uint32_t sizes[BENCH_SIZES_LEN] = BENCH_SIZES;
+    uint32_t format = BENCH_TABLE;
+    uint32_t minSize = 0U;
+    uint32_t maxSize = UINT32_MAX;
+    const char *filter = NULL;
+    const char *out = NULL;
+    uint32_t count = 0U;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--format=csv") == 0)
+        {
+            format = BENCH_CSV;
+        }
+        else if (strcmp(argv[i], "--format=json") == 0)
+        {
+            format = BENCH_JSON;
+        }
+        else if (strcmp(argv[i], "--format=table") == 0)
+        {
+            format = BENCH_TABLE;
+        }
+        else if (strncmp(argv[i], "--out=", 6U) == 0)
+        {
+            out = &argv[i][6U];
+        }
+        else if (strncmp(argv[i], "--filter=", 9U) == 0)
+        {
+            filter = &argv[i][9U];
+        }
+        else if (strncmp(argv[i], "--min-size=", 11U) == 0)
+        {
+            minSize = (uint32_t)strtoul(&argv[i][11U], NULL, 10);
+        }
+        else if (strncmp(argv[i], "--max-size=", 11U) == 0)
+        {
+            maxSize = (uint32_t)strtoul(&argv[i][11U], NULL, 10);
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [--format=table|csv|json] [--out=FILE] "
+                    "[--filter=NAME,...] [--min-size=N] [--max-size=N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    log_set_level(LOG_MODULE_ALL, LOG_LEVEL_ERROR);
+
+    for (uint32_t c = 0U; c < CASES_LEN; c++)
+    {
+        if ((filter != NULL) && (is_selected(cases[c].name, filter) == 0U))
+        {
+            continue;
+        }
+
+        for (uint32_t s = 0U; s < BENCH_SIZES_LEN; s++)
+        {
+            if ((sizes[s] <= cases[c].maxSize) && (minSize <= sizes[s]) && (sizes[s] <= maxSize) &&
+                (bench_case(&cases[c], sizes[s], &results[count]) != NULL))
+            {
+                count++;
+            }
+        }
+    }
+
+    FILE *stream = (out == NULL) ? stdout : fopen(out, "w");
+    if (stream == NULL)
+    {
+        fprintf(stderr, "Unable to open %s.\n", out);
+        return 1;
+    }
+    bench_report(stream, format, results, count);
+    if (stream != stdout)
+    {
+        fclose(stream);
+    }
+
+    return 0;
+}
@@ -0,0 +1,259 @@
+/*******************************************************************************
+*
+* EXPERIMENTAL - Benchmark submodule
+*
+*   SUMMARY
+*       This single-header submodule times microbenchmarks. A case runs at
+*       every size of BENCH_SIZES up to its maxSize:
+*
+*       a) the number of runs per trial doubles until a batch of runs lasts
+*          BENCH_BATCH_NS, these batches are the warmup,
+*       b) trials are timed with CLOCK_MONOTONIC, BENCH_MAX_TRIALS of them
+*          or as many as fit in BENCH_BUDGET_NS, BENCH_MIN_TRIALS at least,
+*       c) the time of a run is reported as the median and the p99 of the
+*          trials, with GFLOP/s and GB/s at the median,
+*       d) results are printed as a table, CSV or JSON. JSON keeps the time
+*          of every trial to compare runs.
+*
+*******************************************************************************/
+
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/*    INCLUDED FILES                                                          */
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/******************************************************************************/
+/*    DEFINITIONS                                                             */
+/******************************************************************************/
+
+#define BENCH_SIZES         {4U, 16U, 64U, 256U, 1024U}
+#define BENCH_SIZES_LEN     (5U)
+
+#define BENCH_BATCH_NS      (1000000ULL)
+#define BENCH_BUDGET_NS     (1000000000ULL)
+#define BENCH_MIN_TRIALS    (5U)
+#define BENCH_MAX_TRIALS    (31U)
+
+/* Report formats */
+#define BENCH_TABLE         (0U)
+#define BENCH_CSV           (1U)
+#define BENCH_JSON          (2U)
+
+/******************************************************************************/
+/*    PUBLIC TYPES                                                            */
+/******************************************************************************/
+
+/* setup() makes the inputs of run() for a size, teardown() releases them */
+typedef struct BenchCase
+{
+    const char *name;
+    uint32_t   maxSize;
+    void*      (*setup)(uint32_t size);
+    void       (*run)(void *inputs);
+    void       (*teardown)(void *inputs);
+    /* Work of a run, flops() is NULL when there is no arithmetic */
+    double     (*flops)(uint32_t size);
+    double     (*bytes)(uint32_t size);
+} BENCH_CASE;
+
+/* Times are in ns per run */
+typedef struct BenchResult
+{
+    const char *name;
+    uint32_t   size;
+    uint32_t   trials;
+    uint64_t   runs;
+    double     median;
+    double     p99;
+    double     gflops;
+    double     gbytes;
+    double     samples[BENCH_MAX_TRIALS];
+} BENCH_RESULT;
+
+/******************************************************************************/
+/*    API                                                                     */
+/******************************************************************************/
+
+/**
+ * @brief   Function that reads the monotonic clock.
+ *
+ * @return  The time in ns.
+ */
+uint64_t bench_now(void);
+
+/**
+ * @brief   Function that times a case at one size.
+ *
+ * @return  result, or NULL when setup() fails.
+ */
+BENCH_RESULT* bench_case(const BENCH_CASE *bench, uint32_t size, BENCH_RESULT *result);
+
+/**
+ * @brief   Function that prints results in one of the BENCH_* formats.
+ *
+ * @examples bench_report(stdout, BENCH_CSV, results, count);
+ */
+void bench_report(FILE *stream, uint32_t format, const BENCH_RESULT *results, uint32_t count);
+
+/******************************************************************************/
+/*    STATIC FUNCTION PROTOTYPES                                              */
+/******************************************************************************/
+
+static uint64_t time_batch(const BENCH_CASE *bench, void *inputs, uint64_t runs);
+
+static int compare_samples(const void *a, const void *b);
+
+static double get_percentile(const double *sorted, uint32_t count, double p);
+
+/******************************************************************************/
+/*    IMPLEMENTATION                                                          */
+/******************************************************************************/
+
+uint64_t bench_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+BENCH_RESULT* bench_case(const BENCH_CASE *bench, uint32_t size, BENCH_RESULT *result)
+{
+    double sorted[BENCH_MAX_TRIALS];
+    void *inputs = (bench->setup == NULL) ? NULL : bench->setup(size);
+    uint64_t runs = 1U;
+    uint64_t elapsed = 0U;
+
+    if ((bench->setup != NULL) && (inputs == NULL))
+    {
+        return NULL;
+    }
+
+    /* Warming up while finding the runs per trial */
+    while ((elapsed = time_batch(bench, inputs, runs)) < BENCH_BATCH_NS)
+    {
+        runs *= 2U;
+    }
+
+    memset(result, 0, sizeof(BENCH_RESULT));
+    result->name = bench->name;
+    result->size = size;
+    result->runs = runs;
+
+    uint64_t start = bench_now();
+    while ((result->trials < BENCH_MAX_TRIALS) &&
+           ((result->trials < BENCH_MIN_TRIALS) || (bench_now() - start + elapsed < BENCH_BUDGET_NS)))
+    {
+        elapsed = time_batch(bench, inputs, runs);
+        result->samples[result->trials] = (double)elapsed / (double)runs;
+        result->trials++;
+    }
+
+    if (bench->teardown != NULL)
+    {
+        bench->teardown(inputs);
+    }
+
+    memcpy(sorted, result->samples, sizeof(double) * result->trials);
+    qsort(sorted, result->trials, sizeof(double), compare_samples);
+    result->median = get_percentile(sorted, result->trials, 0.5);
+    result->p99 = get_percentile(sorted, result->trials, 0.99);
+
+    /* work per ns is G per s */
+    result->gflops = (bench->flops == NULL) ? 0.0 : bench->flops(size) / result->median;
+    result->gbytes = (bench->bytes == NULL) ? 0.0 : bench->bytes(size) / result->median;
+
+    return result;
+}
+
+void bench_report(FILE *stream, uint32_t format, const BENCH_RESULT *results, uint32_t count)
+{
+    if (format == BENCH_CSV)
+    {
+        fprintf(stream, "name,size,trials,runs,median_ns,p99_ns,gflops,gbytes\n");
+        for (uint32_t i = 0U; i < count; i++)
+        {
+            const BENCH_RESULT *r = &results[i];
+            fprintf(stream, "%s,%u,%u,%llu,%.1f,%.1f,%.4f,%.4f\n", r->name, r->size, r->trials,
+                    (unsigned long long)r->runs, r->median, r->p99, r->gflops, r->gbytes);
+        }
+    }
+    else if (format == BENCH_JSON)
+    {
+        fprintf(stream, "{\n  \"context\": {\"batch_ns\": %llu, \"max_trials\": %u},\n  \"benchmarks\": [",
+                (unsigned long long)BENCH_BATCH_NS, BENCH_MAX_TRIALS);
+        for (uint32_t i = 0U; i < count; i++)
+        {
+            const BENCH_RESULT *r = &results[i];
+            fprintf(stream, "%s\n    {\"name\": \"%s/%u\", \"trials\": %u, \"runs\": %llu, "
+                    "\"median_ns\": %.1f, \"p99_ns\": %.1f, \"gflops\": %.4f, \"gbytes\": %.4f, \"samples_ns\": [",
+                    (i == 0U) ? "" : ",", r->name, r->size, r->trials, (unsigned long long)r->runs,
+                    r->median, r->p99, r->gflops, r->gbytes);
+            for (uint32_t j = 0U; j < r->trials; j++)
+            {
+                fprintf(stream, "%s%.1f", (j == 0U) ? "" : ", ", r->samples[j]);
+            }
+            fprintf(stream, "]}");
+        }
+        fprintf(stream, "\n  ]\n}\n");
+    }
+    else
+    {
+        fprintf(stream, "%-24s %14s %14s %8s %10s %10s\n", "Benchmark", "Median (ns)", "p99 (ns)",
+                "Trials", "GFLOP/s", "GB/s");
+        for (uint32_t i = 0U; i < count; i++)
+        {
+            const BENCH_RESULT *r = &results[i];
+            char name[32U];
+            snprintf(name, sizeof(name), "%s/%u", r->name, r->size);
+            fprintf(stream, "%-24s %14.1f %14.1f %8u %10.3f %10.3f\n", name, r->median, r->p99,
+                    r->trials, r->gflops, r->gbytes);
+        }
+    }
+}
+
+static uint64_t time_batch(const BENCH_CASE *bench, void *inputs, uint64_t runs)
+{
+    uint64_t start = bench_now();
+
+    for (uint64_t i = 0U; i < runs; i++)
+    {
+        bench->run(inputs);
+    }
+
+    return bench_now() - start;
+}
+
+static int compare_samples(const void *a, const void *b)
+{
+    const double x = *(const double*)a;
+    const double y = *(const double*)b;
+
+    return (x > y) - (x < y);
+}
+
+/* Nearest rank, the p99 of few trials is their maximum */
+static double get_percentile(const double *sorted, uint32_t count, double p)
+{
+    uint32_t rank = (uint32_t)(p * count + 0.999999);
+
+    return sorted[(rank == 0U) ? 0U : rank - 1U];
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BENCH_H_ */
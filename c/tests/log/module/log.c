@@ -61,12 +61,34 @@ void test_log_matrix(void)
     } while(stack != NULL);
 }
 
+void test_log_set_file(void)
+{
+    char text[MAX_STR_LEN] = {0};
+    FILE *descriptor = NULL;
+    log_info(__FUNCTION__);
+
+    /* The sinks were opened by the first message, the file moves */
+    log_set_file("lazy.log");
+    LOG_ERROR("This should be in lazy.log!");
+    log_flush();
+
+    descriptor = fopen("lazy.log", "r");
+    TEST_ASSERT_NOT_NULL(descriptor);
+    TEST_ASSERT_GREATER_THAN_UINT32(0U, fread(text, 1U, sizeof(text) - 1U, descriptor));
+    TEST_ASSERT_NOT_NULL(strstr(text, "This should be in lazy.log!"));
+    fclose(descriptor);
+
+    log_set_file(NULL);
+    remove("lazy.log");
+}
+
 int main(void)
 {
     UNITY_BEGIN();
 
     RUN_TEST(test_examples);
     RUN_TEST(test_log_matrix);
+    RUN_TEST(test_log_set_file);
 
     return UNITY_END();
 }
@@ -51,7 +51,7 @@ void test_get(void)
 
 void test_set(void)
 {
-    LOG newFile = {stdout, "stdout"};
+    LOG newFile = {stdout, "stdout", NULL};
     LOG *files = NULL;
     log_info(__FUNCTION__);
 
@@ -191,6 +191,289 @@ void test_destructor(void)
     remove("tmp");
 }
 
+/* helper function to get the size of a file, -1 when it does not exist */
+off_t get_size(const char *filename)
+{
+    struct stat info;
+
+    return (stat(filename, &info) == 0) ? info.st_size : -1;
+}
+
+void test_log_file_write(void)
+{
+    char record[40U];
+    struct iovec iov = {record, sizeof(record)};
+    LOG *file = open("buffered.log");
+    log_info(__FUNCTION__);
+
+    TEST_ASSERT_NOT_NULL(file);
+    TEST_ASSERT_NOT_NULL(file->sink);
+    TEST_ASSERT_EQUAL_UINT32(0U, (uintptr_t)file->sink->buffer % LOG_FILE_ALIGN);
+    memset(record, 'x', sizeof(record));
+
+    /* Buffered until it is flushed */
+    log_file_write(file, &iov, 1U);
+    TEST_ASSERT_EQUAL_INT32(0, get_size("buffered.log"));
+    TEST_ASSERT_EQUAL_UINT32(sizeof(record), file->sink->used);
+
+    flush(file);
+    TEST_ASSERT_EQUAL_INT32(sizeof(record), get_size("buffered.log"));
+    TEST_ASSERT_EQUAL_UINT32(0U, file->sink->used);
+
+    /* Records longer than the buffer go through it in chunks */
+    char *longRecord = malloc(LOG_FILE_BUFFER_LEN + 10U);
+    struct iovec longIov = {longRecord, LOG_FILE_BUFFER_LEN + 10U};
+    memset(longRecord, 'y', LOG_FILE_BUFFER_LEN + 10U);
+    log_file_write(file, &longIov, 1U);
+    TEST_ASSERT_EQUAL_INT32(sizeof(record) + LOG_FILE_BUFFER_LEN, get_size("buffered.log"));
+    TEST_ASSERT_EQUAL_UINT32(10U, file->sink->used);
+
+    flush(file);
+    free(longRecord);
+    free_sink(file->sink);
+    fclose(file->descriptor);
+    free(file);
+    remove("buffered.log");
+}
+
+void test_rotate(void)
+{
+    char record[40U];
+    struct iovec iov = {record, sizeof(record)};
+    log_info(__FUNCTION__);
+
+    /* Rotating every 64 bytes, keeping two old files */
+    log_set_rotation(64U, 0U, 2U);
+    LOG *file = open("rotate.log");
+    TEST_ASSERT_NOT_NULL(file);
+    memset(record, 'z', sizeof(record));
+
+    for (uint32_t i = 0U; i < 6U; i++)
+    {
+        log_file_write(file, &iov, 1U);
+    }
+
+    /* Every second record rotates, the oldest segment was removed */
+    TEST_ASSERT_EQUAL_INT32(0, get_size("rotate.log"));
+    TEST_ASSERT_EQUAL_INT32(2U * sizeof(record), get_size("rotate.log.1"));
+    TEST_ASSERT_EQUAL_INT32(2U * sizeof(record), get_size("rotate.log.2"));
+    TEST_ASSERT_EQUAL_INT32(-1, get_size("rotate.log.3"));
+
+    log_set_rotation(LOG_FILE_SEGMENT_LEN, LOG_FILE_MAX_AGE, LOG_FILE_MAX_FILES);
+    free_sink(file->sink);
+    fclose(file->descriptor);
+    free(file);
+    remove("rotate.log");
+    remove("rotate.log.1");
+    remove("rotate.log.2");
+}
+
+void test_log_set_file(void)
+{
+    LOG *files = get();
+    log_info(__FUNCTION__);
+
+    /* Nothing is open, the name waits for the sinks */
+    log_set_file("custom.log");
+    TEST_ASSERT_NULL(files[1U].descriptor);
+    TEST_ASSERT_EQUAL_INT32(-1, get_size("custom.log"));
+
+    files = init(1U);
+    TEST_ASSERT_NOT_NULL(files[1U].descriptor);
+    TEST_ASSERT_EQUAL_STRING("custom.log", files[1U].name);
+
+    /* An open file is closed, the new one takes its place */
+    log_set_file("renamed.log");
+    TEST_ASSERT_NOT_NULL(files[1U].descriptor);
+    TEST_ASSERT_EQUAL_STRING("renamed.log", files[1U].name);
+    TEST_ASSERT_EQUAL_INT32(0, get_size("renamed.log"));
+
+    close_file(&files[1U]);
+    TEST_ASSERT_NULL(files[1U].descriptor);
+    TEST_ASSERT_NULL(files[1U].name);
+    log_set_file(NULL);
+    remove("custom.log");
+    remove("renamed.log");
+}
+
+/* Records of a thread, more than a ring holds before it is drained */
+#define PUBLISHERS         (4U)
+#define PUBLISHED_RECORDS  (4000U)
+
+void* publish(void *arg)
+{
+    const uint32_t thread = (uint32_t)(uintptr_t)arg;
+    char record[32U];
+
+    for (uint32_t i = 0U; i < PUBLISHED_RECORDS; i++)
+    {
+        struct iovec iov = {record, 0U};
+        iov.iov_len = (size_t)sprintf(record, "%u %u\n", thread, i);
+        log_file_publish(&iov, 1U);
+    }
+
+    return NULL;
+}
+
+void test_log_file_publish(void)
+{
+    pthread_t threads[PUBLISHERS];
+    uint32_t expected[PUBLISHERS] = {0U};
+    uint32_t thread = 0U, i = 0U, total = 0U;
+    LOG *files = get();
+    LOG *file = open(make_name("publish.log"));
+    log_info(__FUNCTION__);
+
+    TEST_ASSERT_NOT_NULL(file);
+    set(file);
+    free(file);
+    start_writer();
+
+    for (uint32_t t = 0U; t < PUBLISHERS; t++)
+    {
+        pthread_create(&threads[t], NULL, publish, (void*)(uintptr_t)t);
+    }
+    for (uint32_t t = 0U; t < PUBLISHERS; t++)
+    {
+        pthread_join(threads[t], NULL);
+    }
+    TEST_ASSERT_EQUAL_UINT32(1U, stop_writer());
+    log_flush();
+
+    /* Every record is whole, and the ones of a thread keep their order */
+    FILE *descriptor = fopen("publish.log", "r");
+    TEST_ASSERT_NOT_NULL(descriptor);
+    while (fscanf(descriptor, "%u %u\n", &thread, &i) == 2)
+    {
+        TEST_ASSERT_GREATER_THAN_UINT32(thread, PUBLISHERS);
+        TEST_ASSERT_EQUAL_UINT32(expected[thread], i);
+        expected[thread]++;
+        total++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(PUBLISHERS * PUBLISHED_RECORDS, total);
+    fclose(descriptor);
+
+    close_file(&files[1U]);
+    remove("publish.log");
+}
+
+/* Files that test_log_set_file_while_publishing() goes through */
+#define SWAPPED_FILES      (8U)
+
+static pthread_barrier_t swapStart;
+
+void* publish_while_swapping(void *arg)
+{
+    pthread_barrier_wait(&swapStart);
+    return publish(arg);
+}
+
+void test_log_set_file_while_publishing(void)
+{
+    pthread_t threads[PUBLISHERS];
+    uint32_t thread = 0U, i = 0U, total = 0U;
+    char name[32U], line[64U];
+    LOG *files = get();
+    log_info(__FUNCTION__);
+
+    log_set_file("swap0.log");
+    files = init(1U);
+    TEST_ASSERT_NOT_NULL(files[1U].sink);
+    start_writer();
+
+    pthread_barrier_init(&swapStart, NULL, PUBLISHERS + 1U);
+    for (uint32_t t = 0U; t < PUBLISHERS; t++)
+    {
+        pthread_create(&threads[t], NULL, publish_while_swapping, (void*)(uintptr_t)t);
+    }
+    /* The sinks are swapped under the publishers, no record is lost */
+    pthread_barrier_wait(&swapStart);
+    for (uint32_t f = 1U; f < SWAPPED_FILES; f++)
+    {
+        sprintf(name, "swap%u.log", f);
+        log_set_file(name);
+    }
+    for (uint32_t t = 0U; t < PUBLISHERS; t++)
+    {
+        pthread_join(threads[t], NULL);
+    }
+    pthread_barrier_destroy(&swapStart);
+    TEST_ASSERT_EQUAL_UINT32(1U, stop_writer());
+    log_flush();
+    close_file(&files[1U]);
+    log_set_file(NULL);
+
+    for (uint32_t f = 0U; f < SWAPPED_FILES; f++)
+    {
+        sprintf(name, "swap%u.log", f);
+        FILE *descriptor = fopen(name, "r");
+        TEST_ASSERT_NOT_NULL(descriptor);
+        /* Past the messages of log_set_file() itself */
+        while (fgets(line, sizeof(line), descriptor) != NULL)
+        {
+            total += (sscanf(line, "%u %u", &thread, &i) == 2) ? 1U : 0U;
+        }
+        fclose(descriptor);
+        remove(name);
+    }
+    TEST_ASSERT_EQUAL_UINT32(PUBLISHERS * PUBLISHED_RECORDS, total);
+}
+
+static uint32_t stopped = 0U;
+
+void* stop(void *arg)
+{
+    (void)arg;
+    stop_writer();
+    __atomic_store_n(&stopped, 1U, __ATOMIC_RELEASE);
+
+    return NULL;
+}
+
+void test_stop_writer(void)
+{
+    pthread_t stopper;
+    const struct timespec wait = {0, 50000000L};
+    struct iovec iov = {"late\n", 5U};
+    char line[64U];
+    uint32_t late = 0U;
+    LOG *files = get();
+    LOG *file = open(make_name("stop.log"));
+    log_info(__FUNCTION__);
+
+    TEST_ASSERT_NOT_NULL(file);
+    set(file);
+    free(file);
+    start_writer();
+
+    /* A push that saw the writer running, stop_writer() drains after it */
+    RING *ring = get_ring();
+    TEST_ASSERT_NOT_NULL(ring);
+    __atomic_store_n(&ring->pushing, 1U, __ATOMIC_SEQ_CST);
+    pthread_create(&stopper, NULL, stop, NULL);
+    nanosleep(&wait, NULL);
+    TEST_ASSERT_EQUAL_UINT32(0U, __atomic_load_n(&stopped, __ATOMIC_ACQUIRE));
+
+    push_record(ring, &iov, 1U, iov.iov_len);
+    __atomic_store_n(&ring->pushing, 0U, __ATOMIC_RELEASE);
+    pthread_join(stopper, NULL);
+    TEST_ASSERT_EQUAL_UINT32(1U, stopped);
+    TEST_ASSERT_EQUAL_UINT64(ring->head, ring->tail);
+    log_flush();
+
+    FILE *descriptor = fopen("stop.log", "r");
+    TEST_ASSERT_NOT_NULL(descriptor);
+    while (fgets(line, sizeof(line), descriptor) != NULL)
+    {
+        late += (strcmp(line, "late\n") == 0) ? 1U : 0U;
+    }
+    TEST_ASSERT_EQUAL_UINT32(1U, late);
+    fclose(descriptor);
+
+    close_file(&files[1U]);
+    remove("stop.log");
+}
+
 int main(void)
 {
     UNITY_BEGIN();
@@ -203,6 +486,12 @@ int main(void)
     RUN_TEST(test_init);
     RUN_TEST(test_constructor);
     RUN_TEST(test_destructor);
+    RUN_TEST(test_log_file_write);
+    RUN_TEST(test_rotate);
+    RUN_TEST(test_log_set_file);
+    RUN_TEST(test_log_file_publish);
+    RUN_TEST(test_log_set_file_while_publishing);
+    RUN_TEST(test_stop_writer);
 
     return UNITY_END();
 }
@@ -0,0 +1,114 @@
+/******************************************************************************/
+/*    INCLUDED FILES                                                          */
+/******************************************************************************/
+
+#include "unity.h"
+#include "utilities.h"
+/* TARGET LIBRARY */
+#include "format.h"
+
+/******************************************************************************/
+/*    PRELUDE                                                                 */
+/******************************************************************************/
+
+/* setUp() and tearDown() are required by Unity */
+void setUp(void)
+{
+    return;
+}
+
+void tearDown(void)
+{
+    return;
+}
+
+__attribute__((constructor)) void init_submodule(void)
+{
+    log_init(__FILE__);
+}
+
+/******************************************************************************/
+/*    TEST FUNCTIONS                                                          */
+/******************************************************************************/
+
+void test_to_decimal(void)
+{
+    log_info(__FUNCTION__);
+
+    /* 0.1f is 0x3DCCCCCD, 13421773 * 2^-27 */
+    DECIMAL actual = to_decimal(0x4CCCCDU, 0x7BU);
+    TEST_ASSERT_EQUAL_UINT32(1U, actual.mantissa);
+    TEST_ASSERT_EQUAL_INT32(-1, actual.exponent);
+
+    /* 1.0f has no digit to remove but itself */
+    actual = to_decimal(0U, 0x7FU);
+    TEST_ASSERT_EQUAL_UINT32(1U, actual.mantissa);
+    TEST_ASSERT_EQUAL_INT32(0, actual.exponent);
+
+    /* Smallest subnormal, 1e-45 */
+    actual = to_decimal(1U, 0U);
+    TEST_ASSERT_EQUAL_UINT32(1U, actual.mantissa);
+    TEST_ASSERT_EQUAL_INT32(-45, actual.exponent);
+}
+
+void test_write_digits(void)
+{
+    char actual[FORMAT_FLOAT_LEN] = {0};
+    log_info(__FUNCTION__);
+
+    TEST_ASSERT_EQUAL_UINT32(3U, write_digits(actual, 123U, 3U));
+    TEST_ASSERT_EQUAL_STRING("123", actual);
+    /* Leading zeros when length is larger */
+    TEST_ASSERT_EQUAL_UINT32(4U, write_digits(actual, 7U, 4U));
+    TEST_ASSERT_EQUAL_STRING("0007", actual);
+}
+
+void test_format_float(void)
+{
+    const float input[] = {0.1f, 1.0f, -2.5f, 100.0f, 123456790.0f, 1e9f, 1e-4f,
+                           1e-5f, 3.14159265f, -0.0f, 3.4028235e38f, -1.1754944e-38f};
+    const char *expected[] = {"0.1", "1.0", "-2.5", "100.0", "123456790.0", "1e+09", "0.0001",
+                              "1e-05", "3.1415927", "-0.0", "3.4028235e+38", "-1.1754944e-38"};
+    char actual[FORMAT_FLOAT_LEN];
+    log_info(__FUNCTION__);
+
+    for (uint32_t i = 0U; i < sizeof(input) / sizeof(input[0U]); i++)
+    {
+        TEST_ASSERT_EQUAL_UINT32(strlen(expected[i]), format_float(actual, input[i]));
+        TEST_ASSERT_EQUAL_STRING(expected[i], actual);
+    }
+
+    format_float(actual, 0.0f / 0.0f);
+    TEST_ASSERT_EQUAL_STRING("nan", actual);
+    format_float(actual, -1.0f / 0.0f);
+    TEST_ASSERT_EQUAL_STRING("-inf", actual);
+}
+
+void test_round_trip(void)
+{
+    char actual[FORMAT_FLOAT_LEN];
+    log_info(__FUNCTION__);
+
+    /* A stride through every positive float, subnormals included */
+    for (uint32_t bits = 1U; bits < 0x7F800000U; bits += 65521U)
+    {
+        float value, back;
+        memcpy(&value, &bits, sizeof(value));
+
+        TEST_ASSERT_TRUE(format_float(actual, value) < FORMAT_FLOAT_LEN);
+        back = strtof(actual, NULL);
+        TEST_ASSERT_EQUAL_MEMORY(&value, &back, sizeof(value));
+    }
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_to_decimal);
+    RUN_TEST(test_write_digits);
+    RUN_TEST(test_format_float);
+    RUN_TEST(test_round_trip);
+
+    return UNITY_END();
+}
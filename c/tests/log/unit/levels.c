@@ -34,64 +34,112 @@ __attribute__((constructor)) void init_submodule(void)
 
 void test_get_src(void)
 {
-    char *buffer = malloc(sizeof(char) * MAX_STR_LEN);
-    char *actual = NULL;
+    char buffer[MAX_STR_LEN];
+    char actual[MAX_STR_LEN];
     log_info(__FUNCTION__);
 
     sprintf(buffer, RED("[ ERROR ] %s:%d"), __FILE__, 44);
-    actual = get_src(0, __FILE__, 44);
+    TEST_ASSERT_EQUAL_UINT32(strlen(buffer), get_src(actual, MAX_STR_LEN, 0, __FILE__, 44));
     TEST_ASSERT_EQUAL_STRING(actual, buffer);
-    free(actual);
 
     sprintf(buffer, YELLOW("[WARNING] %s:%d"), __FILE__, 48);
-    actual = get_src(1, __FILE__, 48);
+    TEST_ASSERT_EQUAL_UINT32(strlen(buffer), get_src(actual, MAX_STR_LEN, 1, __FILE__, 48));
     TEST_ASSERT_EQUAL_STRING(actual, buffer);
-    free(actual);
 
     sprintf(buffer, GREEN("[ INFO  ] %s:%d"), __FILE__, 52);
-    actual = get_src(2, __FILE__, 52);
+    TEST_ASSERT_EQUAL_UINT32(strlen(buffer), get_src(actual, MAX_STR_LEN, 2, __FILE__, 52));
     TEST_ASSERT_EQUAL_STRING(actual, buffer);
-    free(actual);
 
     sprintf(buffer, CYAN("[ DEBUG ] %s:%d"), __FILE__, 56);
-    actual = get_src(3, __FILE__, 56);
+    TEST_ASSERT_EQUAL_UINT32(strlen(buffer), get_src(actual, MAX_STR_LEN, 3, __FILE__, 56));
     TEST_ASSERT_EQUAL_STRING(actual, buffer);
-    free(actual);
 
     sprintf(buffer, PURPLE("[ TRACE ] %s:%d"), __FILE__, 60);
-    actual = get_src(4, __FILE__, 60);
+    TEST_ASSERT_EQUAL_UINT32(strlen(buffer), get_src(actual, MAX_STR_LEN, 4, __FILE__, 60));
     TEST_ASSERT_EQUAL_STRING(actual, buffer);
-    free(actual);
 
-    free(buffer);
+    /* Too short, it returns the length it needs and it does not overflow */
+    TEST_ASSERT_EQUAL_UINT32(strlen(buffer), get_src(actual, 8U, 4, __FILE__, 60));
+    TEST_ASSERT_EQUAL_UINT32(7U, strlen(actual));
 }
 
 /* helper function to simulate variadic function */
-char* create_variadic_args(const char *format, ...)
+size_t create_variadic_args(char *actual, const size_t size, const char *format, ...)
 {
-    char * actual = NULL;
+    size_t len = 0U;
     va_list args;
     log_info(__FUNCTION__);
 
     va_start(args, format);
-    actual = get_msg(format, args);
+    len = get_msg(actual, size, format, args);
     va_end(args);
 
-    return actual;
+    return len;
 }
 
 void test_get_msg(void)
 {
-    char *actual = create_variadic_args("%s:%d %s", "test", 87, "END");
-    char *buffer = malloc(sizeof(char) * MAX_STR_LEN);
+    char actual[MAX_STR_LEN];
+    char buffer[MAX_STR_LEN];
+    size_t len = create_variadic_args(actual, MAX_STR_LEN, "%s:%d %s", "test", 87, "END");
     log_info(__FUNCTION__);
 
     sprintf(buffer, "%s:%d %s", "test", 87, "END");
 
     TEST_ASSERT_EQUAL_STRING(actual, buffer);
+    TEST_ASSERT_EQUAL_UINT32(strlen(buffer), len);
+
+    /* Too short, it returns the length it needs and it does not overflow */
+    len = create_variadic_args(actual, 4U, "%s:%d %s", "test", 87, "END");
+    TEST_ASSERT_EQUAL_UINT32(strlen(buffer), len);
+    TEST_ASSERT_EQUAL_STRING("tes", actual);
+}
+
+void test_get_buffer(void)
+{
+    size_t size = 1U;
+    log_info(__FUNCTION__);
+
+    char *buffer = get_buffer(&size);
+    TEST_ASSERT_NOT_NULL(buffer);
+    TEST_ASSERT_EQUAL_UINT32(MAX_RECORD_LEN, size);
+
+    /* It only grows, and it is reused by the next calls */
+    size = 3U * MAX_RECORD_LEN;
+    buffer = get_buffer(&size);
+    TEST_ASSERT_NOT_NULL(buffer);
+    TEST_ASSERT_EQUAL_UINT32(4U * MAX_RECORD_LEN, size);
+
+    size = 1U;
+    TEST_ASSERT_EQUAL_PTR(buffer, get_buffer(&size));
+    TEST_ASSERT_EQUAL_UINT32(4U * MAX_RECORD_LEN, size);
+}
+
+void test_log_print_long(void)
+{
+    LOG newFile = {tmpfile(), "tmpfile", NULL};
+    char *msg = malloc(3U * MAX_RECORD_LEN);
+    char *actual = calloc(4U * MAX_RECORD_LEN, sizeof(char));
+    log_info(__FUNCTION__);
+
+    TEST_ASSERT_NOT_NULL(newFile.descriptor);
+    memset(msg, 'x', 3U * MAX_RECORD_LEN - 1U);
+    msg[3U * MAX_RECORD_LEN - 1U] = '\0';
 
+    /* Logging into a temporary file to read the record back */
+    set(&newFile);
+    log_print(LOG_LEVEL_ERROR, __FILE__, __LINE__, "%s|%s", "long", msg);
+    set((LOG*)NULL);
+
+    pread(fileno(newFile.descriptor), actual, 4U * MAX_RECORD_LEN - 1U, 0);
+    /* Nothing was truncated */
+    TEST_ASSERT_NOT_NULL(strstr(actual, msg));
+    TEST_ASSERT_NOT_NULL(strstr(actual, "long|"));
+    TEST_ASSERT_EQUAL_STRING(MSG_END, &actual[strlen(actual) - strlen(MSG_END)]);
+
+    fclose(newFile.descriptor);
     free(actual);
-    free(buffer);
+    free(msg);
 }
 
 void test_log_tee(void)
@@ -110,13 +158,197 @@ void test_log_tee(void)
     remove("tmp");
 }
 
+void test_log_set_level(void)
+{
+    log_info(__FUNCTION__);
+
+    TEST_ASSERT_EQUAL_UINT32(LOG_CONFIG, log_get_level(LOG_MODULE_ALGEBRA));
+    TEST_ASSERT_EQUAL_UINT32(LOG_LEVEL_ERROR, log_set_level(LOG_MODULE_ALGEBRA, LOG_LEVEL_ERROR));
+    TEST_ASSERT_EQUAL_UINT32(LOG_LEVEL_ERROR, log_get_level(LOG_MODULE_ALGEBRA));
+    TEST_ASSERT_EQUAL_UINT32(LOG_CONFIG, log_get_level(LOG_MODULE_MEMORY));
+
+    /* LOG_CONFIG is the ceiling */
+    TEST_ASSERT_EQUAL_UINT32(LOG_CONFIG, log_set_level(LOG_MODULE_ALL, LOG_LEVEL_FULL + 10U));
+    for (uint32_t module = 0U; module < LOG_MODULE_ALL; module++)
+    {
+        TEST_ASSERT_EQUAL_UINT32(LOG_CONFIG, log_get_level(module));
+    }
+}
+
+void test_log_parse_levels(void)
+{
+    log_info(__FUNCTION__);
+
+    /* "bogus=INFO" and "memory=LOUD" are not understood */
+    TEST_ASSERT_EQUAL_UINT32(2U, log_parse_levels("warning,algebra=ERROR,bogus=INFO,memory=LOUD"));
+    TEST_ASSERT_EQUAL_UINT32(LOG_LEVEL_ERROR, log_get_level(LOG_MODULE_ALGEBRA));
+    /* Clipped by LOG_CONFIG when it is LOG_LEVEL_ERROR */
+    TEST_ASSERT_EQUAL_UINT32(LOG_LEVEL_WARNING < LOG_CONFIG ? LOG_LEVEL_WARNING : LOG_CONFIG,
+                             log_get_level(LOG_MODULE_MEMORY));
+    TEST_ASSERT_EQUAL_UINT32(log_get_level(LOG_MODULE_MEMORY), log_get_level(LOG_MODULE_LOG));
+
+    TEST_ASSERT_EQUAL_UINT32(0U, log_parse_levels(""));
+    TEST_ASSERT_EQUAL_UINT32(0U, log_parse_levels("TRACE"));
+    TEST_ASSERT_EQUAL_UINT32(LOG_CONFIG, log_get_level(LOG_MODULE_ALGEBRA));
+}
+
+void test_disabled_log(void)
+{
+    uint32_t counter = 0U;
+    log_info(__FUNCTION__);
+
+    log_set_level(LOG_MODULE_ALL, LOG_LEVEL_ERROR);
+    /* Arguments of a disabled log are not evaluated */
+    LOG_TRACE("counter %u", counter++);
+    LOG_WARNING("counter %u", counter++);
+    TEST_ASSERT_EQUAL_UINT32(0U, counter);
+
+    log_set_level(LOG_MODULE_ALL, LOG_CONFIG);
+    LOG_ERROR("counter %u", counter++);
+    TEST_ASSERT_EQUAL_UINT32(1U, counter);
+}
+
+void test_log_sample(void)
+{
+    LOG_SITE everyN = {0U}, firstN = {0U}, perSecond = {0U};
+    uint32_t logged[3U] = {0U, 0U, 0U};
+    uint64_t reported[3U] = {0U, 0U, 0U};
+    log_info(__FUNCTION__);
+
+    for (uint32_t i = 0U; i < 10U; i++)
+    {
+        uint64_t suppressed = 0U;
+        logged[0U] += log_sample(&everyN, LOG_SAMPLE_EVERY_N, 3U, &suppressed);
+        reported[0U] = (suppressed != 0U) ? suppressed : reported[0U];
+
+        suppressed = 0U;
+        logged[1U] += log_sample(&firstN, LOG_SAMPLE_FIRST_N, 2U, &suppressed);
+        reported[1U] = (suppressed != 0U) ? suppressed : reported[1U];
+
+        suppressed = 0U;
+        logged[2U] += log_sample(&perSecond, LOG_SAMPLE_PER_SECOND, 5U, &suppressed);
+        reported[2U] = (suppressed != 0U) ? suppressed : reported[2U];
+    }
+
+    /* Hits 0, 3, 6 and 9 are logged, the first drop is reported at once */
+    TEST_ASSERT_EQUAL_UINT32(4U, logged[0U]);
+    TEST_ASSERT_GREATER_THAN_UINT32(0U, reported[0U]);
+    TEST_ASSERT_EQUAL_UINT32(6U, everyN.suppressed);
+    /* Hits 0 and 1 are logged */
+    TEST_ASSERT_EQUAL_UINT32(2U, logged[1U]);
+    TEST_ASSERT_EQUAL_UINT32(8U, firstN.suppressed);
+
+    /* Within a period of the last report nothing is reported, after it the
+     * total is. The last report is moved instead of sleeping */
+    uint64_t suppressed = 0U;
+    firstN.reported = get_second() + LOG_SAMPLE_REPORT_S;
+    log_sample(&firstN, LOG_SAMPLE_FIRST_N, 2U, &suppressed);
+    TEST_ASSERT_EQUAL_UINT32(0U, suppressed);
+    firstN.reported -= 2U * LOG_SAMPLE_REPORT_S;
+    log_sample(&firstN, LOG_SAMPLE_FIRST_N, 2U, &suppressed);
+    TEST_ASSERT_EQUAL_UINT32(10U, suppressed);
+    /* At most 5 per second, a second might start during the loop */
+    TEST_ASSERT_TRUE((5U <= logged[2U]) && (logged[2U] <= 10U));
+    TEST_ASSERT_EQUAL_UINT32(10U, perSecond.hits);
+}
+
+void test_log_every_n(void)
+{
+    uint32_t counter = 0U;
+    log_info(__FUNCTION__);
+
+    for (uint32_t i = 0U; i < 8U; i++)
+    {
+        /* Arguments are only evaluated when the call site is sampled */
+        LOG_EVERY_N(ERROR, 4U, "counter %u", counter++);
+    }
+    TEST_ASSERT_EQUAL_UINT32(2U, counter);
+
+    for (uint32_t i = 0U; i < 8U; i++)
+    {
+        LOG_FIRST_N(ERROR, 3U, "counter %u", counter++);
+    }
+    TEST_ASSERT_EQUAL_UINT32(5U, counter);
+}
+
+void test_get_row(void)
+{
+    const float val[3U] = {1.0f, -0.1f, 3.4028235e38f};
+    char actual[MAX_STR_LEN];
+    log_info(__FUNCTION__);
+
+    size_t len = get_row(actual, sizeof(actual), "A", val, 3U);
+    TEST_ASSERT_EQUAL_UINT32(strlen(BOLD_GRAY("    A = [") ROW_START
+        "        1.0,        -0.1, 3.4028235e+38" ROW_END), len);
+    actual[len] = '\0';
+    TEST_ASSERT_EQUAL_STRING(BOLD_GRAY("    A = [") ROW_START
+        "        1.0,        -0.1, 3.4028235e+38" ROW_END, actual);
+
+    len = get_row(actual, sizeof(actual), "", val, 1U);
+    actual[len] = '\0';
+    TEST_ASSERT_EQUAL_STRING(BOLD_GRAY("        [") ROW_START "        1.0" ROW_END, actual);
+
+    /* The buffer has to fit the widest row */
+    TEST_ASSERT_EQUAL_UINT32(0U, get_row(actual, get_row_len("A", 3U) - 1U, "A", val, 3U));
+}
+
+void test_log_dump_matrix(void)
+{
+    const float val[6U] = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+    LOG newFile = {tmpfile(), "tmpfile", NULL};
+    LOG_DUMP header;
+    char name[2U] = {0};
+    float actual[6U];
+    log_info(__FUNCTION__);
+
+    /* stderr alone, nothing is dumped */
+    TEST_ASSERT_EQUAL_UINT32(0U, log_dump_matrix("B", val, 2U, 3U));
+
+    TEST_ASSERT_NOT_NULL(newFile.descriptor);
+    newFile.sink = make_sink(newFile.descriptor);
+    set(&newFile);
+    TEST_ASSERT_EQUAL_UINT32(1U, log_dump_matrix("B", val, 2U, 3U));
+    log_flush();
+    set((LOG*)NULL);
+
+    /* Header, name and payload, back to back */
+    pread(fileno(newFile.descriptor), &header, sizeof(header), 0);
+    pread(fileno(newFile.descriptor), name, 1U, sizeof(header));
+    pread(fileno(newFile.descriptor), actual, sizeof(actual), sizeof(header) + 1U);
+    TEST_ASSERT_EQUAL_MEMORY(LOG_DUMP_MAGIC, header.magic, 4U);
+    TEST_ASSERT_EQUAL_UINT32(LOG_DUMP_VERSION, header.version);
+    TEST_ASSERT_EQUAL_UINT32(2U, header.rows);
+    TEST_ASSERT_EQUAL_UINT32(3U, header.cols);
+    TEST_ASSERT_EQUAL_UINT32(1U, header.nameLen);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(float), header.elemSize);
+    TEST_ASSERT_EQUAL_STRING("B", name);
+    TEST_ASSERT_EQUAL_MEMORY(val, actual, sizeof(actual));
+
+    /* Without a log file, the binary mode falls back to text */
+    TEST_ASSERT_EQUAL_UINT32(LOG_MATRIX_TEXT, log_set_matrix_mode(LOG_MATRIX_BINARY));
+    log_matrix(LOG_LEVEL_ERROR, __FILE__, __LINE__, "B", val, 2U, 3U);
+    TEST_ASSERT_EQUAL_UINT32(LOG_MATRIX_BINARY, log_set_matrix_mode(LOG_MATRIX_TEXT));
+
+    free_sink(newFile.sink);
+    fclose(newFile.descriptor);
+}
+
 int main(void)
 {
     UNITY_BEGIN();
 
     RUN_TEST(test_get_src);
     RUN_TEST(test_get_msg);
+    RUN_TEST(test_get_buffer);
+    RUN_TEST(test_log_print_long);
     RUN_TEST(test_log_tee);
+    RUN_TEST(test_log_set_level);
+    RUN_TEST(test_log_parse_levels);
+    RUN_TEST(test_disabled_log);
+    RUN_TEST(test_log_sample);
+    RUN_TEST(test_log_every_n);
+    RUN_TEST(test_get_row);
+    RUN_TEST(test_log_dump_matrix);
 
     return UNITY_END();
 }
@@ -0,0 +1,317 @@
+/*******************************************************************************
+*
+* Benchmarks of the algebra library
+*
+*   SUMMARY
+*       Every benchmark runs over square matrices from BENCH_MIN_SIZE to
+*       BENCH_MAX_SIZE, and reports bytes/s and FLOP/s where there are
+*       floating-point operations. The cubic ones stop earlier, the in-core
+*       operator*() is naive and echelon() is recursive.
+*
+*       Logs are turned down to errors, otherwise the benchmarks measure
+*       std::cout. Results are compared between releases from the JSON,
+*       "bench --benchmark_out=bench.json --benchmark_out_format=json".
+*
+*******************************************************************************/
+
+/******************************************************************************/
+/*    INCLUDED FILES                                                          */
+/******************************************************************************/
+
+#include <benchmark/benchmark.h>
+#include <sstream>
+/* TARGET LIBRARY */
+#include "matrix.hpp"
+
+/******************************************************************************/
+/*    DEFINITIONS                                                             */
+/******************************************************************************/
+
+#define BENCH_MIN_SIZE      (4)
+#define BENCH_MAX_SIZE      (4096)
+#define BENCH_MAX_CUBIC     (1024)
+#define BENCH_MAX_ECHELON   (256)
+
+/******************************************************************************/
+/*    PRIVATE FUNCTIONS                                                       */
+/******************************************************************************/
+
+// A diagonally dominant matrix, its pivots are never zero
+static void fill(Matrix &A)
+{
+    for (uint32_t i = 0U; i < A.val.size(); i++)
+    {
+        A.val[i] = static_cast<float>(i % 7U) + 1.0F;
+    }
+    for (uint32_t i = 0U; (i < A.rows) && (i < A.cols); i++)
+    {
+        A.val[A.cols * i + i] += 8.0F * A.cols;
+    }
+}
+
+// Matrices that the operators leave in Matrix::manager, intermediate ones too
+static void release(const size_t count)
+{
+    while (Matrix::manager.size() > count)
+    {
+        delete Matrix::manager.back();
+    }
+}
+
+static void setCounters(benchmark::State &state, const double bytes, const double flops)
+{
+    state.SetBytesProcessed(static_cast<int64_t>(bytes * state.iterations()));
+    if (flops > 0.0)
+    {
+        state.counters["FLOP/s"] = benchmark::Counter(flops * state.iterations(),
+                                                      benchmark::Counter::kIsRate);
+    }
+}
+
+/******************************************************************************/
+/*    BENCHMARKS                                                              */
+/******************************************************************************/
+
+static void construction(benchmark::State &state)
+{
+    const uint32_t n = static_cast<uint32_t>(state.range(0));
+
+    for (auto _ : state)
+    {
+        Matrix A(n, n);
+        benchmark::DoNotOptimize(A.val.data());
+    }
+    setCounters(state, sizeof(float) * n * n, 0.0);
+}
+
+static void copy(benchmark::State &state)
+{
+    const uint32_t n = static_cast<uint32_t>(state.range(0));
+    Matrix A(n, n);
+    fill(A);
+
+    for (auto _ : state)
+    {
+        Matrix B(A);
+        benchmark::DoNotOptimize(B.val.data());
+    }
+    setCounters(state, 2.0 * sizeof(float) * n * n, 0.0);
+}
+
+// Growing a row vector into a square matrix, and back
+static void reshape(benchmark::State &state)
+{
+    const uint32_t n = static_cast<uint32_t>(state.range(0));
+    Matrix A(1U, n);
+    fill(A);
+
+    for (auto _ : state)
+    {
+        A.reshape(n, n);
+        A.reshape(1U, n);
+        benchmark::DoNotOptimize(A.val.data());
+    }
+    setCounters(state, sizeof(float) * n * n, 0.0);
+}
+
+static void transpose(benchmark::State &state)
+{
+    const uint32_t n = static_cast<uint32_t>(state.range(0));
+    Matrix A(n, n);
+    fill(A);
+
+    for (auto _ : state)
+    {
+        A.transpose();
+        benchmark::DoNotOptimize(A.val.data());
+    }
+    setCounters(state, 2.0 * sizeof(float) * n * n, 0.0);
+}
+
+static void add(benchmark::State &state)
+{
+    const uint32_t n = static_cast<uint32_t>(state.range(0));
+    Matrix A(n, n), B(n, n);
+    fill(A);
+    fill(B);
+
+    for (auto _ : state)
+    {
+        Matrix *C = A + B;
+        benchmark::DoNotOptimize(C->val.data());
+        delete C;
+    }
+    setCounters(state, 3.0 * sizeof(float) * n * n, 1.0 * n * n);
+}
+
+static void sub(benchmark::State &state)
+{
+    const uint32_t n = static_cast<uint32_t>(state.range(0));
+    Matrix A(n, n), B(n, n);
+    fill(A);
+    fill(B);
+
+    for (auto _ : state)
+    {
+        Matrix *C = A - B;
+        benchmark::DoNotOptimize(C->val.data());
+        delete C;
+    }
+    setCounters(state, 3.0 * sizeof(float) * n * n, 1.0 * n * n);
+}
+
+// Bytes are the operands and the result, not the traffic of the kernel
+static void multiply(benchmark::State &state)
+{
+    const uint32_t n = static_cast<uint32_t>(state.range(0));
+    Matrix A(n, n), B(n, n);
+    fill(A);
+    fill(B);
+
+    for (auto _ : state)
+    {
+        Matrix *C = A * B;
+        benchmark::DoNotOptimize(C->val.data());
+        delete C;
+    }
+    setCounters(state, 3.0 * sizeof(float) * n * n, 2.0 * n * n * n);
+}
+
+// Gram matrix A^T A into an existing G, neither A^T nor G are allocated
+static void gram(benchmark::State &state)
+{
+    const uint32_t n = static_cast<uint32_t>(state.range(0));
+    Matrix A(n, n), G(n, n);
+    fill(A);
+
+    for (auto _ : state)
+    {
+        gemm(BLAS_TRANS, BLAS_NO_TRANS, 1.0F, A, A, 0.0F, G);
+        benchmark::DoNotOptimize(G.val.data());
+    }
+    setCounters(state, 2.0 * sizeof(float) * n * n, 2.0 * n * n * n);
+}
+
+static void scale(benchmark::State &state)
+{
+    const uint32_t n = static_cast<uint32_t>(state.range(0));
+    Matrix A(n, n);
+    fill(A);
+
+    for (auto _ : state)
+    {
+        Matrix *C = 0.5F * A;
+        benchmark::DoNotOptimize(C->val.data());
+        delete C;
+    }
+    setCounters(state, 2.0 * sizeof(float) * n * n, 1.0 * n * n);
+}
+
+// Zero in a(0,0), the pivot is in the last row
+static void rowPermute(benchmark::State &state)
+{
+    const uint32_t n = static_cast<uint32_t>(state.range(0));
+    Matrix A(n, n);
+    fill(A);
+    A.val[0U] = 0.0F;
+    const size_t count = Matrix::manager.size();
+
+    for (auto _ : state)
+    {
+        Matrix *PA = A.rowPermute();
+        benchmark::DoNotOptimize(PA->val.data());
+        release(count);
+    }
+    // P * A through operator*()
+    setCounters(state, 3.0 * sizeof(float) * n * n, 2.0 * n * n * n);
+}
+
+static void rowReduction(benchmark::State &state)
+{
+    const uint32_t n = static_cast<uint32_t>(state.range(0));
+    Matrix A(n, n);
+    fill(A);
+    const size_t count = Matrix::manager.size();
+
+    for (auto _ : state)
+    {
+        Matrix *LiA = A.rowReduction();
+        benchmark::DoNotOptimize(LiA->val.data());
+        release(count);
+    }
+    // L^{-1} * A through operator*()
+    setCounters(state, 3.0 * sizeof(float) * n * n, 2.0 * n * n * n);
+}
+
+static void echelon(benchmark::State &state)
+{
+    const uint32_t n = static_cast<uint32_t>(state.range(0));
+    Matrix A(n, n);
+    fill(A);
+    const size_t count = Matrix::manager.size();
+
+    for (auto _ : state)
+    {
+        Matrix *U = A.echelon();
+        benchmark::DoNotOptimize(U->val.data());
+        release(count);
+    }
+    // A product of k x k matrices for every k from n down to 2
+    double flops = 0.0;
+    for (double k = 2.0; k <= n; k++)
+    {
+        flops += 2.0 * k * k * k;
+    }
+    setCounters(state, sizeof(float) * n * n, flops);
+}
+
+// Summarized as soon as n > Matrix::logLimit
+static void log(benchmark::State &state)
+{
+    const uint32_t n = static_cast<uint32_t>(state.range(0));
+    Matrix A(n, n);
+    fill(A);
+    size_t bytes = 0U;
+
+    for (auto _ : state)
+    {
+        std::ostringstream os;
+        A.log(os);
+        bytes = os.str().size();
+        benchmark::DoNotOptimize(bytes);
+    }
+    setCounters(state, static_cast<double>(bytes), 0.0);
+}
+
+BENCHMARK(construction)->RangeMultiplier(4)->Range(BENCH_MIN_SIZE, BENCH_MAX_SIZE);
+BENCHMARK(copy)->RangeMultiplier(4)->Range(BENCH_MIN_SIZE, BENCH_MAX_SIZE);
+BENCHMARK(reshape)->RangeMultiplier(4)->Range(BENCH_MIN_SIZE, BENCH_MAX_SIZE);
+BENCHMARK(transpose)->RangeMultiplier(4)->Range(BENCH_MIN_SIZE, BENCH_MAX_SIZE);
+BENCHMARK(add)->RangeMultiplier(4)->Range(BENCH_MIN_SIZE, BENCH_MAX_SIZE);
+BENCHMARK(sub)->RangeMultiplier(4)->Range(BENCH_MIN_SIZE, BENCH_MAX_SIZE);
+BENCHMARK(scale)->RangeMultiplier(4)->Range(BENCH_MIN_SIZE, BENCH_MAX_SIZE);
+BENCHMARK(multiply)->RangeMultiplier(4)->Range(BENCH_MIN_SIZE, BENCH_MAX_CUBIC)->Unit(benchmark::kMillisecond);
+BENCHMARK(gram)->RangeMultiplier(4)->Range(BENCH_MIN_SIZE, BENCH_MAX_CUBIC)->Unit(benchmark::kMillisecond);
+BENCHMARK(rowPermute)->RangeMultiplier(4)->Range(BENCH_MIN_SIZE, BENCH_MAX_CUBIC)->Unit(benchmark::kMillisecond);
+BENCHMARK(rowReduction)->RangeMultiplier(4)->Range(BENCH_MIN_SIZE, BENCH_MAX_CUBIC)->Unit(benchmark::kMillisecond);
+BENCHMARK(echelon)->RangeMultiplier(4)->Range(BENCH_MIN_SIZE, BENCH_MAX_ECHELON)->Unit(benchmark::kMillisecond);
+BENCHMARK(log)->RangeMultiplier(4)->Range(BENCH_MIN_SIZE, BENCH_MAX_SIZE);
+
+/******************************************************************************/
+/*    MAIN                                                                    */
+/******************************************************************************/
+
+int main(int argc, char **argv)
+{
+    Log::setLevel(Log::Module::ALL, Log::Level::ERROR);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
@@ -0,0 +1,263 @@
+/******************************************************************************/
+/*    INCLUDED FILES                                                          */
+/******************************************************************************/
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "counters.hpp"
+
+/******************************************************************************/
+/*    PRIVATE DATA                                                            */
+/******************************************************************************/
+
+static const char *eventName[Counters::Event::ALL] =
+    {"Cycles", "Instr", "L1D miss", "LLC miss", "dTLB miss", "Faults"};
+
+// (type, config) of each event
+static const uint64_t eventConfig[Counters::Event::ALL][2U] =
+{
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                         (PERF_COUNT_HW_CACHE_OP_READ << 8U) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16U)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB |
+                         (PERF_COUNT_HW_CACHE_OP_READ << 8U) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16U)},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+};
+
+// Events of a thread, the first open one leads the group and they are
+// read at once, slot is the position of an event in the read.
+struct Group
+{
+    int      fd[Counters::Event::ALL];
+    int      slot[Counters::Event::ALL];
+    int      leader = -1;
+    uint32_t open = 0U;
+    // Kernels of the scopes that are running, to skip nested ones
+    std::vector<const char*> active;
+
+    Group();
+    ~Group();
+
+    void read(uint64_t values[Counters::Event::ALL]) const;
+};
+
+static thread_local Group group;
+
+static std::mutex samplesMutex;
+static Counters::Snapshot samples;
+
+static std::once_flag atExit;
+
+/******************************************************************************/
+/*    PRIVATE FUNCTIONS                                                       */
+/******************************************************************************/
+
+static int openEvent(const uint32_t event, const int leader)
+{
+    struct perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = static_cast<uint32_t>(eventConfig[event][0U]);
+    attr.config = eventConfig[event][1U];
+    attr.read_format = PERF_FORMAT_GROUP;
+    // User space only, it works with perf_event_paranoid = 2
+    attr.exclude_kernel = 1U;
+    attr.exclude_hv = 1U;
+    attr.disabled = (leader == -1) ? 1U : 0U;
+
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0UL));
+}
+
+Group::Group()
+{
+    for (uint32_t event = 0U; event < Counters::Event::ALL; event++)
+    {
+        this->fd[event] = openEvent(event, this->leader);
+        this->slot[event] = -1;
+        if (this->fd[event] != -1)
+        {
+            this->leader = (this->leader == -1) ? this->fd[event] : this->leader;
+            this->slot[event] = static_cast<int>(this->open++);
+        }
+    }
+
+    if (this->leader != -1)
+    {
+        ioctl(this->leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(this->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+Group::~Group()
+{
+    for (uint32_t event = 0U; event < Counters::Event::ALL; event++)
+    {
+        if (this->fd[event] != -1)
+        {
+            close(this->fd[event]);
+        }
+    }
+}
+
+// Counters only grow, events that are not open read as 0
+void Group::read(uint64_t values[Counters::Event::ALL]) const
+{
+    uint64_t buffer[1U + Counters::Event::ALL] = {};
+
+    if ((this->leader == -1) ||
+        (::read(this->leader, buffer, sizeof(uint64_t) * (1U + this->open)) <= 0))
+    {
+        std::fill(values, values + Counters::Event::ALL, 0U);
+        return;
+    }
+
+    // buffer[0] is the number of events
+    for (uint32_t event = 0U; event < Counters::Event::ALL; event++)
+    {
+        values[event] = (this->slot[event] == -1) ? 0U : buffer[1U + this->slot[event]];
+    }
+}
+
+/******************************************************************************/
+/*    IMPLEMENTATION                                                          */
+/******************************************************************************/
+
+Counters::Scope::Scope(const char *kernel, const uint64_t size) :
+    kernel(kernel), bucket(Counters::getBucket(size)), nested(false)
+{
+    for (const char *running : group.active)
+    {
+        this->nested = this->nested || (std::strcmp(running, kernel) == 0);
+    }
+    if (this->nested)
+    {
+        return;
+    }
+
+    std::call_once(atExit, []() { std::atexit([]() { Counters::report(std::cerr); }); });
+
+    group.active.push_back(kernel);
+    this->begin = std::chrono::steady_clock::now();
+    group.read(this->start);
+}
+
+Counters::Scope::~Scope()
+{
+    if (this->nested)
+    {
+        return;
+    }
+
+    uint64_t end[Event::ALL];
+    group.read(end);
+    const auto elapsed = std::chrono::steady_clock::now() - this->begin;
+    group.active.pop_back();
+
+    std::lock_guard<std::mutex> lock(samplesMutex);
+    Sample &sample = samples[{this->kernel, this->bucket}];
+    const bool first = (sample.calls == 0U);
+
+    sample.calls++;
+    sample.ns += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    for (uint32_t event = 0U; event < Event::ALL; event++)
+    {
+        const bool counted = (group.slot[event] != -1);
+        sample.counted[event] = (first || sample.counted[event]) && counted;
+        sample.events[event] += end[event] - this->start[event];
+    }
+}
+
+Counters::Snapshot Counters::snapshot()
+{
+    std::lock_guard<std::mutex> lock(samplesMutex);
+
+    return samples;
+}
+
+void Counters::reset()
+{
+    std::lock_guard<std::mutex> lock(samplesMutex);
+
+    samples.clear();
+}
+
+void Counters::report(std::ostream &os)
+{
+    const Snapshot snap = Counters::snapshot();
+    if (snap.empty())
+    {
+        return;
+    }
+
+    const std::ios_base::fmtflags flags = os.flags();
+    os << std::left << std::setw(16) << "Kernel" << std::right << std::setw(12) << "Size"
+       << std::setw(10) << "Calls" << std::setw(12) << "Time (ms)";
+    for (uint32_t event = 0U; event < Event::ALL; event++)
+    {
+        os << std::setw(14) << eventName[event];
+    }
+    os << std::setw(8) << "IPC" << "\n";
+
+    for (const auto &[key, sample] : snap)
+    {
+        const std::string bucket = (key.second == 0U) ? "0" : "<2^" + std::to_string(key.second);
+        os << std::left << std::setw(16) << key.first << std::right << std::setw(12) << bucket
+           << std::setw(10) << sample.calls << std::setw(12) << std::fixed << std::setprecision(3)
+           << static_cast<double>(sample.ns) / 1e6;
+        for (uint32_t event = 0U; event < Event::ALL; event++)
+        {
+            os << std::setw(14);
+            if (sample.counted[event])
+            {
+                os << sample.events[event];
+            }
+            else
+            {
+                os << "-";
+            }
+        }
+
+        os << std::setw(8);
+        if (sample.counted[Event::CYCLES] && sample.counted[Event::INSTRUCTIONS] &&
+            (sample.events[Event::CYCLES] != 0U))
+        {
+            os << std::setprecision(2)
+               << static_cast<double>(sample.events[Event::INSTRUCTIONS]) / sample.events[Event::CYCLES];
+        }
+        else
+        {
+            os << "-";
+        }
+        os << "\n";
+    }
+    os.flags(flags);
+}
+
+uint32_t Counters::getBucket(const uint64_t size)
+{
+    uint32_t bits = 0U;
+    for (uint64_t s = size; s != 0U; s >>= 1U)
+    {
+        bits++;
+    }
+
+    return bits;
+}
+
+uint32_t Counters::available()
+{
+    return group.open;
+}
@@ -0,0 +1,113 @@
+/*******************************************************************************
+*
+* Hardware counters
+*
+*   SUMMARY
+*       An opt-in layer that counts hardware events around named kernel
+*       scopes with perf_event_open(2):
+*
+*       a) PERF_SCOPE(kernel, size) measures the rest of the block, the
+*          macro is empty unless the build sets PERF_COUNTERS (cmake
+*          -DPERF_COUNTERS=ON),
+*       b) each thread opens its own group of events on its first scope,
+*          events that the machine does not have are not counted,
+*       c) scopes are aggregated per kernel and size bucket, the bucket is
+*          the bit width of the size, [2^(b-1), 2^b),
+*       d) Counters::snapshot() returns the aggregates, and they are
+*          reported to std::cerr at exit.
+*
+*       A scope nested in another one of the same kernel is not counted,
+*       so recursive kernels are measured once.
+*
+*******************************************************************************/
+
+#ifndef COUNTERS_H_
+#define COUNTERS_H_
+
+/******************************************************************************/
+/*    INCLUDED FILES                                                          */
+/******************************************************************************/
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+
+/******************************************************************************/
+/*    PUBLIC MACROS                                                           */
+/******************************************************************************/
+
+#ifndef PERF_COUNTERS
+    #define PERF_COUNTERS 0
+#endif
+
+/**
+ * @example    PERF_SCOPE("operator*", A.rows * A.cols * B.cols);
+ */
+#if PERF_COUNTERS
+    #define PERF_SCOPE(kernel, size) \
+        Counters::Scope perfScope(kernel, size)
+#else
+    #define PERF_SCOPE(kernel, size) do {} while (0)
+#endif
+
+/******************************************************************************/
+/*    API                                                                     */
+/******************************************************************************/
+
+struct Counters
+{
+    // PAGE_FAULTS is a software event, it is there without a PMU.
+    enum Event: uint32_t
+    {
+        CYCLES = 0U,
+        INSTRUCTIONS,
+        L1D_MISSES,
+        LLC_MISSES,
+        DTLB_MISSES,
+        PAGE_FAULTS,
+        ALL
+    };
+
+    // counted tells which events were open in every scope of the sample.
+    struct Sample
+    {
+        uint64_t calls = 0U;
+        uint64_t ns = 0U;
+        uint64_t events[Event::ALL] = {};
+        bool     counted[Event::ALL] = {};
+    };
+
+    // (kernel, bucket)
+    using Key = std::pair<std::string, uint32_t>;
+    using Snapshot = std::map<Key, Sample>;
+
+    struct Scope
+    {
+        Scope(const char *kernel, const uint64_t size);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char *kernel;
+        uint32_t   bucket;
+        bool       nested;
+        uint64_t   start[Event::ALL];
+        std::chrono::steady_clock::time_point begin;
+    };
+
+    static Snapshot snapshot();
+    static void reset();
+    static void report(std::ostream &os);
+
+    // Bit width of size, 0 for 0
+    static uint32_t getBucket(const uint64_t size);
+    // Events that could be opened on the calling thread
+    static uint32_t available();
+};
+
+#endif /* COUNTERS_H_ */
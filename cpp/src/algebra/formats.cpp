@@ -0,0 +1,611 @@
+/******************************************************************************/
+/*    INCLUDED FILES                                                          */
+/******************************************************************************/
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <string_view>
+#include <strings.h>
+#include <thread>
+#include <vector>
+
+#include "formats.hpp"
+#include "levels.hpp"
+
+/******************************************************************************/
+/*    PRIVATE DATA                                                            */
+/******************************************************************************/
+
+// .npy files start with "\x93NUMPY", major and minor versions, and the length
+// of the header. The header is padded so that the values are aligned.
+static const char npyMagic[6U] = {'\x93', 'N', 'U', 'M', 'P', 'Y'};
+static const uint32_t npyPrelude = 10U;
+static const uint32_t npyAlign = 64U;
+
+// Values are read and written in the native byte order
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+static const char npyOrder = '<';
+#else
+static const char npyOrder = '>';
+#endif
+
+struct NpyHeader
+{
+    uint32_t rows = 1U;
+    uint32_t cols = 1U;
+    uint32_t wordSize = 0U;
+    bool     fortran = false;
+};
+
+// "%%MatrixMarket matrix <array|coordinate> <field> <symmetry>"
+struct MtxBanner
+{
+    bool    coordinate = false;
+    bool    pattern = false;
+    // 0 general, 1 symmetric, -1 skew-symmetric, the mirrored sign
+    int32_t symmetry = 0;
+};
+
+/******************************************************************************/
+/*    PRIVATE FUNCTIONS                                                       */
+/******************************************************************************/
+
+// std::from_chars() does not skip blanks
+static bool isBlank(const char c)
+{
+    return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n');
+}
+
+static bool equals(const std::string_view token, const char *name)
+{
+    return (token.size() == std::strlen(name)) && (strncasecmp(token.data(), name, token.size()) == 0);
+}
+
+// Parsing the next number in [first, last), first is moved past it
+template<typename T>
+static bool next(const char *&first, const char *last, T &value)
+{
+    while ((first < last) && isBlank(*first))
+    {
+        first++;
+    }
+    // std::from_chars() does not take a '+' either
+    if ((first < last) && (*first == '+'))
+    {
+        first++;
+    }
+
+    auto [end, error] = std::from_chars(first, last, value);
+    if ((error != std::errc()) || ((end < last) && (isBlank(*end) == false)))
+    {
+        return false;
+    }
+
+    first = end;
+    return true;
+}
+
+// Moving first to the next line, it returns the current one
+static std::string_view nextLine(const char *&first, const char *last)
+{
+    const char *end = std::find(first, last, '\n');
+    std::string_view line(first, end - first);
+
+    first = (end < last) ? end + 1 : last;
+    return line;
+}
+
+// Splitting [first, last) in count chunks that end on a newline
+static std::vector<const char*> split(const char *first, const char *last, const uint32_t count)
+{
+    std::vector<const char*> bounds = {first};
+    const size_t step = (last - first) / count;
+
+    for (uint32_t i = 1U; i < count; i++)
+    {
+        const char *bound = std::find(std::max(bounds.back(), first + step * i), last, '\n');
+        bounds.push_back((bound < last) ? bound + 1 : last);
+    }
+    bounds.push_back(last);
+
+    return bounds;
+}
+
+// Running work(i) for every chunk i, one thread each and the caller's too
+template<typename F>
+static void parallel(const uint32_t count, F work)
+{
+    std::vector<std::thread> pool;
+
+    for (uint32_t i = 1U; i < count; i++)
+    {
+        pool.emplace_back(work, i);
+    }
+    work(0U);
+
+    for (auto &thread : pool)
+    {
+        thread.join();
+    }
+}
+
+static size_t countTokens(const char *first, const char *last)
+{
+    size_t count = 0U;
+    bool inToken = false;
+
+    for (; first < last; first++)
+    {
+        const bool blank = isBlank(*first);
+        count += ((blank == false) && (inToken == false)) ? 1U : 0U;
+        inToken = (blank == false);
+    }
+
+    return count;
+}
+
+static bool parseNpyHeader(const std::string &header, NpyHeader &parsed)
+{
+    // Position right after key, npos when missing
+    auto value = [&header](const char *key)
+    {
+        size_t pos = header.find(key);
+        return (pos == std::string::npos) ? pos : pos + std::strlen(key);
+    };
+
+    // 'descr': '<f4', only floats in the native order
+    size_t pos = value("'descr':");
+    size_t start = (pos == std::string::npos) ? pos : header.find('\'', pos);
+    if ((start == std::string::npos) || (header.compare(start + 1U, 2U, std::string(1U, npyOrder) + "f") != 0))
+    {
+        return false;
+    }
+    parsed.wordSize = (header.compare(start + 3U, 2U, "4'") == 0) ? sizeof(float) :
+                      (header.compare(start + 3U, 2U, "8'") == 0) ? sizeof(double) : 0U;
+
+    // 'fortran_order': False
+    pos = value("'fortran_order':");
+    pos = (pos == std::string::npos) ? pos : header.find_first_not_of(' ', pos);
+    parsed.fortran = (pos != std::string::npos) && (header.compare(pos, 4U, "True") == 0);
+
+    // 'shape': (), (n,) or (rows, cols)
+    pos = value("'shape':");
+    start = (pos == std::string::npos) ? pos : header.find('(', pos);
+    size_t end = (start == std::string::npos) ? start : header.find(')', start);
+    if (end == std::string::npos)
+    {
+        return false;
+    }
+
+    std::vector<uint32_t> shape;
+    for (const char *first = &header[start + 1U], *last = &header[end]; first < last;)
+    {
+        uint32_t dim = 0U;
+        while ((first < last) && ((*first == ',') || isBlank(*first)))
+        {
+            first++;
+        }
+        if (first == last)
+        {
+            break;
+        }
+        if (next(first, std::find(first, last, ','), dim) == false)
+        {
+            return false;
+        }
+        shape.push_back(dim);
+        first = std::find(first, last, ',');
+    }
+
+    // A 1-D array is a row vector, as Matrix({...})
+    if (shape.size() > 2U)
+    {
+        return false;
+    }
+    parsed.rows = (shape.size() == 2U) ? shape[0U] : 1U;
+    parsed.cols = (shape.empty() == false) ? shape.back() : 1U;
+
+    return parsed.wordSize != 0U;
+}
+
+// Prelude and header of a C-order float .npy, padded with blanks so that the
+// values start at a npyAlign boundary
+static std::string makeNpyHeader(const uint32_t rows, const uint32_t cols)
+{
+    std::string header = std::string("{'descr': '") + npyOrder + "f4', 'fortran_order': False, 'shape': (" +
+                         std::to_string(rows) + ", " + std::to_string(cols) + "), }";
+    const size_t length = ((npyPrelude + header.size() + 1U + npyAlign - 1U) / npyAlign) * npyAlign - npyPrelude;
+    header.append(length - header.size() - 1U, ' ');
+    header.push_back('\n');
+
+    // Version 1.0, with a little-endian 16-bit length
+    const char prelude[4U] = {1, 0, static_cast<char>(length & 0xFFU), static_cast<char>(length >> 8U)};
+    return std::string(npyMagic, sizeof(npyMagic)) + std::string(prelude, sizeof(prelude)) + header;
+}
+
+// Reading up to the values, file is left at their offset
+static bool readNpyHeader(std::istream &file, NpyHeader &parsed)
+{
+    char prelude[npyPrelude] = {0};
+
+    file.read(prelude, sizeof(prelude));
+    if (!file || (std::memcmp(prelude, npyMagic, sizeof(npyMagic)) != 0) || (prelude[6U] < 1) || (prelude[6U] > 3))
+    {
+        return false;
+    }
+
+    // Version 1.0 has a 16-bit length, versions 2.0 and 3.0 a 32-bit one
+    uint32_t length = static_cast<uint8_t>(prelude[8U]) | (static_cast<uint8_t>(prelude[9U]) << 8U);
+    if (prelude[6U] != 1)
+    {
+        uint8_t high[2U] = {0U};
+        file.read(reinterpret_cast<char*>(high), sizeof(high));
+        length |= (high[0U] << 16U) | (high[1U] << 24U);
+    }
+
+    std::string header(length, '\0');
+    file.read(header.data(), length);
+
+    return file && parseNpyHeader(header, parsed);
+}
+
+static bool parseMtxBanner(const std::string_view line, MtxBanner &banner)
+{
+    std::vector<std::string_view> tokens;
+    for (const char *first = line.data(), *last = line.data() + line.size(); first < last;)
+    {
+        while ((first < last) && isBlank(*first))
+        {
+            first++;
+        }
+        const char *end = std::find_if(first, last, isBlank);
+        if (first < end)
+        {
+            tokens.emplace_back(first, end - first);
+        }
+        first = end;
+    }
+
+    if ((tokens.size() != 5U) || (equals(tokens[0U], "%%MatrixMarket") == false) ||
+        (equals(tokens[1U], "matrix") == false))
+    {
+        return false;
+    }
+
+    banner.coordinate = equals(tokens[2U], "coordinate");
+    banner.pattern = equals(tokens[3U], "pattern");
+    banner.symmetry = equals(tokens[4U], "symmetric") ? 1 : equals(tokens[4U], "skew-symmetric") ? -1 : 0;
+
+    // Packed triangles of dense files are not supported
+    return (banner.coordinate || equals(tokens[2U], "array")) &&
+           (equals(tokens[3U], "real") || equals(tokens[3U], "double") || equals(tokens[3U], "integer") ||
+            (banner.pattern && banner.coordinate)) &&
+           (equals(tokens[4U], "general") || (banner.coordinate && (banner.symmetry != 0)));
+}
+
+// "i j [value]" lines, 1-based, into A
+static bool parseEntries(const char *first, const char *last, const MtxBanner &banner,
+                         Matrix &A, uint64_t &entries)
+{
+    for (;;)
+    {
+        uint32_t i = 0U, j = 0U;
+        double value = 1.0;
+
+        while ((first < last) && isBlank(*first))
+        {
+            first++;
+        }
+        if (first == last)
+        {
+            return true;
+        }
+
+        if ((next(first, last, i) == false) || (next(first, last, j) == false) ||
+            ((banner.pattern == false) && (next(first, last, value) == false)) ||
+            (i == 0U) || (A.rows < i) || (j == 0U) || (A.cols < j))
+        {
+            return false;
+        }
+
+        A.val[A.cols * (i - 1U) + (j - 1U)] = static_cast<float>(value);
+        // Only one triangle is stored, the mirrored entry is never in the file
+        if ((banner.symmetry != 0) && (i != j))
+        {
+            A.val[A.cols * (j - 1U) + (i - 1U)] = static_cast<float>(banner.symmetry * value);
+        }
+        entries++;
+    }
+}
+
+// Dense values in column-major order, k is the index of the first one
+static bool parseValues(const char *first, const char *last, size_t k, Matrix &A)
+{
+    for (;; k++)
+    {
+        double value = 0.0;
+
+        while ((first < last) && isBlank(*first))
+        {
+            first++;
+        }
+        if (first == last)
+        {
+            return true;
+        }
+
+        if (next(first, last, value) == false)
+        {
+            return false;
+        }
+        A.val[A.cols * (k % A.rows) + (k / A.rows)] = static_cast<float>(value);
+    }
+}
+
+/******************************************************************************/
+/*    IMPLEMENTATION                                                          */
+/******************************************************************************/
+
+bool saveNpy(const Matrix &A, const std::string &filename)
+{
+    Log local;
+    std::ofstream file(filename, std::ios::binary);
+    const std::string header = makeNpyHeader(A.rows, A.cols);
+
+    file.write(header.data(), header.size());
+    file.write(reinterpret_cast<const char*>(A.val.data()), sizeof(float) * A.rows * A.cols);
+
+    if (!file)
+    {
+        LOG_ERROR(local, "Unable to write ", filename, ".");
+        return false;
+    }
+
+    LOG_INFO(local, "Saved [", A.rows, "x", A.cols, "] in ", filename, ".");
+    return true;
+}
+
+bool createNpy(const std::string &filename, const uint32_t rows, const uint32_t cols)
+{
+    Log local;
+    std::ofstream file(filename, std::ios::binary);
+    const std::string header = makeNpyHeader(rows, cols);
+    const uint64_t size = header.size() + sizeof(float) * static_cast<uint64_t>(rows) * cols;
+
+    // Writing the last byte sizes the file, the values read as zeros
+    file.write(header.data(), header.size());
+    if (header.size() < size)
+    {
+        file.seekp(size - 1U);
+        file.put('\0');
+    }
+
+    if (!file)
+    {
+        LOG_ERROR(local, "Unable to create ", filename, ".");
+        return false;
+    }
+
+    return true;
+}
+
+uint64_t openNpy(const std::string &filename, uint32_t &rows, uint32_t &cols)
+{
+    NpyHeader parsed;
+    std::ifstream file(filename, std::ios::binary);
+
+    if ((readNpyHeader(file, parsed) == false) || (parsed.wordSize != sizeof(float)) || parsed.fortran)
+    {
+        return 0U;
+    }
+
+    rows = parsed.rows;
+    cols = parsed.cols;
+    return static_cast<uint64_t>(file.tellg());
+}
+
+Matrix* loadNpy(const std::string &filename)
+{
+    Log local;
+    NpyHeader parsed;
+    std::ifstream file(filename, std::ios::binary);
+
+    if (readNpyHeader(file, parsed) == false)
+    {
+        LOG_ERROR(local, filename, " is not a supported .npy file.");
+        return nullptr;
+    }
+
+    // Fortran order is the transpose in c-contiguous layout
+    Matrix *A = parsed.fortran ? new Matrix(parsed.cols, parsed.rows) : new Matrix(parsed.rows, parsed.cols);
+    if (parsed.wordSize == sizeof(float))
+    {
+        // Straight into the values, no intermediate buffer
+        file.read(reinterpret_cast<char*>(A->val.data()), sizeof(float) * A->val.size());
+    }
+    else
+    {
+        std::vector<double> block(FORMATS_MIN_CHUNK / sizeof(double));
+        for (size_t i = 0U; (i < A->val.size()) && file; i += block.size())
+        {
+            const size_t count = std::min(block.size(), A->val.size() - i);
+            file.read(reinterpret_cast<char*>(block.data()), sizeof(double) * count);
+            std::transform(block.cbegin(), block.cbegin() + count, A->val.begin() + i,
+                           [](const double a) { return static_cast<float>(a); });
+        }
+    }
+
+    if (!file)
+    {
+        LOG_ERROR(local, filename, " is truncated.");
+        delete A;
+        return nullptr;
+    }
+
+    if (parsed.fortran)
+    {
+        A->transpose();
+    }
+
+    LOG_INFO(local, "Loaded [", A->rows, "x", A->cols, "] from ", filename, ".");
+    return A;
+}
+
+bool saveMtx(const Matrix &A, const std::string &filename, const bool coordinate)
+{
+    Log local;
+    std::ofstream file(filename, std::ios::binary);
+    std::vector<char> buffer(FORMATS_MIN_CHUNK + 64U);
+    size_t used = 0U;
+    uint64_t nonZeros = 0U;
+
+    // Shortest round-trip floats, written out every FORMATS_MIN_CHUNK chars
+    auto put = [&](const auto value, const char end)
+    {
+        used = std::to_chars(&buffer[used], &buffer[buffer.size() - 1U], value).ptr - buffer.data();
+        buffer[used++] = end;
+        if (FORMATS_MIN_CHUNK <= used)
+        {
+            file.write(buffer.data(), used);
+            used = 0U;
+        }
+    };
+
+    file << "%%MatrixMarket matrix " << (coordinate ? "coordinate" : "array") << " real general\n";
+    if (coordinate)
+    {
+        nonZeros = A.rows * A.cols - std::count(A.val.cbegin(), A.val.cbegin() + A.rows * A.cols, 0.0F);
+        file << A.rows << " " << A.cols << " " << nonZeros << "\n";
+
+        for (uint32_t i = 0U; i < A.rows; i++)
+        {
+            for (uint32_t j = 0U; j < A.cols; j++)
+            {
+                const float a = A.val[A.cols * i + j];
+                if (a != 0.0F)
+                {
+                    put(i + 1U, ' ');
+                    put(j + 1U, ' ');
+                    put(a, '\n');
+                }
+            }
+        }
+    }
+    else
+    {
+        file << A.rows << " " << A.cols << "\n";
+
+        // Dense files are column-major
+        for (uint32_t j = 0U; j < A.cols; j++)
+        {
+            for (uint32_t i = 0U; i < A.rows; i++)
+            {
+                put(A.val[A.cols * i + j], '\n');
+            }
+        }
+    }
+    file.write(buffer.data(), used);
+
+    if (!file)
+    {
+        LOG_ERROR(local, "Unable to write ", filename, ".");
+        return false;
+    }
+
+    LOG_INFO(local, "Saved [", A.rows, "x", A.cols, "] in ", filename, ".");
+    return true;
+}
+
+Matrix* loadMtx(const std::string &filename, const uint32_t threads)
+{
+    Log local;
+    MtxBanner banner;
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    std::vector<char> text;
+
+    // The whole file in one read, the threads parse it in place
+    if (file)
+    {
+        text.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(text.data(), text.size());
+    }
+
+    const char *first = text.data();
+    const char *last = text.data() + text.size();
+    if (!file || (parseMtxBanner(nextLine(first, last), banner) == false))
+    {
+        LOG_ERROR(local, filename, " is not a supported Matrix Market file.");
+        return nullptr;
+    }
+
+    // Comments, and then "rows cols [entries]"
+    while ((first < last) && ((*first == '%') || (*first == '\n') || (*first == '\r')))
+    {
+        nextLine(first, last);
+    }
+
+    uint32_t rows = 0U, cols = 0U;
+    uint64_t entries = 0U;
+    if ((next(first, last, rows) == false) || (next(first, last, cols) == false) ||
+        (banner.coordinate && (next(first, last, entries) == false)))
+    {
+        LOG_ERROR(local, "Missing size line in ", filename, ".");
+        return nullptr;
+    }
+    // The mirrored entries of a symmetric file are only in bounds when it is square
+    if ((banner.symmetry != 0) && (rows != cols))
+    {
+        LOG_ERROR(local, "Symmetric [", rows, "x", cols, "] matrix in ", filename, " is not square.");
+        return nullptr;
+    }
+
+    // One chunk per thread, but not smaller than FORMATS_MIN_CHUNK
+    const uint32_t hardware = (threads == 0U) ? std::max(std::thread::hardware_concurrency(), 1U) : threads;
+    const uint32_t count = static_cast<uint32_t>(std::min<size_t>(hardware, (last - first) / FORMATS_MIN_CHUNK + 1U));
+    const std::vector<const char*> bounds = split(first, last, count);
+    std::vector<uint64_t> parsed(count, 0U);
+    std::vector<uint8_t> valid(count, 0U);
+
+    Matrix *A = new Matrix(rows, cols);
+    if (banner.coordinate)
+    {
+        parallel(count, [&](const uint32_t i)
+        {
+            valid[i] = parseEntries(bounds[i], bounds[i + 1U], banner, *A, parsed[i]);
+        });
+    }
+    else
+    {
+        // Counting first, so that each chunk knows where its values go
+        entries = static_cast<uint64_t>(rows) * cols;
+        parallel(count, [&](const uint32_t i)
+        {
+            parsed[i] = countTokens(bounds[i], bounds[i + 1U]);
+        });
+
+        std::vector<uint64_t> offsets(count, 0U);
+        std::partial_sum(parsed.cbegin(), parsed.cend() - 1, offsets.begin() + 1);
+        if (offsets.back() + parsed.back() == entries)
+        {
+            parallel(count, [&](const uint32_t i)
+            {
+                valid[i] = parseValues(bounds[i], bounds[i + 1U], offsets[i], *A);
+            });
+        }
+    }
+
+    if ((std::count(valid.cbegin(), valid.cend(), 0U) != 0) ||
+        (std::accumulate(parsed.cbegin(), parsed.cend(), uint64_t(0U)) != entries))
+    {
+        LOG_ERROR(local, "Wrong entries in ", filename, ", expecting ", entries, ".");
+        delete A;
+        return nullptr;
+    }
+
+    LOG_INFO(local, "Loaded [", rows, "x", cols, "] from ", filename, " with ", count, " threads.");
+    return A;
+}
@@ -0,0 +1,57 @@
+/*******************************************************************************
+*
+* Matrix formats
+*
+*   SUMMARY
+*       Readers and writers to exchange matrices with other tools.
+*
+*       a) NumPy's .npy, version 1.0 with '<f4' or '<f8' values. The values
+*          of the files written here start at a 64-byte boundary, so that
+*          numpy.load(..., mmap_mode='r') maps them. openNpy() gives their
+*          offset to read or write them in place.
+*
+*       b) Matrix Market's .mtx, "array" (dense) and "coordinate" (sparse,
+*          it is read into a dense Matrix) with real, integer or pattern
+*          values. The text is split in chunks at line boundaries and
+*          parsed by several threads with std::from_chars().
+*
+*       Readers return a new Matrix, or nullptr when the file is not valid.
+*
+*******************************************************************************/
+
+#ifndef FORMATS_H_
+#define FORMATS_H_
+
+/******************************************************************************/
+/*    INCLUDED FILES                                                          */
+/******************************************************************************/
+
+#include <cstdint>
+#include <string>
+
+#include "matrix.hpp"
+
+/******************************************************************************/
+/*    DEFINITIONS                                                             */
+/******************************************************************************/
+
+// Chunks smaller than this are not worth a thread
+#define FORMATS_MIN_CHUNK   (64U * 1024U)
+
+/******************************************************************************/
+/*    API                                                                     */
+/******************************************************************************/
+
+// .npy
+bool saveNpy(const Matrix &A, const std::string &filename);
+Matrix* loadNpy(const std::string &filename);
+// A zero-filled rows x cols file, to be written in place
+bool createNpy(const std::string &filename, const uint32_t rows, const uint32_t cols);
+// Offset of the values of a C-order '<f4' file, 0 for any other file
+uint64_t openNpy(const std::string &filename, uint32_t &rows, uint32_t &cols);
+
+// .mtx, threads = 0 uses std::thread::hardware_concurrency()
+bool saveMtx(const Matrix &A, const std::string &filename, const bool coordinate = false);
+Matrix* loadMtx(const std::string &filename, const uint32_t threads = 0U);
+
+#endif /* FORMATS_H_ */
@@ -2,12 +2,19 @@
 /*    INCLUDED FILES                                                          */
 /******************************************************************************/
 
+#include <algorithm>
 #include <cfloat>
+#include <cmath>
 #include <cstdint>
 #include <iomanip>
+#include <iostream>
+#include <limits>
 
+#include "counters.hpp"
+#include "kernels.h"
 #include "matrix.hpp"
 #include "memory.hpp"
+#include "trace.hpp"
 
 /******************************************************************************/
 /*    IMPLEMENTATION                                                          */
@@ -82,6 +89,9 @@ Matrix& Matrix::reshape(const uint32_t newRows, const uint32_t newCols)
 
 Matrix& Matrix::transpose()
 {
+    TRACE_SPAN("transpose", "rows", this->rows, "cols", this->cols);
+    MEMORY_SITE("transpose");
+    PERF_SCOPE("transpose", this->val.size());
     if (this->val.empty())
     {
         LOG_WARNING(this->logMatrix, "Nothing to transpose: Empty matrix!");
@@ -94,18 +104,10 @@ Matrix& Matrix::transpose()
         // There is no need to transpose a row or a column vector
         if ((this->rows > 1) && (this->cols > 1))
         {
-            Matrix A(*this);
+            Values AT(this->val.size());
+            kernel_transpose(this->rows, this->cols, this->val.data(), this->cols, AT.data(), this->rows);
+            this->val.swap(AT);
             this->reshape(this->cols, this->rows);
-            for (uint32_t row = 0; row < A.rows; row++)
-            {
-                for (uint32_t col = 0; col < A.cols; col++)
-                {
-                    uint32_t pos = A.cols * row + col;
-                    uint32_t newPos = this->cols * col + row;
-
-                    this->val[newPos] = A.val[pos];
-                }
-            }
         }
         else
         {
@@ -140,6 +142,8 @@ Matrix& Matrix::id(const size_t size)
 
 Matrix* Matrix::getBlock()
 {
+    TRACE_SPAN("getBlock", "rows", this->rows, "cols", this->cols);
+    MEMORY_SITE("getBlock");
     Matrix *subA = nullptr;
 
     if ((this->rows < 2U) || (this->cols < 2U))
@@ -172,6 +176,7 @@ Matrix* Matrix::getBlock()
 
 Matrix* Matrix::setBlock(Matrix *S)
 {
+    TRACE_SPAN("setBlock", "rows", S->rows, "cols", S->cols);
     if ((this->rows - S->rows != 1U) || (this->cols - S->rows != 1U))
     {
         LOG_WARNING(this->logMatrix, "Unable to set block from [", S->rows, "x", S->cols,
@@ -197,6 +202,8 @@ Matrix* Matrix::setBlock(Matrix *S)
 
 Matrix* Matrix::rowPermute()
 {
+    TRACE_SPAN("rowPermute", "rows", this->rows, "cols", this->cols);
+    MEMORY_SITE("rowPermute");
     Matrix *PA = nullptr;
 
     uint32_t row = 0U;
@@ -245,6 +252,8 @@ Matrix* Matrix::rowPermute()
 
 Matrix* Matrix::rowReduction()
 {
+    TRACE_SPAN("rowReduction", "rows", this->rows, "cols", this->cols);
+    MEMORY_SITE("rowReduction");
     Matrix L_inv;
     L_inv.id(this->rows);
 
@@ -268,6 +277,9 @@ Matrix* Matrix::rowReduction()
 
 Matrix* Matrix::echelon()
 {
+    TRACE_SPAN("echelon", "rows", this->rows, "cols", this->cols);
+    MEMORY_SITE("echelon");
+    PERF_SCOPE("echelon", this->val.size());
     // overdertemined case
     if (this->rows > this->cols)
     {
@@ -331,6 +343,35 @@ Matrix* Matrix::echelon()
     }
 }
 
+Matrix* Matrix::solve(Matrix &B)
+{
+    TRACE_SPAN("solve", "rows", this->rows, "cols", B.cols);
+    MEMORY_SITE("solve");
+    PERF_SCOPE("solve", this->val.size());
+
+    if ((this->rows != this->cols) || (this->rows != B.rows) || this->val.empty())
+    {
+        LOG_WARNING(this->logMatrix, "Unable to solve [", this->rows, "x", this->cols,
+                "] X = [", B.rows, "x", B.cols, "]");
+        return nullptr;
+    }
+
+    // LU and piv are scratch, X starts as a copy of B
+    Values LU(this->val);
+    std::vector<uint32_t> piv(this->rows);
+    if (kernel_getrf(this->rows, this->cols, LU.data(), this->cols, piv.data()) != 0U)
+    {
+        LOG_WARNING(this->logMatrix, "The matrix is singular, A X = B was not solved.");
+        return nullptr;
+    }
+
+    Matrix *X = new Matrix(B);
+    kernel_getrs(this->rows, X->cols, LU.data(), this->cols, piv.data(), X->val.data(), X->cols);
+    LOG_MATRIX(*X);
+
+    return X;
+}
+
 void* Matrix::operator new(std::size_t count)
 {
     Log tmp;
@@ -350,6 +391,7 @@ void* Matrix::operator new(std::size_t count)
         {
             LOG_DEBUG(tmp, "manager.push_back(", pMatrix, ").");
             pMatrix->manager.push_back(pMatrix);
+            MemoryStats::countAllocation();
         }
         else
         {
@@ -379,6 +421,7 @@ void Matrix::operator delete(void* ptr) noexcept
                 LOG_INFO(tmp, "Freeing (Matrix*)", ptr);
                 pManager->erase(pMatrix);
                 std::free(ptr);
+                MemoryStats::countFree();
 
                 break;
             }
@@ -392,6 +435,19 @@ void Matrix::operator delete(void* ptr) noexcept
     std::cout << tmp.str();
 }
 
+MemoryStats Matrix::memoryStats()
+{
+    MemoryStats stats = MemoryStats::query();
+
+    // Entries still in the manager were never deleted
+    for (const Matrix *pMatrix : manager)
+    {
+        stats.retained += sizeof(Matrix) + sizeof(float) * pMatrix->val.capacity();
+    }
+
+    return stats;
+}
+
 void Matrix::log(const std::string &newName)
 {
     if (this->name != newName)
@@ -406,57 +462,128 @@ void Matrix::log(const std::string &newName)
     }
     else
     {
-        std::string matrix = this->log();
-        this->logMatrix.log(matrix);
+        // Row by row into the sink, there is no string of the whole matrix
+        this->log(std::cout);
     }
 }
 
+void Matrix::log(std::ostream &os) const
+{
+    const uint32_t edge = std::max(logEdge, 1U);
+    const bool summary = (this->rows > logLimit) || (this->cols > logLimit);
+    // Rows after the first edge ones are skipped down to the last edge ones
+    const uint32_t skip = ((this->rows > logLimit) && (this->rows > 2U * edge)) ? this->rows - 2U * edge : 0U;
+    // 3U = size(" = ")
+    const std::string margin(3U + this->name.size() + 3U, ' ');
+
+    if (summary)
+    {
+        // building "   A in [RxC]: min = a, max = b, mean = c, NaN = n"
+        const Stats stats = this->stats();
+        os << Log::MSG::GRAY << std::string(3U, ' ') << this->name << " in [" << this->rows << "x" << this->cols
+           << "]: min = " << stats.min << ", max = " << stats.max << ", mean = " << stats.mean
+           << ", NaN = " << stats.nan << Log::MSG::ENDC << Log::MSG::ENDL;
+    }
+
+    for (uint32_t i = 0U; i < this->rows; i++)
+    {
+        if ((skip != 0U) && (i == edge))
+        {
+            // building "[       ...]" in place of the skipped rows
+            os << Log::MSG::GRAY << margin << "[" << std::setw(10U) << "..." << "]" << Log::MSG::ENDC << Log::MSG::ENDL;
+            i += skip;
+        }
+
+        //          |123 1234|
+        // building "   A = [" or the margin of the next rows
+        if (i == 0U)
+        {
+            os << Log::MSG::GRAY << std::string(3U, ' ') << this->name << " = [" << Log::MSG::ENDC;
+        }
+        else
+        {
+            os << Log::MSG::GRAY << margin << "[" << Log::MSG::ENDC;
+        }
+        // building "a(i,0), ..., a(i,j), ..., a(i,n-1)]"
+        this->log(os, this->val.cbegin() + this->cols * i);
+        os << Log::MSG::GRAY << "]" << Log::MSG::ENDC << Log::MSG::ENDL;
+    }
+}
+
+// It streams only the content of [ a, b, ..., i, ..., n], without the "[]"
+void Matrix::log(std::ostream &os, const Values::const_iterator pRow) const
+{
+    const uint32_t width = 10U;
+    const uint32_t edge = std::max(logEdge, 1U);
+    // Columns after the first edge ones are skipped down to the last edge ones
+    const uint32_t skip = ((this->cols > logLimit) && (this->cols > 2U * edge)) ? this->cols - 2U * edge : 0U;
+    // std::fixed would stick to os otherwise
+    const std::ios_base::fmtflags flags = os.flags();
+
+    os << Log::MSG::WHITE << std::fixed;
+    for (uint32_t j = 0U; j < this->cols; j++)
+    {
+        if ((skip != 0U) && (j == edge))
+        {
+            os << "," << std::right << std::setw(width) << "...";
+            j += skip;
+        }
+
+        os << ((j == 0U) ? "" : ",") << std::right << std::setw(width) << pRow[j];
+    }
+    os << Log::MSG::ENDC;
+
+    os.flags(flags);
+}
+
 std::string Matrix::log() const
 {
-    std::string row;
-    // the first/edge case could be handle at initialization(new) level?
     Log matrix;
-    uint32_t margin = 3U;
-
-    // edge case, first iteration
-    //          |123 1234|
-    // building "   A = ["
-    matrix << Log::MSG::GRAY << std::string(margin, ' ') << this->name << " = [" << Log::MSG::ENDC;
-    // building "a(0), ..., a(i), ..., a(n-1)" entries of a Matrix
-    matrix << this->log(this->val.cbegin());
-    // building "]"
-    matrix << Log::MSG::GRAY << "]" << Log::MSG::ENDC;
+    this->log(matrix);
 
-    // 3U = size(" = ")
-    margin += this->name.size() + margin;
-    // to loop over only when rows > 0
-    for (uint32_t i = 1U; i < this->rows; i++)
+    // Without the last ENDL, Log::log() appends its own
+    std::string str = matrix.str();
+    if (str.empty() == false)
     {
-        uint32_t pos = this->cols * i;
-        // Log::MSG::ENDL need to be the first to have a prettier print
-        matrix << Log::MSG::ENDL << Log::MSG::GRAY << std::string(margin, ' ') << "[" << Log::MSG::ENDC;
-        matrix << this->log(this->val.cbegin() + pos);
-        matrix << Log::MSG::GRAY << "]" << Log::MSG::ENDC;
+        str.pop_back();
     }
 
-    return matrix.str();
+    return str;
 }
 
-// It returns only the content of [ a, b, ..., i, ..., n], without the "[]"
-std::string Matrix::log(const std::vector<float>::const_iterator pRow) const
+std::string Matrix::log(const Values::const_iterator pRow) const
 {
-    const uint32_t width = 10U;
     Log row;
+    this->log(row, pRow);
+
+    return row.str();
+}
+
+Matrix::Stats Matrix::stats() const
+{
+    // std::fmin() and std::fmax() return the other argument on NaN
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    Stats stats = {nan, nan, static_cast<double>(nan), 0U};
+    double sum = 0.0;
 
-    // building initial element
-    row << Log::MSG::WHITE << std::right << std::setw(width) << std::fixed << *pRow;
-    for (uint32_t j = 1U; j < this->cols; j++)
+    for (const float a : this->val)
     {
-        row << "," << std::right << std::setw(width) << std::fixed << pRow[j];
+        if (std::isnan(a))
+        {
+            stats.nan++;
+        }
+        else
+        {
+            stats.min = std::fmin(stats.min, a);
+            stats.max = std::fmax(stats.max, a);
+            sum += a;
+        }
     }
 
-    row << Log::MSG::ENDC;
+    if (stats.nan < this->val.size())
+    {
+        stats.mean = sum / static_cast<double>(this->val.size() - stats.nan);
+    }
 
-    // Delete after returning
-    return row.str();
+    return stats;
 }
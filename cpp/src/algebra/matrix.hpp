@@ -8,8 +8,12 @@
 *       The API's functionality is simple:
 *       a) matrix creation and destruction,
 *       b) memory management,
-*       c) minimal set of matrix operators to manipulate matrices
-*       d) logging capabilities
+*       c) minimal set of matrix operators to manipulate matrices, their
+*          loops are the kernels of c/src/kernels, shared with the C algebra.
+*          gemm() accumulates op(A) op(B) into an existing C, without
+*          allocating it nor transposing A or B
+*       d) logging capabilities, large matrices are summarized with their
+*          shape, stats and the first and last rows and columns.
 *
 *******************************************************************************/
 
@@ -20,6 +24,9 @@
 /*    INCLUDED FILES                                                          */
 /******************************************************************************/
 
+#include <vector>
+
+#include "kernels.h"
 #include "levels.hpp"
 #include "memory.hpp"
 
@@ -44,10 +51,11 @@
  */
 #if LOG_LEVEL_DEBUG <= LOG_CONFIG
     #define LOG_MATRIX(A) \
-        LOG_DEBUG((A).logMatrix, #A, " in [", (A).rows, "x", (A).cols, "]."); \
-        (A).log(#A);
+        do { if (LOG_ENABLED(Log::Level::DEBUG)) { \
+            LOG_DEBUG((A).logMatrix, #A, " in [", (A).rows, "x", (A).cols, "]."); \
+            (A).log(#A); } } while (0)
 #else
-    #define LOG_MATRIX(A)
+    #define LOG_MATRIX(A) do {} while (0)
 #endif
 
 /******************************************************************************/
@@ -63,10 +71,25 @@ struct Matrix
     Log logMatrix;
     std::string name = "A";
 
-    // Matrix abstraction
+    // Matrices with more rows or columns than logLimit are summarized, only
+    // their first and last logEdge rows and columns are printed.
+    static inline uint32_t logLimit = 16U;
+    static inline uint32_t logEdge = 3U;
+
+    // min, max and mean skip the NaNs, which are counted.
+    struct Stats
+    {
+        float    min;
+        float    max;
+        double   mean;
+        uint64_t nan;
+    };
+
+    // Matrix abstraction, its buffer is counted in MemoryStats
+    using Values = std::vector<float, Counted<float>>;
     uint32_t    rows = 0;
     uint32_t    cols = 0;
-    std::vector<float>  val;
+    Values      val;
 
     // Constructors & Destructors
     Matrix(std::initializer_list<float> val); // Matrix allocation from a list
@@ -86,16 +109,23 @@ struct Matrix
     Matrix* rowPermute();
     Matrix* rowReduction();
     Matrix* echelon();
+    // A X = B, X is new, nullptr when A is singular
+    Matrix* solve(Matrix &B);
 
     // Glue code for the memory management
     void* operator new(std::size_t count);
     void operator delete(void* ptr) noexcept;
+    // MemoryStats::query() and the bytes retained by the manager's entries
+    static MemoryStats memoryStats();
 
     // log is the public API
-    // log(string newName) calls log()
+    // log(string newName) streams the matrix row by row into std::cout
     void log(const std::string &newName);
+    void log(std::ostream &os) const;
+    void log(std::ostream &os, const Values::const_iterator row) const;
     std::string log() const;
-    std::string log(const std::vector<float>::const_iterator row) const;
+    std::string log(const Values::const_iterator row) const;
+    Stats stats() const;
 
     // When removing const, googletest complains
     friend bool operator==(const Matrix& A, const Matrix& B);
@@ -107,5 +137,9 @@ struct Matrix
     friend Matrix* operator*(const float a, Matrix &B);
     friend Matrix* operator*(Matrix &A, const float b);
     friend Matrix* operator*(Matrix &A, const float b);
+    // C := alpha op(A) op(B) + beta C in place, op is BLAS_NO_TRANS or
+    // BLAS_TRANS, returns &C, nullptr when the sizes do not match
+    friend Matrix* gemm(const uint32_t opA, const uint32_t opB, const float alpha, Matrix &A,
+                        Matrix &B, const float beta, Matrix &C);
 };
 #endif /* MATRIX_H_ */
@@ -6,6 +6,12 @@
 *       A simple static stack to bookkeep the pointers of all dynamically
 *       allocated memory with the matrix.
 *
+*       MemoryStats counts allocations: objects through countAllocation()
+*       and countFree(), and buffers through the Counted<T> allocator. Each
+*       thread keeps its own counts and query() adds them up, the bytes held
+*       and their peak are global. Allocations are charged to the innermost
+*       MEMORY_SITE() of their thread.
+*
 *******************************************************************************/
 
 #ifndef MEMORY_H_
@@ -15,15 +21,237 @@
 /*    INCLUDED FILES                                                          */
 /******************************************************************************/
 
+#include <atomic>
+#include <cstdint>
 #include <deque>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
 
 #include "levels.hpp"
 
+// Logs in this header belong to the memory module
+#pragma push_macro("LOG_MODULE")
+#undef LOG_MODULE
+#define LOG_MODULE Log::Module::MEMORY
+
+/******************************************************************************/
+/*    PUBLIC MACROS                                                           */
+/******************************************************************************/
+
+// Distinct sites counted per thread, "other" included, the next ones are
+// charged to "other"
+#define MEMORY_SITES    (32U)
+
+/**
+ * @example    MEMORY_SITE("operator*");
+ */
+#define MEMORY_SITE(name) \
+    MemoryStats::Site memorySite(name)
+
 /******************************************************************************/
 /*    API                                                                     */
 /******************************************************************************/
 
+struct MemoryStats
+{
+    uint64_t allocations = 0U;  // objects
+    uint64_t frees = 0U;
+    uint64_t live = 0U;
+    uint64_t buffers = 0U;      // buffer allocations
+    uint64_t bytes = 0U;        // held by buffers
+    uint64_t peak = 0U;
+    uint64_t retained = 0U;     // left in a manager, filled by its owner
+    std::map<std::string, uint64_t> sites;
+
+    // Charging the allocations of its scope to name, name must outlive it
+    struct Site
+    {
+        explicit Site(const char *name) : previous(local().site) { local().site = name; }
+        ~Site() { local().site = this->previous; }
+
+        Site(const Site&) = delete;
+        Site& operator=(const Site&) = delete;
+
+    private:
+        const char *previous;
+    };
+
+    static void countAllocation()
+    {
+        Local &counters = local();
+        counters.increment(counters.allocations);
+        counters.charge();
+    }
+
+    static void countFree()
+    {
+        Local &counters = local();
+        counters.increment(counters.frees);
+    }
+
+    static void countBuffer(const size_t bytes)
+    {
+        Local &counters = local();
+        counters.increment(counters.buffers);
+        counters.charge();
+
+        const uint64_t now = held.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        uint64_t top = highest.load(std::memory_order_relaxed);
+        while ((now > top) && !highest.compare_exchange_weak(top, now, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    static void countBufferFree(const size_t bytes)
+    {
+        held.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    static MemoryStats query()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        MemoryStats stats = retired();
+
+        for (const Local *counters : threads)
+        {
+            counters->addTo(stats);
+        }
+        stats.live = stats.allocations - stats.frees;
+        stats.bytes = held.load(std::memory_order_relaxed);
+        stats.peak = highest.load(std::memory_order_relaxed);
+
+        return stats;
+    }
+
+    // The peak restarts from the bytes held now
+    static void resetPeak()
+    {
+        highest.store(held.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+private:
+    // Counts of a thread, only their thread writes them, so plain stores are
+    // enough and other threads read them while they run.
+    struct Local
+    {
+        std::atomic<uint64_t> allocations{0U};
+        std::atomic<uint64_t> frees{0U};
+        std::atomic<uint64_t> buffers{0U};
+        const char *site = nullptr;
+        const char *names[MEMORY_SITES] = {"other"};
+        std::atomic<uint64_t> counts[MEMORY_SITES] = {};
+        std::atomic<uint32_t> used{1U};
+
+        Local()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.push_back(this);
+        }
+
+        // Counts of finished threads are kept in retired()
+        ~Local()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            this->addTo(retired());
+            for (auto counters = threads.begin(); counters != threads.end(); counters++)
+            {
+                if (*counters == this)
+                {
+                    threads.erase(counters);
+                    break;
+                }
+            }
+        }
+
+        static void increment(std::atomic<uint64_t> &count)
+        {
+            count.store(count.load(std::memory_order_relaxed) + 1U, std::memory_order_relaxed);
+        }
+
+        void charge()
+        {
+            const uint32_t used = this->used.load(std::memory_order_relaxed);
+            uint32_t i = 0U;
+
+            if (this->site != nullptr)
+            {
+                for (i = 1U; (i < used) && (this->names[i] != this->site); i++)
+                {
+                }
+                if ((i == used) && (used < MEMORY_SITES))
+                {
+                    this->names[i] = this->site;
+                    this->used.store(used + 1U, std::memory_order_release);
+                }
+            }
+            increment(this->counts[(i < MEMORY_SITES) ? i : 0U]);
+        }
+
+        void addTo(MemoryStats &stats) const
+        {
+            stats.allocations += this->allocations.load(std::memory_order_relaxed);
+            stats.frees += this->frees.load(std::memory_order_relaxed);
+            stats.buffers += this->buffers.load(std::memory_order_relaxed);
+
+            const uint32_t used = this->used.load(std::memory_order_acquire);
+            for (uint32_t i = 0U; i < used; i++)
+            {
+                stats.sites[this->names[i]] += this->counts[i].load(std::memory_order_relaxed);
+            }
+        }
+    };
+
+    static Local& local()
+    {
+        static thread_local Local counters;
+        return counters;
+    }
+
+    static inline std::atomic<uint64_t> held{0U};
+    static inline std::atomic<uint64_t> highest{0U};
+    static inline std::mutex mutex;
+    static inline std::vector<Local*> threads;
+
+    // A static member cannot be of its own, incomplete, type
+    static MemoryStats& retired()
+    {
+        static MemoryStats stats;
+        return stats;
+    }
+};
+
+// Allocator that counts the bytes of a container in MemoryStats
+template<typename T>
+struct Counted
+{
+    using value_type = T;
+
+    Counted() = default;
+    template<typename U>
+    Counted(const Counted<U>&) {}
+
+    T* allocate(const size_t n)
+    {
+        T *p = std::allocator<T>().allocate(n);
+        MemoryStats::countBuffer(sizeof(T) * n);
+        return p;
+    }
+
+    void deallocate(T *p, const size_t n)
+    {
+        MemoryStats::countBufferFree(sizeof(T) * n);
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template<typename U>
+    bool operator==(const Counted<U>&) const { return true; }
+    template<typename U>
+    bool operator!=(const Counted<U>&) const { return false; }
+};
+
 template<typename T>
 struct Memory: public std::deque<T>
 {
@@ -44,4 +272,6 @@ struct Memory: public std::deque<T>
     }
 };
 
+#pragma pop_macro("LOG_MODULE")
+
 #endif /* MEMORY_H_ */
@@ -2,8 +2,11 @@
 /*    INCLUDED FILES                                                          */
 /******************************************************************************/
 
+#include "counters.hpp"
+#include "kernels.h"
 #include "levels.hpp"
 #include "matrix.hpp"
+#include "trace.hpp"
 
 /******************************************************************************/
 /*    IMPLEMENTATION                                                          */
@@ -44,6 +47,8 @@ bool operator==(const Matrix& A, const Matrix& B)
 
 Matrix* operator+(Matrix& A, Matrix& B)
 {
+    TRACE_SPAN("operator+", "rows", A.rows, "cols", A.cols);
+    MEMORY_SITE("operator+");
     Matrix *C = nullptr;
 
     if ((A.rows != B.rows) || (A.cols != B.cols))
@@ -58,15 +63,7 @@ Matrix* operator+(Matrix& A, Matrix& B)
         LOG_WARNING(A.logMatrix, "Adding matrices.");
         LOG_WARNING(B.logMatrix, "Adding matrices.");
         C = new Matrix(A.rows, A.cols);
-
-        for (uint32_t i = 0U; i < A.rows; i++)
-        {
-            for (uint32_t j = 0U; j < A.cols; j++)
-            {
-                uint32_t pos = C->cols * i + j;
-                C->val[pos] = A.val[pos] + B.val[pos];
-            }
-        }
+        kernel_add(A.rows, A.cols, A.val.data(), A.cols, B.val.data(), B.cols, C->val.data(), C->cols);
 
         LOG_MATRIX(*C);
     }
@@ -77,6 +74,8 @@ Matrix* operator+(Matrix& A, Matrix& B)
 // same case as with + operator
 Matrix* operator-(Matrix& A, Matrix &B)
 {
+    TRACE_SPAN("operator-", "rows", A.rows, "cols", A.cols);
+    MEMORY_SITE("operator-");
     Matrix *C = nullptr;
 
     if ((A.rows != B.rows) || (A.cols != B.cols))
@@ -91,15 +90,7 @@ Matrix* operator-(Matrix& A, Matrix &B)
         LOG_WARNING(A.logMatrix, "Substracting matrices.");
         LOG_WARNING(B.logMatrix, "Substracting matrices.");
         C = new Matrix(A.rows, A.cols);
-
-        for (uint32_t i = 0U; i < A.rows; i++)
-        {
-            for (uint32_t j = 0U; j < A.cols; j++)
-            {
-                uint32_t pos = C->cols * i + j;
-                C->val[pos] = A.val[pos] - B.val[pos];
-            }
-        }
+        kernel_sub(A.rows, A.cols, A.val.data(), A.cols, B.val.data(), B.cols, C->val.data(), C->cols);
 
         LOG_MATRIX(*C);
     }
@@ -110,6 +101,9 @@ Matrix* operator-(Matrix& A, Matrix &B)
 // same case as with + operator
 Matrix* operator*(Matrix &A, Matrix &B)
 {
+    TRACE_SPAN("operator*", "rows", A.rows, "inner", A.cols, "cols", B.cols);
+    MEMORY_SITE("operator*");
+    PERF_SCOPE("operator*", static_cast<uint64_t>(A.rows) * A.cols * B.cols);
     Matrix *C = nullptr;
 
     if (A.cols != B.rows)
@@ -129,43 +123,46 @@ Matrix* operator*(Matrix &A, Matrix &B)
         C = new Matrix;
         C->reshape(A.rows, B.cols);
 
-        for (uint32_t row = 0; row < A.rows; row++)
-        {
-            auto pRow = A.val.cbegin() + A.cols * row;
-
-            for (uint32_t col = 0U; col < B.cols; col++)
-            {
-                auto pCol = B.val.cbegin() + col;
-
-                auto pC = C->val.begin() + (C->cols * row) + col;
-                *pC = 0.0F;
-                LOG_DEBUG(C->logMatrix, "C[", row, ",", col, "] = ", *pC);
-                for (uint32_t k = 0U; k < A.cols; k++)
-                {
-                    *pC += pRow[k] * pCol[B.cols * k];
-                    LOG_TRACE(C->logMatrix, "C[", row, ",", col, "] += ",
-                                            "A[", A.cols * row, ",", k, "] * ",
-                                            "B[", B.cols * k, ",", col, "] = ",
-                                            pRow[k] * pCol[B.cols * k]);
-                }
-                LOG_DEBUG(C->logMatrix, "C[", row, ",", col, "] = ", *pC);
-            }
-        }
+        kernel_gemm(BLAS_NO_TRANS, BLAS_NO_TRANS, A.rows, B.cols, A.cols, 1.0F, A.val.data(), A.cols,
+                    B.val.data(), B.cols, 0.0F, C->val.data(), C->cols);
     }
 
     return C;
 }
 
+Matrix* gemm(const uint32_t opA, const uint32_t opB, const float alpha, Matrix &A,
+             Matrix &B, const float beta, Matrix &C)
+{
+    const uint32_t m = (opA == BLAS_NO_TRANS) ? A.rows : A.cols;
+    const uint32_t k = (opA == BLAS_NO_TRANS) ? A.cols : A.rows;
+    const uint32_t kB = (opB == BLAS_NO_TRANS) ? B.rows : B.cols;
+    const uint32_t n = (opB == BLAS_NO_TRANS) ? B.cols : B.rows;
+    TRACE_SPAN("gemm", "rows", m, "inner", k, "cols", n);
+    PERF_SCOPE("gemm", static_cast<uint64_t>(m) * k * n);
+
+    if ((k != kB) || (C.rows != m) || (C.cols != n))
+    {
+        LOG_WARNING(C.logMatrix, "Matrices A and B cannot be multiply into C.");
+        LOG_WARNING(C.logMatrix, "op(A) is in [", m, "x", k, "], op(B) in [", kB, "x", n,
+                    "] and C in [", C.rows, "x", C.cols, "].");
+        return nullptr;
+    }
+
+    kernel_gemm(opA, opB, m, n, k, alpha, A.val.data(), A.cols, B.val.data(), B.cols,
+                beta, C.val.data(), C.cols);
+
+    return &C;
+}
+
 // implicit conversion from ints to floats
 Matrix* operator*(const float a, Matrix &B)
 {
+    TRACE_SPAN("scalar*", "rows", B.rows, "cols", B.cols);
+    MEMORY_SITE("scalar*");
     Matrix *C = new Matrix;
     C->reshape(B.rows, B.cols);
 
-    for (auto b = B.val.begin(), c = C->val.begin(); b != B.val.end(); b++, c++)
-    {
-        *c = a * *b;
-    }
+    kernel_scale(B.rows, B.cols, a, B.val.data(), B.cols, C->val.data(), C->cols);
 
     return C;
 }
@@ -0,0 +1,186 @@
+/******************************************************************************/
+/*    INCLUDED FILES                                                          */
+/******************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <future>
+#include <vector>
+
+#include "formats.hpp"
+#include "levels.hpp"
+#include "tiles.hpp"
+
+/******************************************************************************/
+/*    PRIVATE DATA                                                            */
+/******************************************************************************/
+
+// A matrix in a file, its values are rows x cols floats from offset on
+struct Operand
+{
+    uint32_t rows = 0U;
+    uint32_t cols = 0U;
+    uint64_t offset = 0U;
+};
+
+// Origin of the tiles of a step, C(row, col) += A(row, inner) * B(inner, col)
+struct Step
+{
+    uint32_t row;
+    uint32_t col;
+    uint32_t inner;
+};
+
+/******************************************************************************/
+/*    PRIVATE FUNCTIONS                                                       */
+/******************************************************************************/
+
+// Reading tile.rows x tile.cols values from (row, col) on
+static void readTile(std::istream &file, const Operand &A, const uint32_t row, const uint32_t col, Matrix &tile)
+{
+    for (uint32_t i = 0U; i < tile.rows; i++)
+    {
+        file.seekg(A.offset + sizeof(float) * (static_cast<uint64_t>(A.cols) * (row + i) + col));
+        file.read(reinterpret_cast<char*>(tile.val.data() + tile.cols * i), sizeof(float) * tile.cols);
+    }
+}
+
+static void writeTile(std::ostream &file, const Operand &C, const uint32_t row, const uint32_t col, const Matrix &tile)
+{
+    for (uint32_t i = 0U; i < tile.rows; i++)
+    {
+        file.seekp(C.offset + sizeof(float) * (static_cast<uint64_t>(C.cols) * (row + i) + col));
+        file.write(reinterpret_cast<const char*>(tile.val.data() + tile.cols * i), sizeof(float) * tile.cols);
+    }
+}
+
+/******************************************************************************/
+/*    IMPLEMENTATION                                                          */
+/******************************************************************************/
+
+uint32_t tileSize(const size_t budget)
+{
+    const double floats = static_cast<double>(budget) / sizeof(float) / TILES_IN_BUDGET;
+
+    return std::max(static_cast<uint32_t>(std::sqrt(floats)), 1U);
+}
+
+bool multiplyFiles(const std::string &a, const std::string &b, const std::string &c, const size_t budget)
+{
+    Log local;
+    Operand A, B, C;
+
+    A.offset = openNpy(a, A.rows, A.cols);
+    B.offset = openNpy(b, B.rows, B.cols);
+    if ((A.offset == 0U) || (B.offset == 0U) || (A.cols != B.rows))
+    {
+        LOG_ERROR(local, "Unable to multiply ", a, " in [", A.rows, "x", A.cols, "] and ",
+                  b, " in [", B.rows, "x", B.cols, "].");
+        return false;
+    }
+
+    if ((createNpy(c, A.rows, B.cols) == false) || ((C.offset = openNpy(c, C.rows, C.cols)) == 0U))
+    {
+        return false;
+    }
+
+    std::ifstream fileA(a, std::ios::binary);
+    std::ifstream fileB(b, std::ios::binary);
+    std::fstream fileC(c, std::ios::in | std::ios::out | std::ios::binary);
+
+    // The inner tiles of a tile of C are consecutive, it is written once
+    const uint32_t tile = tileSize(budget);
+    std::vector<Step> steps;
+    for (uint32_t row = 0U; row < C.rows; row += tile)
+    {
+        for (uint32_t col = 0U; col < C.cols; col += tile)
+        {
+            for (uint32_t inner = 0U; inner < A.cols; inner += tile)
+            {
+                steps.push_back({row, col, inner});
+            }
+        }
+    }
+    LOG_INFO(local, "Multiplying [", A.rows, "x", A.cols, "] by [", B.rows, "x", B.cols, "] in ",
+             steps.size(), " steps of ", tile, "x", tile, " tiles.");
+
+    // Tiles are allocated here, Matrix::manager is not thread-safe, and the
+    // other thread only reads their values
+    Matrix *nextA = nullptr, *nextB = nullptr;
+    auto prefetch = [&](const Step &step)
+    {
+        nextA = new Matrix(std::min(tile, A.rows - step.row), std::min(tile, A.cols - step.inner));
+        nextB = new Matrix(std::min(tile, B.rows - step.inner), std::min(tile, B.cols - step.col));
+
+        return std::async(std::launch::async, [&fileA, &fileB, &A, &B, step, tileA = nextA, tileB = nextB]()
+        {
+            readTile(fileA, A, step.row, step.inner, *tileA);
+            readTile(fileB, B, step.inner, step.col, *tileB);
+
+            return fileA.good() && fileB.good();
+        });
+    };
+
+    std::future<bool> next;
+    if (steps.empty() == false)
+    {
+        next = prefetch(steps.front());
+    }
+
+    Matrix *tileC = nullptr;
+    bool valid = true;
+    for (size_t s = 0U; (s < steps.size()) && valid; s++)
+    {
+        const Step &step = steps[s];
+        valid = next.get();
+        Matrix *tileA = nextA;
+        Matrix *tileB = nextB;
+
+        // Reading the next pair while this one is multiplied
+        if ((s + 1U < steps.size()) && valid)
+        {
+            next = prefetch(steps[s + 1U]);
+        }
+
+        if (step.inner == 0U)
+        {
+            tileC = new Matrix(tileA->rows, tileB->cols);
+        }
+
+        Matrix *product = *tileA * *tileB;
+        std::transform(tileC->val.cbegin(), tileC->val.cend(), product->val.cbegin(), tileC->val.begin(),
+                       [](const float c, const float p) { return c + p; });
+        delete product;
+        delete tileA;
+        delete tileB;
+
+        if (A.cols <= step.inner + tile)
+        {
+            writeTile(fileC, C, step.row, step.col, *tileC);
+            delete tileC;
+            tileC = nullptr;
+        }
+    }
+
+    // On errors, the last prefetch is still running
+    if (valid == false)
+    {
+        if (next.valid())
+        {
+            next.wait();
+            delete nextA;
+            delete nextB;
+        }
+        delete tileC;
+    }
+
+    fileC.flush();
+    if ((valid == false) || !fileC)
+    {
+        LOG_ERROR(local, "Unable to multiply ", a, " and ", b, " into ", c, ".");
+        return false;
+    }
+
+    return true;
+}
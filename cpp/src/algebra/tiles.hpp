@@ -0,0 +1,46 @@
+/*******************************************************************************
+*
+* Out-of-core matrix multiply
+*
+*   SUMMARY
+*       C = A * B for .npy operands larger than the memory, tile by tile
+*       within a memory budget.
+*
+*       a) tiles of A and B are read from their files, the next pair is
+*          read by another thread while the current pair is multiplied,
+*       b) each pair goes through the in-core operator*() and adds up into
+*          a tile of C,
+*       c) a tile of C is written to its file as soon as it is complete.
+*
+*******************************************************************************/
+
+#ifndef TILES_H_
+#define TILES_H_
+
+/******************************************************************************/
+/*    INCLUDED FILES                                                          */
+/******************************************************************************/
+
+#include <cstdint>
+#include <string>
+
+#include "matrix.hpp"
+
+/******************************************************************************/
+/*    DEFINITIONS                                                             */
+/******************************************************************************/
+
+// Square tiles in the budget: A and B, twice, plus C and the product
+#define TILES_IN_BUDGET   (6U)
+
+/******************************************************************************/
+/*    API                                                                     */
+/******************************************************************************/
+
+// Side of the tiles that fit in budget bytes, 1 at least
+uint32_t tileSize(const size_t budget);
+
+// A and B are C-order '<f4' .npy files, C is created or overwritten
+bool multiplyFiles(const std::string &a, const std::string &b, const std::string &c, const size_t budget);
+
+#endif /* TILES_H_ */
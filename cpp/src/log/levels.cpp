@@ -2,15 +2,168 @@
 /*    INCLUDED FILES                                                          */
 /******************************************************************************/
 
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
 #include <string>
+#include <strings.h>
 
 #include "levels.hpp"
 
+/******************************************************************************/
+/*    PRIVATE DATA                                                            */
+/******************************************************************************/
+
+// Names accepted by Log::setLevels(), indexed by level and module
+static const char *levelName[Log::Level::FULL] = {"ERROR", "WARNING", "INFO", "DEBUG", "TRACE"};
+
+static const char *moduleName[Log::Module::ALL] = {"algebra", "memory", "log"};
+
+// Reading LOG_ENV_VAR before main(), it is a no-op when it is not set
+static const uint32_t envErrors = []()
+{
+    const char *config = std::getenv(LOG_ENV_VAR);
+    uint32_t errors = (config == nullptr) ? 0U : Log::setLevels(config);
+
+    if (errors != 0U)
+    {
+        Log tmp;
+        LOG_WARNING(tmp, "Ignoring ", errors, " entries in ", LOG_ENV_VAR, "=\"", config, "\".");
+    }
+
+    return errors;
+}();
+
 /******************************************************************************/
 /*    IMPLEMENTATION                                                          */
 /******************************************************************************/
 
+bool Log::Site::sample(const Sample policy, const uint64_t n, uint64_t &report)
+{
+    const uint64_t limit = (n == 0U) ? 1U : n;
+    const uint64_t hit = this->hits.fetch_add(1U, std::memory_order_relaxed);
+    bool sampled = false;
+
+    switch (policy)
+    {
+        case Sample::EVERY_N:
+            sampled = (hit % limit) == 0U;
+            break;
+        case Sample::PER_SECOND:
+        {
+            const uint64_t now = Site::now();
+
+            // Racing threads may reset it twice, the limit is approximate
+            if (this->second.exchange(now, std::memory_order_relaxed) != now)
+            {
+                this->inSecond.store(0U, std::memory_order_relaxed);
+            }
+            sampled = this->inSecond.fetch_add(1U, std::memory_order_relaxed) < limit;
+            break;
+        }
+        case Sample::FIRST_N:
+        default:
+            sampled = hit < limit;
+            break;
+    }
+
+    if (sampled == false)
+    {
+        const uint64_t dropped = this->suppressed.fetch_add(1U, std::memory_order_relaxed) + 1U;
+        const uint64_t now = Site::now();
+        uint64_t last = this->reported.load(std::memory_order_relaxed);
+
+        // The first drop, then one per period, the CAS elects one reporter
+        if (((last == 0U) || (now >= last + LOG_SAMPLE_REPORT_S)) &&
+            this->reported.compare_exchange_strong(last, now, std::memory_order_relaxed))
+        {
+            report = dropped;
+        }
+    }
+
+    return sampled;
+}
+
+uint64_t Log::Site::now()
+{
+    using namespace std::chrono;
+
+    return duration_cast<seconds>(steady_clock::now().time_since_epoch()).count() + 1U;
+}
+
+uint32_t Log::setLevel(const Module module, const uint32_t level)
+{
+    // LOG_CONFIG is an upper bound, what is compiled out cannot be enabled
+    const uint32_t newLevel = (level < LOG_CONFIG) ? level : LOG_CONFIG;
+
+    if (module < Module::ALL)
+    {
+        levels[module].store(newLevel, std::memory_order_relaxed);
+    }
+    else
+    {
+        for (auto &moduleLevel : levels)
+        {
+            moduleLevel.store(newLevel, std::memory_order_relaxed);
+        }
+    }
+
+    return newLevel;
+}
+
+uint32_t Log::getLevel(const Module module)
+{
+    return (module < Module::ALL) ? levels[module].load(std::memory_order_relaxed) : LOG_CONFIG;
+}
+
+uint32_t Log::setLevels(const std::string &config)
+{
+    // Looking up a name in a table, size is returned when not found
+    auto lookUp = [](const char **table, const uint32_t size, const std::string &name)
+    {
+        uint32_t i = 0U;
+        while ((i < size) && (strcasecmp(table[i], name.c_str()) != 0))
+        {
+            i++;
+        }
+
+        return i;
+    };
+
+    uint32_t errors = 0U;
+    std::istringstream entries(config);
+    for (std::string entry; std::getline(entries, entry, ',');)
+    {
+        size_t equal = entry.find('=');
+        uint32_t module = Module::ALL;
+        uint32_t level = Level::FULL;
+
+        if (equal == std::string::npos)
+        {
+            // "LEVEL" applies to all modules
+            level = lookUp(levelName, Level::FULL, entry);
+        }
+        else
+        {
+            // "module=LEVEL" applies to one module
+            module = lookUp(moduleName, Module::ALL, entry.substr(0U, equal));
+            level = lookUp(levelName, Level::FULL, entry.substr(equal + 1U));
+            level = (module < Module::ALL) ? level : Level::FULL;
+        }
+
+        if (level < Level::FULL)
+        {
+            setLevel(static_cast<Module>(module), level);
+        }
+        else if (entry.empty() == false)
+        {
+            errors++;
+        }
+    }
+
+    return errors;
+}
+
 void Log::log()
 {
     *this << Log::MSG::ENDL;
@@ -11,6 +11,12 @@
 *       c) a set of macros conseal the main APIs to ease the use of this
 *          submodule.
 *
+*       d) Log::setLevel() and Log::setLevels() adjust the level of each
+*          module at runtime, LOG_CONFIG remains the compile-time ceiling.
+*
+*       e) LOG_EVERY_N(), LOG_PER_SECOND() and LOG_FIRST_N() sample the logs
+*          of a call site in hot loops, and report what they suppressed.
+*
 *******************************************************************************/
 
 #ifndef LEVELS_H_
@@ -20,6 +26,8 @@
 /*    INCLUDED FILES                                                          */
 /******************************************************************************/
 
+#include <atomic>
+#include <cstdint>
 #include <sstream>
 
 /******************************************************************************/
@@ -33,18 +41,37 @@
 #define LOG_LEVEL_DEBUG   (3U)
 #define LOG_LEVEL_TRACE   (4U)
 
+/* Set default module (if not previously defined), (sub)modules set their own */
+#ifndef LOG_MODULE
+    #define LOG_MODULE      Log::Module::LOG
+#endif
+
+/* Name of the environment variable read at start-up, i.e. "INFO,algebra=TRACE" */
+#define LOG_ENV_VAR   "LOG_LEVEL"
+
+/* Seconds between two reports of the messages a call site suppressed */
+#define LOG_SAMPLE_REPORT_S     (1U)
+
 /******************************************************************************/
 /*    PUBLIC MACROS                                                           */
 /******************************************************************************/
 
+/**
+ * @brief   Macro to check the runtime level of the current LOG_MODULE, it is
+ *          a single relaxed load, so disabled logs do not evaluate arguments.
+ */
+#define LOG_ENABLED(level) \
+    Log::isEnabled(LOG_MODULE, level)
+
 /**
  * @example    LOG_ERROR(logger, "error var i =", i);
  */
 #if LOG_LEVEL_ERROR <= LOG_CONFIG
     #define LOG_ERROR(LOGGER, ...) \
-        LOGGER.log(Log::Level::ERROR, __FILE__, ":", __LINE__, " ", Log::MSG::ENDC, Log::MSG::GRAY, __VA_ARGS__, Log::MSG::ENDC)
+        do { if (LOG_ENABLED(Log::Level::ERROR)) \
+            LOGGER.log(Log::Level::ERROR, __FILE__, ":", __LINE__, " ", Log::MSG::ENDC, Log::MSG::GRAY, __VA_ARGS__, Log::MSG::ENDC); } while (0)
 #else
-    #define LOG_ERROR(LOGGER, ...)
+    #define LOG_ERROR(LOGGER, ...) do {} while (0)
 #endif
 
 /**
@@ -52,9 +79,10 @@
  */
 #if LOG_LEVEL_WARNING <= LOG_CONFIG
     #define LOG_WARNING(LOGGER, ...) \
-        LOGGER.log(Log::Level::WARNING, __FILE__, ":", __LINE__, " ", Log::MSG::ENDC, Log::MSG::GRAY, __VA_ARGS__, Log::MSG::ENDC)
+        do { if (LOG_ENABLED(Log::Level::WARNING)) \
+            LOGGER.log(Log::Level::WARNING, __FILE__, ":", __LINE__, " ", Log::MSG::ENDC, Log::MSG::GRAY, __VA_ARGS__, Log::MSG::ENDC); } while (0)
 #else
-    #define LOG_WARNING(LOGGER, ...)
+    #define LOG_WARNING(LOGGER, ...) do {} while (0)
 #endif
 
 /**
@@ -62,9 +90,10 @@
  */
 #if LOG_LEVEL_INFO <= LOG_CONFIG
     #define LOG_INFO(LOGGER, ...) \
-        LOGGER.log(Log::Level::INFO, __FILE__, ":", __LINE__, " ", Log::MSG::ENDC, Log::MSG::GRAY, __VA_ARGS__, Log::MSG::ENDC)
+        do { if (LOG_ENABLED(Log::Level::INFO)) \
+            LOGGER.log(Log::Level::INFO, __FILE__, ":", __LINE__, " ", Log::MSG::ENDC, Log::MSG::GRAY, __VA_ARGS__, Log::MSG::ENDC); } while (0)
 #else
-    #define LOG_INFO(LOGGER, ...)
+    #define LOG_INFO(LOGGER, ...) do {} while (0)
 #endif
 
 /**
@@ -72,9 +101,10 @@
  */
 #if LOG_LEVEL_DEBUG <= LOG_CONFIG
     #define LOG_DEBUG(LOGGER, ...) \
-        LOGGER.log(Log::Level::DEBUG, __FILE__, ":", __LINE__, " ", Log::MSG::ENDC, Log::MSG::GRAY, __VA_ARGS__, Log::MSG::ENDC)
+        do { if (LOG_ENABLED(Log::Level::DEBUG)) \
+            LOGGER.log(Log::Level::DEBUG, __FILE__, ":", __LINE__, " ", Log::MSG::ENDC, Log::MSG::GRAY, __VA_ARGS__, Log::MSG::ENDC); } while (0)
 #else
-    #define LOG_DEBUG(LOGGER, ...)
+    #define LOG_DEBUG(LOGGER, ...) do {} while (0)
 #endif
 
 /**
@@ -82,11 +112,42 @@
  */
 #if LOG_LEVEL_TRACE <= LOG_CONFIG
     #define LOG_TRACE(LOGGER, ...) \
-        LOGGER.log(Log::Level::TRACE, __FILE__, ":", __LINE__, " ", Log::MSG::ENDC, Log::MSG::GRAY, __VA_ARGS__, Log::MSG::ENDC)
+        do { if (LOG_ENABLED(Log::Level::TRACE)) \
+            LOGGER.log(Log::Level::TRACE, __FILE__, ":", __LINE__, " ", Log::MSG::ENDC, Log::MSG::GRAY, __VA_ARGS__, Log::MSG::ENDC); } while (0)
 #else
-    #define LOG_TRACE(LOGGER, ...)
+    #define LOG_TRACE(LOGGER, ...) do {} while (0)
 #endif
 
+/**
+ * @brief   Macro to log only when the call site is sampled, the suppressed
+ *          messages are reported at the first drop, then at most once every
+ *          LOG_SAMPLE_REPORT_S seconds.
+ */
+#define LOG_SAMPLED(LEVEL, LOGGER, POLICY, N, ...) \
+    do { if ((Log::Level::LEVEL <= LOG_CONFIG) && LOG_ENABLED(Log::Level::LEVEL)) { \
+        static Log::Site site; \
+        uint64_t suppressed = 0U; \
+        if (site.sample(POLICY, N, suppressed)) { LOG_##LEVEL(LOGGER, __VA_ARGS__); } \
+        if (suppressed != 0U) { LOG_##LEVEL(LOGGER, suppressed, " messages suppressed so far."); } } } while (0)
+
+/**
+ * @example    LOG_EVERY_N(TRACE, logger, 1000U, "C[", i, ",", j, "] = ", c);
+ */
+#define LOG_EVERY_N(LEVEL, LOGGER, N, ...) \
+    LOG_SAMPLED(LEVEL, LOGGER, Log::Sample::EVERY_N, N, __VA_ARGS__)
+
+/**
+ * @example    LOG_PER_SECOND(DEBUG, logger, 10U, "Pivot in row ", row);
+ */
+#define LOG_PER_SECOND(LEVEL, LOGGER, N, ...) \
+    LOG_SAMPLED(LEVEL, LOGGER, Log::Sample::PER_SECOND, N, __VA_ARGS__)
+
+/**
+ * @example    LOG_FIRST_N(WARNING, logger, 3U, "Matrix is singular.");
+ */
+#define LOG_FIRST_N(LEVEL, LOGGER, N, ...) \
+    LOG_SAMPLED(LEVEL, LOGGER, Log::Sample::FIRST_N, N, __VA_ARGS__)
+
 /******************************************************************************/
 /*    API                                                                     */
 /******************************************************************************/
@@ -113,6 +174,52 @@ struct Log: public std::ostringstream
         ENDL
     };
 
+    // ALL is the number of modules and it selects every module at once.
+    enum Module: uint32_t
+    {
+        ALGEBRA = 0U,
+        MEMORY,
+        LOG,
+        ALL
+    };
+
+    enum Sample: uint32_t
+    {
+        EVERY_N = 0U,
+        PER_SECOND,
+        FIRST_N
+    };
+
+    // State of a sampled call site, one static instance per LOG_SAMPLED().
+    struct Site
+    {
+        std::atomic<uint64_t> hits{0U};
+        std::atomic<uint64_t> suppressed{0U};
+        std::atomic<uint64_t> second{0U};
+        std::atomic<uint64_t> inSecond{0U};
+        std::atomic<uint64_t> reported{0U};
+
+        // n = 0 is taken as n = 1, report is set to the drops so far when a
+        // report is due, at the first drop and then once per period.
+        bool sample(const Sample policy, const uint64_t n, uint64_t &report);
+        // Monotonic seconds offset by one, zero is the initial "no second yet"
+        static uint64_t now();
+    };
+
+    // Runtime level per module, every module starts at the compile-time ceiling.
+    static inline std::atomic<uint32_t> levels[Module::ALL] = {LOG_CONFIG, LOG_CONFIG, LOG_CONFIG};
+
+    static bool isEnabled(const Module module, const uint32_t level)
+    {
+        return level <= levels[module].load(std::memory_order_relaxed);
+    }
+
+    // The level is clipped to LOG_CONFIG, it returns the level actually set.
+    static uint32_t setLevel(const Module module, const uint32_t level);
+    static uint32_t getLevel(const Module module);
+    // "WARNING,algebra=DEBUG", it returns the number of entries not understood.
+    static uint32_t setLevels(const std::string &config);
+
     // This is horrible, templates cannot be split into hpp/cpp files
     template<typename T, typename... Args>
     void log(const T& first, const Args&... args)
@@ -0,0 +1,182 @@
+/******************************************************************************/
+/*    INCLUDED FILES                                                          */
+/******************************************************************************/
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+#include <unistd.h>
+
+#include "trace.hpp"
+
+/******************************************************************************/
+/*    PRIVATE DATA                                                            */
+/******************************************************************************/
+
+// Spans of a thread, its mutex is only contended while dumping
+struct Buffer
+{
+    std::mutex mutex;
+    std::vector<Trace::Event> events;
+    uint32_t tid;
+
+    Buffer();
+    ~Buffer();
+};
+
+static std::mutex buffersMutex;
+static std::vector<Buffer*> buffers;
+// Spans of the threads that are gone
+static std::vector<Trace::Event> retired;
+static uint32_t threads = 0U;
+
+// Origin of the timestamps, to convert ticks into microseconds
+static const uint64_t originTicks = Trace::now();
+static const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+
+// Writing TRACE_ENV_VAR at exit, it is a no-op when it is not set
+static const bool atExit = []()
+{
+    if (std::getenv(TRACE_ENV_VAR) != nullptr)
+    {
+        std::atexit([]() { Trace::save(std::getenv(TRACE_ENV_VAR)); });
+    }
+
+    return true;
+}();
+
+/******************************************************************************/
+/*    PRIVATE FUNCTIONS                                                       */
+/******************************************************************************/
+
+Buffer::Buffer()
+{
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    this->tid = ++threads;
+    buffers.push_back(this);
+}
+
+Buffer::~Buffer()
+{
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    retired.insert(retired.end(), this->events.cbegin(), this->events.cend());
+    for (auto buffer = buffers.begin(); buffer != buffers.end(); buffer++)
+    {
+        if (*buffer == this)
+        {
+            buffers.erase(buffer);
+            break;
+        }
+    }
+}
+
+static Buffer& getBuffer()
+{
+    static thread_local Buffer buffer;
+    return buffer;
+}
+
+// Ticks per microsecond since the origin
+static double getRate()
+{
+    const uint64_t ticks = Trace::now() - originTicks;
+    const auto elapsed = std::chrono::steady_clock::now() - origin;
+    const double us = std::chrono::duration<double, std::micro>(elapsed).count();
+
+    return ((ticks == 0U) || (us <= 0.0)) ? 1.0 : static_cast<double>(ticks) / us;
+}
+
+static void writeEvent(std::ostream &os, const Trace::Event &event, const double rate, const bool first)
+{
+    os << (first ? "\n" : ",\n") << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":" << getpid()
+       << ",\"tid\":" << event.tid << ",\"ts\":" << static_cast<double>(event.begin - originTicks) / rate
+       << ",\"dur\":" << static_cast<double>(event.end - event.begin) / rate << ",\"args\":{";
+    for (uint32_t i = 0U; i < event.count; i++)
+    {
+        os << ((i == 0U) ? "" : ",") << "\"" << event.keys[i] << "\":" << event.values[i];
+    }
+    os << "}}";
+}
+
+/******************************************************************************/
+/*    IMPLEMENTATION                                                          */
+/******************************************************************************/
+
+void Trace::record(const Event &event)
+{
+    Buffer &buffer = getBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+
+    buffer.events.push_back(event);
+    buffer.events.back().tid = buffer.tid;
+}
+
+void Trace::dump(std::ostream &os)
+{
+    const double rate = getRate();
+    bool first = true;
+
+    const std::ios_base::fmtflags flags = os.flags();
+    const std::streamsize precision = os.precision();
+    os << std::fixed;
+    os.precision(3);
+
+    os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    for (const Event &event : retired)
+    {
+        writeEvent(os, event, rate, first);
+        first = false;
+    }
+    for (Buffer *buffer : buffers)
+    {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        for (const Event &event : buffer->events)
+        {
+            writeEvent(os, event, rate, first);
+            first = false;
+        }
+    }
+    os << "\n]}\n";
+
+    os.flags(flags);
+    os.precision(precision);
+}
+
+bool Trace::save(const std::string &filename)
+{
+    std::ofstream file(filename);
+
+    Trace::dump(file);
+
+    return file.good();
+}
+
+uint64_t Trace::size()
+{
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    uint64_t count = retired.size();
+
+    for (Buffer *buffer : buffers)
+    {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        count += buffer->events.size();
+    }
+
+    return count;
+}
+
+void Trace::clear()
+{
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    retired.clear();
+
+    for (Buffer *buffer : buffers)
+    {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        buffer->events.clear();
+    }
+}
@@ -0,0 +1,141 @@
+/*******************************************************************************
+*
+* LOGGING SYSTEM - trace submodule
+*
+*   SUMMARY
+*       This submodule records spans, the time between the construction and
+*       the destruction of a Trace::Span, to read them in chrome://tracing or
+*       Perfetto.
+*
+*       a) TRACE_SPAN(name, "key", value, ...) opens a span until the end of
+*          the block, with up to TRACE_ARGS integer arguments. The macro is
+*          empty unless the build sets TRACE_SPANS (cmake -DTRACE_SPANS=ON),
+*          its arguments are not even evaluated. Without it trace.cpp is not
+*          compiled either, so nothing runs at start-up or at exit.
+*
+*       b) spans are appended to a buffer of their thread, timestamps are
+*          ticks of the TSC (CNTVCT_EL0 on arm64), converted to microseconds
+*          when they are written.
+*
+*       c) Trace::dump() writes the Chrome trace JSON, "X" events per span.
+*          When TRACE_ENV_VAR names a file, it is written at exit.
+*
+*******************************************************************************/
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+/******************************************************************************/
+/*    INCLUDED FILES                                                          */
+/******************************************************************************/
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/******************************************************************************/
+/*    DEFINITIONS                                                             */
+/******************************************************************************/
+
+#ifndef TRACE_SPANS
+    #define TRACE_SPANS 0
+#endif
+
+/* Integer arguments per span */
+#define TRACE_ARGS      (4U)
+
+/* Name of the environment variable with the file written at exit */
+#define TRACE_ENV_VAR   "TRACE_FILE"
+
+/******************************************************************************/
+/*    PUBLIC MACROS                                                           */
+/******************************************************************************/
+
+/**
+ * @example    TRACE_SPAN("operator*", "rows", A.rows, "cols", B.cols);
+ */
+#if TRACE_SPANS
+    #define TRACE_SPAN(...) \
+        Trace::Span traceSpan(__VA_ARGS__)
+#else
+    #define TRACE_SPAN(...) do {} while (0)
+#endif
+
+/******************************************************************************/
+/*    API                                                                     */
+/******************************************************************************/
+
+struct Trace
+{
+    // A closed span, names and keys are string literals
+    struct Event
+    {
+        const char *name;
+        uint64_t   begin;
+        uint64_t   end;
+        uint32_t   tid;
+        uint32_t   count;
+        const char *keys[TRACE_ARGS];
+        uint64_t   values[TRACE_ARGS];
+    };
+
+    struct Span
+    {
+        template<typename... Args>
+        explicit Span(const char *name, const Args&... args)
+        {
+            static_assert(sizeof...(args) <= 2U * TRACE_ARGS, "Too many arguments in a span.");
+            this->event.name = name;
+            this->event.count = 0U;
+            this->setArgs(args...);
+            this->event.begin = Trace::now();
+        }
+
+        ~Span()
+        {
+            this->event.end = Trace::now();
+            Trace::record(this->event);
+        }
+
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+    private:
+        Event event;
+
+        void setArgs() {}
+
+        template<typename T, typename... Args>
+        void setArgs(const char *key, const T &value, const Args&... args)
+        {
+            this->event.keys[this->event.count] = key;
+            this->event.values[this->event.count] = static_cast<uint64_t>(value);
+            this->event.count++;
+            this->setArgs(args...);
+        }
+    };
+
+    // Ticks of the timestamp counter
+    static uint64_t now()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+        uint64_t ticks;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+        return ticks;
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    static void record(const Event &event);
+    // Spans of every thread, dump() expects no span to be closing meanwhile
+    static void dump(std::ostream &os);
+    static bool save(const std::string &filename);
+    static uint64_t size();
+    static void clear();
+};
+
+#endif /* TRACE_H_ */
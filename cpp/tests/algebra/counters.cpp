@@ -0,0 +1,76 @@
+/******************************************************************************/
+/*    INCLUDED FILES                                                          */
+/******************************************************************************/
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <vector>
+/* TARGET LIBRARY */
+#include "counters.hpp"
+#include "matrix.hpp"
+
+/******************************************************************************/
+/*    TEST CASES                                                              */
+/******************************************************************************/
+
+TEST(Counters, getBucket)
+{
+    ASSERT_EQ(0U, Counters::getBucket(0U));
+    ASSERT_EQ(1U, Counters::getBucket(1U));
+    ASSERT_EQ(2U, Counters::getBucket(3U));
+    ASSERT_EQ(11U, Counters::getBucket(1024U));
+    ASSERT_EQ(64U, Counters::getBucket(UINT64_MAX));
+}
+
+TEST(Counters, scope)
+{
+    Counters::reset();
+    {
+        Counters::Scope outer("kernel", 100U);
+        // Nested scopes of the same kernel are not counted
+        Counters::Scope inner("kernel", 100U);
+
+        // Touching fresh pages
+        std::vector<char> pages(4U * 1024U * 1024U, 1);
+        ASSERT_EQ(1, pages.back());
+    }
+    {
+        Counters::Scope other("kernel", 100U);
+    }
+
+    const Counters::Snapshot snap = Counters::snapshot();
+    ASSERT_EQ(1U, snap.size());
+
+    const Counters::Sample &sample = snap.at({"kernel", 7U});
+    ASSERT_EQ(2U, sample.calls);
+    ASSERT_LT(0U, sample.ns);
+    if (sample.counted[Counters::Event::PAGE_FAULTS])
+    {
+        ASSERT_LT(0U, sample.events[Counters::Event::PAGE_FAULTS]);
+    }
+
+    std::ostringstream os;
+    Counters::report(os);
+    ASSERT_NE(std::string::npos, os.str().find("kernel"));
+    Counters::reset();
+}
+
+TEST(Counters, kernels)
+{
+#if !PERF_COUNTERS
+    GTEST_SKIP() << "The kernels are instrumented with -DPERF_COUNTERS=ON.";
+#endif
+    Matrix A(8U, 8U);
+    Matrix B(8U, 8U);
+
+    Counters::reset();
+    Matrix *C = A * B;
+    A.transpose();
+
+    const Counters::Snapshot snap = Counters::snapshot();
+    ASSERT_EQ(1U, snap.count({"operator*", Counters::getBucket(8U * 8U * 8U)}));
+    ASSERT_EQ(1U, snap.count({"transpose", Counters::getBucket(8U * 8U)}));
+
+    delete C;
+    Counters::reset();
+}
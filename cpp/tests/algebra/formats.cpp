@@ -0,0 +1,143 @@
+/******************************************************************************/
+/*    INCLUDED FILES                                                          */
+/******************************************************************************/
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+/* TARGET LIBRARY */
+#include "formats.hpp"
+
+/******************************************************************************/
+/*    TEST CASES                                                              */
+/******************************************************************************/
+
+TEST(formats, npy)
+{
+    Matrix A({1.5F, -2.0F, 0.1F, 4.0F, 5.0F, 6.25F});
+    A.reshape(2U, 3U);
+
+    ASSERT_TRUE(saveNpy(A, "A.npy"));
+    // The values start at a 64-byte boundary, numpy can map them
+    std::ifstream file("A.npy", std::ios::binary | std::ios::ate);
+    ASSERT_EQ(0U, (static_cast<size_t>(file.tellg()) - sizeof(float) * 6U) % 64U);
+
+    Matrix *B = loadNpy("A.npy");
+    ASSERT_NE(nullptr, B);
+    ASSERT_EQ(2U, B->rows);
+    ASSERT_EQ(3U, B->cols);
+    ASSERT_TRUE(A == *B);
+
+    delete B;
+    std::remove("A.npy");
+    ASSERT_EQ(nullptr, loadNpy("missing.npy"));
+}
+
+TEST(formats, npyFortranDouble)
+{
+    // As numpy.asfortranarray(numpy.array([[1., 2., 3.], [4., 5., 6.]]))
+    const char header[] = "{'descr': '<f8', 'fortran_order': True, 'shape': (2, 3), }";
+    const double val[6U] = {1.0, 4.0, 2.0, 5.0, 3.0, 6.0};
+    std::string padded(header);
+    padded.append(128U - 10U - padded.size() - 1U, ' ');
+    padded.push_back('\n');
+
+    std::ofstream file("F.npy", std::ios::binary);
+    file.write("\x93NUMPY\x01\x00", 8U);
+    file.put(static_cast<char>(padded.size()));
+    file.put(0);
+    file << padded;
+    file.write(reinterpret_cast<const char*>(val), sizeof(val));
+    file.close();
+
+    Matrix *A = loadNpy("F.npy");
+    ASSERT_NE(nullptr, A);
+    Matrix B({1, 2, 3, 4, 5, 6});
+    B.reshape(2U, 3U);
+    ASSERT_TRUE(*A == B);
+
+    delete A;
+    std::remove("F.npy");
+}
+
+TEST(formats, mtx)
+{
+    Matrix A({1.5F, 0.0F, 0.1F, 0.0F, 5.0F, -6.25F});
+    A.reshape(3U, 2U);
+
+    // Dense and sparse, both read back into the same Matrix
+    ASSERT_TRUE(saveMtx(A, "A.mtx"));
+    Matrix *B = loadMtx("A.mtx");
+    ASSERT_NE(nullptr, B);
+    ASSERT_TRUE(A == *B);
+    delete B;
+
+    ASSERT_TRUE(saveMtx(A, "A.mtx", true));
+    B = loadMtx("A.mtx");
+    ASSERT_NE(nullptr, B);
+    ASSERT_TRUE(A == *B);
+    delete B;
+
+    std::remove("A.mtx");
+    ASSERT_EQ(nullptr, loadMtx("missing.mtx"));
+}
+
+TEST(formats, mtxSymmetric)
+{
+    std::ofstream file("S.mtx");
+    file << "%%MatrixMarket matrix coordinate real symmetric\n"
+         << "% lower triangle only\n"
+         << "3 3 4\n"
+         << "1 1 2.0\n2 1 -1\n3 2 +1e-1\n3 3 4\n";
+    file.close();
+
+    Matrix *A = loadMtx("S.mtx");
+    ASSERT_NE(nullptr, A);
+    Matrix B({2.0F, -1.0F, 0.0F, -1.0F, 0.0F, 0.1F, 0.0F, 0.1F, 4.0F});
+    B.reshape(3U, 3U);
+    ASSERT_TRUE(*A == B);
+    delete A;
+
+    // Missing entries and out of bounds indices are rejected
+    file.open("S.mtx");
+    file << "%%MatrixMarket matrix coordinate real general\n3 3 2\n1 1 2.0\n4 1 -1\n";
+    file.close();
+    ASSERT_EQ(nullptr, loadMtx("S.mtx"));
+
+    file.open("S.mtx");
+    file << "%%MatrixMarket matrix array real general\n2 2\n1\n2\n3\n";
+    file.close();
+    ASSERT_EQ(nullptr, loadMtx("S.mtx"));
+
+    // The mirror of (1, 3) would be past the end of a 2 x 3 matrix
+    for (const char *symmetry : {"symmetric", "skew-symmetric"})
+    {
+        file.open("S.mtx");
+        file << "%%MatrixMarket matrix coordinate real " << symmetry << "\n2 3 1\n1 3 1.0\n";
+        file.close();
+        ASSERT_EQ(nullptr, loadMtx("S.mtx"));
+    }
+
+    std::remove("S.mtx");
+}
+
+TEST(formats, mtxParallel)
+{
+    // Large enough to be split in several chunks
+    Matrix A(300U, 200U);
+    for (uint32_t i = 0U; i < A.val.size(); i++)
+    {
+        A.val[i] = static_cast<float>(i) / 7.0F;
+    }
+
+    ASSERT_TRUE(saveMtx(A, "P.mtx"));
+    for (uint32_t threads : {1U, 3U, 8U})
+    {
+        Matrix *B = loadMtx("P.mtx", threads);
+        ASSERT_NE(nullptr, B);
+        ASSERT_TRUE(A == *B);
+        delete B;
+    }
+
+    std::remove("P.mtx");
+}
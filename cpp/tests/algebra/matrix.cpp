@@ -3,6 +3,9 @@
 /******************************************************************************/
 
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <limits>
+#include <sstream>
 /* TARGET LIBRARY */
 #include "matrix.hpp"
 
@@ -258,6 +261,57 @@ TEST(Matrix, log)
     B.log("C");
 }
 
+TEST(Matrix, logSummary)
+{
+    Matrix A(40U, 30U);
+    for (uint32_t i = 0U; i < A.val.size(); i++)
+    {
+        A.val[i] = static_cast<float>(i);
+    }
+    A.val[1U] = std::numeric_limits<float>::quiet_NaN();
+    A.name = "A";
+
+    Matrix::Stats stats = A.stats();
+    ASSERT_EQ(0.0F, stats.min);
+    ASSERT_EQ(1199.0F, stats.max);
+    ASSERT_DOUBLE_EQ((1199.0 * 1200.0 / 2.0 - 1.0) / 1199.0, stats.mean);
+    ASSERT_EQ(1U, stats.nan);
+
+    // Header, logEdge rows, "...", logEdge rows
+    std::ostringstream os;
+    A.log(os);
+    std::string summary = os.str();
+    ASSERT_EQ(2U * Matrix::logEdge + 2U, std::count(summary.begin(), summary.end(), '\n'));
+    ASSERT_NE(std::string::npos, summary.find("A in [40x30]"));
+    ASSERT_NE(std::string::npos, summary.find("NaN = 1"));
+    // a(0,2) and a(39,29) are printed, a(0,3) and a(20,0) are not
+    ASSERT_NE(std::string::npos, summary.find("  2.000000"));
+    ASSERT_NE(std::string::npos, summary.find("1199.000000"));
+    ASSERT_EQ(std::string::npos, summary.find("  3.000000"));
+    ASSERT_EQ(std::string::npos, summary.find("600.000000"));
+    // os is left as it was
+    ASSERT_FALSE(os.flags() & std::ios_base::fixed);
+
+    // Small matrices are printed in full, without the header
+    Matrix B({1, 2, 3, 4});
+    B.reshape(2U, 2U);
+    std::ostringstream os2;
+    B.log(os2);
+    std::string full = os2.str();
+    ASSERT_EQ(2U, std::count(full.begin(), full.end(), '\n'));
+    ASSERT_EQ(std::string::npos, full.find("..."));
+
+    // Only the long dimension is skipped, a wide matrix keeps all its rows
+    Matrix C(2U * Matrix::logEdge + 2U, Matrix::logLimit + 1U);
+    C.name = "C";
+    std::ostringstream os3;
+    C.log(os3);
+    std::string wide = os3.str();
+    ASSERT_EQ(C.rows + 1U, std::count(wide.begin(), wide.end(), '\n'));
+    ASSERT_NE(std::string::npos, wide.find("..."));
+    LOG_MATRIX(A);
+}
+
 TEST(Matrix, rowPermute)
 {
     Matrix A({1,2,3,4,5,0,2,2,2,2,0,3,3,3,3,0,4,4,4,4,5,5,5,5,5});
@@ -293,3 +347,25 @@ TEST(Matrix, rowReduction)
     ASSERT_EQ(U.val, LiPA->val);
     delete LiPA;
 }
+
+TEST(Matrix, memoryStats)
+{
+    Matrix A(4U, 4U);
+    Matrix B(4U, 4U);
+    const MemoryStats before = Matrix::memoryStats();
+
+    Matrix *C = A * B;
+    const MemoryStats during = Matrix::memoryStats();
+    ASSERT_EQ(before.allocations + 1U, during.allocations);
+    ASSERT_EQ(before.live + 1U, during.live);
+    ASSERT_LT(before.sites.count("operator*") ? before.sites.at("operator*") : 0U,
+              during.sites.at("operator*"));
+    ASSERT_LE(before.retained + sizeof(Matrix) + 16U * sizeof(float), during.retained);
+
+    delete C;
+    const MemoryStats after = Matrix::memoryStats();
+    ASSERT_EQ(before.frees + 1U, after.frees);
+    ASSERT_EQ(before.live, after.live);
+    ASSERT_EQ(before.bytes, after.bytes);
+    ASSERT_EQ(before.retained, after.retained);
+}
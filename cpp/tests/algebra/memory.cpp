@@ -2,7 +2,10 @@
 /*    INCLUDED FILES                                                          */
 /******************************************************************************/
 
+#include <cstdlib>
 #include <gtest/gtest.h>
+#include <thread>
+#include <vector>
 /* TARGET LIBRARY */
 #include "memory.hpp"
 
@@ -24,7 +27,9 @@ public:
 
         for (uint32_t i = 0U; i < 32U; i++)
         {
-            void *pInt = new int(i);
+            // clean() frees with std::free(), as Matrix::operator new mallocs
+            int *pInt = static_cast<int*>(std::malloc(sizeof(int)));
+            *pInt = static_cast<int>(i);
             LOG_DEBUG(manager.logMemory, "push_back(", pInt, ")");
             manager.push_back(pInt);
         }
@@ -44,3 +49,40 @@ TEST_F(DummyList, clean)
     ASSERT_EQ(manager.empty(), true);
     ASSERT_EQ(manager.size(), 0U);
 }
+
+TEST(MemoryStats, counted)
+{
+    const MemoryStats before = MemoryStats::query();
+    {
+        MEMORY_SITE("counted");
+        std::vector<float, Counted<float>> buffer(256U);
+        const MemoryStats during = MemoryStats::query();
+
+        ASSERT_EQ(before.buffers + 1U, during.buffers);
+        ASSERT_EQ(before.bytes + 256U * sizeof(float), during.bytes);
+        ASSERT_LE(during.bytes, during.peak);
+        ASSERT_EQ(1U, during.sites.at("counted"));
+    }
+    const MemoryStats after = MemoryStats::query();
+
+    ASSERT_EQ(before.bytes, after.bytes);
+    ASSERT_LE(before.bytes + 256U * sizeof(float), after.peak);
+}
+
+TEST(MemoryStats, threads)
+{
+    const MemoryStats before = MemoryStats::query();
+
+    // Counts of finished threads are kept
+    std::thread worker([]()
+    {
+        MemoryStats::countAllocation();
+        MemoryStats::countFree();
+    });
+    worker.join();
+    const MemoryStats after = MemoryStats::query();
+
+    ASSERT_EQ(before.allocations + 1U, after.allocations);
+    ASSERT_EQ(before.frees + 1U, after.frees);
+    ASSERT_EQ(before.live, after.live);
+}
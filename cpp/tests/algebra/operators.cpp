@@ -121,6 +121,50 @@ TEST(operators, multiply)
     delete E;
 }
 
+TEST(operators, gemm)
+{
+    Matrix A({1,2,3,4,5,6});
+    A.reshape(2U, 3U);
+    Matrix B({1,0,2,-1,0,1});
+    B.reshape(3U, 2U);
+    Matrix *AB = A * B;
+    LOG_MATRIX(*AB);
+
+    // C := 2 A B + C
+    Matrix C({1,1,1,1});
+    C.reshape(2U, 2U);
+    ASSERT_EQ(&C, gemm(BLAS_NO_TRANS, BLAS_NO_TRANS, 2.0F, A, B, 1.0F, C));
+    LOG_MATRIX(C);
+    for (size_t i = 0U; i < C.val.size(); i++)
+    {
+        ASSERT_EQ(2.0F * AB->val[i] + 1.0F, C.val[i]);
+    }
+
+    // the same product from the transposes, C is overwritten when beta is 0
+    Matrix AT(A), BT(B);
+    AT.transpose();
+    BT.transpose();
+    ASSERT_EQ(&C, gemm(BLAS_TRANS, BLAS_NO_TRANS, 1.0F, AT, B, 0.0F, C));
+    ASSERT_EQ(*AB, C);
+    ASSERT_EQ(&C, gemm(BLAS_NO_TRANS, BLAS_TRANS, 1.0F, A, BT, 0.0F, C));
+    ASSERT_EQ(*AB, C);
+    ASSERT_EQ(&C, gemm(BLAS_TRANS, BLAS_TRANS, 1.0F, AT, BT, 0.0F, C));
+    ASSERT_EQ(*AB, C);
+
+    // Gram matrix A^T A is 3x3
+    Matrix G(3U, 3U);
+    ASSERT_EQ(&G, gemm(BLAS_TRANS, BLAS_NO_TRANS, 1.0F, A, A, 0.0F, G));
+    Matrix *ATA = AT * A;
+    ASSERT_EQ(*ATA, G);
+
+    // sizes that do not match
+    ASSERT_EQ(nullptr, gemm(BLAS_NO_TRANS, BLAS_NO_TRANS, 1.0F, A, A, 0.0F, C));
+    ASSERT_EQ(nullptr, gemm(BLAS_NO_TRANS, BLAS_NO_TRANS, 1.0F, A, B, 0.0F, G));
+
+    delete AB;
+    delete ATA;
+}
+
 TEST(operators, scalar)
 {
     Matrix B({1,2,3,4,5,6,7,8});
@@ -230,3 +274,29 @@ TEST(operators, echelon)
     ASSERT_EQ(nullptr, U);
     delete U;
 }
+
+TEST(operators, solve)
+{
+    // case with permutation, x = (1, 2, 3)
+    Matrix A({0,2,1,1,1,1,2,1,3});
+    A.reshape(3U, 3U);
+    LOG_MATRIX(A);
+    Matrix b({7,6,13});
+    b.reshape(3U, 1U);
+    Matrix *x = A.solve(b);
+    ASSERT_NE(nullptr, x);
+    LOG_MATRIX(*x);
+    ASSERT_EQ(3U, x->rows);
+    ASSERT_EQ(1U, x->cols);
+    ASSERT_NEAR(1.0F, x->val[0], 1e-5F);
+    ASSERT_NEAR(2.0F, x->val[1], 1e-5F);
+    ASSERT_NEAR(3.0F, x->val[2], 1e-5F);
+    delete x;
+
+    // singular case
+    Matrix B({1,2,2,4});
+    B.reshape(2U, 2U);
+    Matrix c({1,2});
+    c.reshape(2U, 1U);
+    ASSERT_EQ(nullptr, B.solve(c));
+}
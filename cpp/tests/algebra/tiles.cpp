@@ -0,0 +1,57 @@
+/******************************************************************************/
+/*    INCLUDED FILES                                                          */
+/******************************************************************************/
+
+#include <gtest/gtest.h>
+#include <cstdio>
+/* TARGET LIBRARY */
+#include "formats.hpp"
+#include "tiles.hpp"
+
+/******************************************************************************/
+/*    TEST CASES                                                              */
+/******************************************************************************/
+
+TEST(tiles, tileSize)
+{
+    // 6 tiles of 16x16 floats
+    ASSERT_EQ(16U, tileSize(6U * 16U * 16U * sizeof(float)));
+    ASSERT_EQ(1U, tileSize(0U));
+}
+
+TEST(tiles, multiplyFiles)
+{
+    Matrix A(37U, 23U);
+    Matrix B(23U, 29U);
+    for (uint32_t i = 0U; i < A.val.size(); i++)
+    {
+        A.val[i] = static_cast<float>(i % 11U) - 5.0F;
+    }
+    for (uint32_t i = 0U; i < B.val.size(); i++)
+    {
+        B.val[i] = static_cast<float>(i % 7U) * 0.5F;
+    }
+    ASSERT_TRUE(saveNpy(A, "A.npy"));
+    ASSERT_TRUE(saveNpy(B, "B.npy"));
+
+    // 6x6 tiles, with partial tiles on every edge
+    ASSERT_TRUE(multiplyFiles("A.npy", "B.npy", "C.npy", 6U * 6U * 6U * sizeof(float)));
+    Matrix *C = loadNpy("C.npy");
+    Matrix *expected = A * B;
+    ASSERT_NE(nullptr, C);
+    ASSERT_EQ(37U, C->rows);
+    ASSERT_EQ(29U, C->cols);
+    for (uint32_t i = 0U; i < C->val.size(); i++)
+    {
+        ASSERT_NEAR(expected->val[i], C->val[i], 1e-3F);
+    }
+
+    // Inner dimensions do not match
+    ASSERT_FALSE(multiplyFiles("A.npy", "A.npy", "C.npy", 1024U));
+
+    delete C;
+    delete expected;
+    std::remove("A.npy");
+    std::remove("B.npy");
+    std::remove("C.npy");
+}
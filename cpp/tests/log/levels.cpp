@@ -81,3 +81,104 @@ TEST_F(Verbose, trace)
     ASSERT_EQ(this->expected.str(), trace.str());
 }
 #endif
+
+TEST(Levels, setLevel)
+{
+    ASSERT_EQ(LOG_CONFIG, Log::getLevel(Log::Module::ALGEBRA));
+    ASSERT_EQ(LOG_LEVEL_ERROR, Log::setLevel(Log::Module::ALGEBRA, LOG_LEVEL_ERROR));
+    ASSERT_EQ(LOG_LEVEL_ERROR, Log::getLevel(Log::Module::ALGEBRA));
+    ASSERT_EQ(LOG_CONFIG, Log::getLevel(Log::Module::MEMORY));
+    ASSERT_FALSE(Log::isEnabled(Log::Module::ALGEBRA, Log::Level::WARNING));
+
+    // LOG_CONFIG is the ceiling
+    ASSERT_EQ(LOG_CONFIG, Log::setLevel(Log::Module::ALL, Log::Level::FULL + 10U));
+    for (uint32_t module = 0U; module < Log::Module::ALL; module++)
+    {
+        ASSERT_EQ(LOG_CONFIG, Log::getLevel(static_cast<Log::Module>(module)));
+    }
+}
+
+TEST(Levels, setLevels)
+{
+    // "bogus=INFO" and "memory=LOUD" are not understood
+    ASSERT_EQ(2U, Log::setLevels("warning,algebra=ERROR,bogus=INFO,memory=LOUD"));
+    ASSERT_EQ(LOG_LEVEL_ERROR, Log::getLevel(Log::Module::ALGEBRA));
+    // Clipped by LOG_CONFIG when it is LOG_LEVEL_ERROR
+    ASSERT_EQ(std::min(LOG_LEVEL_WARNING, LOG_CONFIG), Log::getLevel(Log::Module::MEMORY));
+    ASSERT_EQ(Log::getLevel(Log::Module::MEMORY), Log::getLevel(Log::Module::LOG));
+
+    ASSERT_EQ(0U, Log::setLevels(""));
+    ASSERT_EQ(0U, Log::setLevels("TRACE"));
+    ASSERT_EQ(LOG_CONFIG, Log::getLevel(Log::Module::ALGEBRA));
+}
+
+TEST(Levels, disabled)
+{
+    Log disabled;
+    uint32_t counter = 0U;
+
+    Log::setLevel(Log::Module::ALL, LOG_LEVEL_ERROR);
+    // Arguments of a disabled log are not evaluated
+    LOG_TRACE(disabled, "counter ", counter++);
+    LOG_WARNING(disabled, "counter ", counter++);
+    ASSERT_EQ(0U, counter);
+
+    Log::setLevel(Log::Module::ALL, LOG_CONFIG);
+    LOG_ERROR(disabled, "counter ", counter++);
+    ASSERT_EQ(1U, counter);
+}
+
+TEST(Levels, sample)
+{
+    Log::Site everyN, firstN, perSecond;
+    uint32_t logged[3U] = {0U, 0U, 0U};
+    uint64_t reported[3U] = {0U, 0U, 0U};
+
+    for (uint32_t i = 0U; i < 10U; i++)
+    {
+        logged[0U] += everyN.sample(Log::Sample::EVERY_N, 3U, reported[0U]);
+        logged[1U] += firstN.sample(Log::Sample::FIRST_N, 2U, reported[1U]);
+        logged[2U] += perSecond.sample(Log::Sample::PER_SECOND, 5U, reported[2U]);
+    }
+
+    // Hits 0, 3, 6 and 9 are logged, the first drop is reported at once
+    ASSERT_EQ(4U, logged[0U]);
+    ASSERT_LE(1U, reported[0U]);
+    ASSERT_EQ(6U, everyN.suppressed);
+    // Hits 0 and 1 are logged
+    ASSERT_EQ(2U, logged[1U]);
+    ASSERT_EQ(8U, firstN.suppressed);
+
+    // Within a period of the last report nothing is reported, after it the
+    // total is. The last report is moved instead of sleeping
+    uint64_t report = 0U;
+    firstN.reported = Log::Site::now() + LOG_SAMPLE_REPORT_S;
+    firstN.sample(Log::Sample::FIRST_N, 2U, report);
+    ASSERT_EQ(0U, report);
+    firstN.reported -= 2U * LOG_SAMPLE_REPORT_S;
+    firstN.sample(Log::Sample::FIRST_N, 2U, report);
+    ASSERT_EQ(10U, report);
+    // At most 5 per second, a second might start during the loop
+    ASSERT_LE(5U, logged[2U]);
+    ASSERT_GE(10U, logged[2U]);
+    ASSERT_EQ(10U, perSecond.hits);
+}
+
+TEST(Levels, everyN)
+{
+    Log sampled;
+    uint32_t counter = 0U;
+
+    for (uint32_t i = 0U; i < 8U; i++)
+    {
+        // Arguments are only evaluated when the call site is sampled
+        LOG_EVERY_N(ERROR, sampled, 4U, "counter ", counter++);
+    }
+    ASSERT_EQ(2U, counter);
+
+    for (uint32_t i = 0U; i < 8U; i++)
+    {
+        LOG_FIRST_N(ERROR, sampled, 3U, "counter ", counter++);
+    }
+    ASSERT_EQ(5U, counter);
+}
@@ -0,0 +1,65 @@
+/******************************************************************************/
+/*    INCLUDED FILES                                                          */
+/******************************************************************************/
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <thread>
+/* TARGET LIBRARY */
+#include "trace.hpp"
+
+/******************************************************************************/
+/*    TEST CASES                                                              */
+/******************************************************************************/
+
+TEST(Trace, span)
+{
+    Trace::clear();
+    {
+        Trace::Span outer("outer", "rows", 3U, "cols", 4U);
+        Trace::Span inner("inner");
+    }
+    ASSERT_EQ(2U, Trace::size());
+
+    std::ostringstream os;
+    Trace::dump(os);
+    const std::string json = os.str();
+
+    ASSERT_EQ(0U, json.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+    ASSERT_NE(std::string::npos, json.find("\"name\":\"outer\",\"ph\":\"X\""));
+    ASSERT_NE(std::string::npos, json.find("\"args\":{\"rows\":3,\"cols\":4}"));
+    ASSERT_NE(std::string::npos, json.find("\"name\":\"inner\""));
+    ASSERT_EQ(json.size() - 4U, json.rfind("\n]}\n"));
+
+    Trace::clear();
+    ASSERT_EQ(0U, Trace::size());
+}
+
+TEST(Trace, threads)
+{
+    Trace::clear();
+
+    // Spans of finished threads are kept
+    std::thread worker([]() { Trace::Span span("worker"); });
+    worker.join();
+    {
+        Trace::Span span("main");
+    }
+    ASSERT_EQ(2U, Trace::size());
+
+    std::ostringstream os;
+    Trace::dump(os);
+    ASSERT_NE(std::string::npos, os.str().find("\"name\":\"worker\""));
+    ASSERT_NE(std::string::npos, os.str().find("\"name\":\"main\""));
+    Trace::clear();
+}
+
+TEST(Trace, macro)
+{
+    Trace::clear();
+    {
+        TRACE_SPAN("macro", "size", 1U);
+    }
+    ASSERT_EQ(1U, Trace::size());
+    Trace::clear();
+}
@@ -0,0 +1,203 @@
+#!/usr/bin/env python3
+#*******************************************************************************
+#
+# Performance regression gate
+#
+#   SUMMARY
+#       Runs a benchmark that prints JSON --runs times, and compares it with
+#       a baseline JSON kernel by kernel:
+#
+#       a) Google Benchmark, cpp/bench, with --benchmark_repetitions=N, each
+#          repetition is a sample,
+#       b) the C harness, c/tests/bench, its trials are in "samples_ns".
+#
+#       The samples of one process share its placement, frequency and cache
+#       state, so they are not independent. Each run is reduced to its median
+#       and the test is done on these medians, one per process.
+#
+#       A kernel regresses when the median of its runs is slower than the
+#       baseline's by more than --threshold, and a one-sided Mann-Whitney U
+#       test says the slowdown is significant at --alpha. A kernel of the
+#       baseline that is not run any more fails too. It exits with 1 then.
+#
+#       compare.py [--threshold 0.25] [--alpha 0.01] [--runs 7] [--update] BASELINE -- CMD
+#
+#*******************************************************************************
+
+import argparse
+import json
+import math
+import statistics
+import subprocess
+import sys
+
+# ns per unit of Google Benchmark's "time_unit"
+UNITS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def load_samples(report):
+    """Samples in ns per run, by kernel name."""
+    samples = {}
+
+    for bench in report.get("benchmarks", []):
+        if "samples_ns" in bench:
+            samples[bench["name"]] = list(bench["samples_ns"])
+        elif bench.get("run_type", "iteration") == "iteration":
+            # Repetitions share their run_name, aggregates are skipped
+            name = bench.get("run_name", bench["name"])
+            scale = UNITS[bench.get("time_unit", "ns")]
+            samples.setdefault(name, []).append(bench["real_time"] * scale)
+
+    return samples
+
+
+def run_medians(reports):
+    """Median of each run, by kernel name."""
+    medians = {}
+
+    for report in reports:
+        for name, samples in load_samples(report).items():
+            medians.setdefault(name, []).append(statistics.median(samples))
+
+    return medians
+
+
+def run(command, runs):
+    """Reports of runs independent processes."""
+    reports = []
+
+    for _ in range(runs):
+        output = subprocess.run(command, check=True, stdout=subprocess.PIPE, text=True).stdout
+        reports.append(json.loads(output))
+
+    return reports
+
+
+def mann_whitney(baseline, current):
+    """One-sided p-value of current being slower than baseline."""
+    n1, n2 = len(baseline), len(current)
+    if (n1 < 2) or (n2 < 2):
+        return 1.0
+
+    # Ranks of the pooled samples, ties share their mean rank
+    pooled = sorted([(x, 0) for x in baseline] + [(x, 1) for x in current])
+    ranks = [0.0] * len(pooled)
+    ties = 0.0
+    i = 0
+    while i < len(pooled):
+        j = i
+        while (j + 1 < len(pooled)) and (pooled[j + 1][0] == pooled[i][0]):
+            j += 1
+        for k in range(i, j + 1):
+            ranks[k] = (i + j) / 2.0 + 1.0
+        t = j - i + 1
+        ties += t ** 3 - t
+        i = j + 1
+
+    r2 = sum(rank for rank, (_, group) in zip(ranks, pooled) if group == 1)
+    u2 = r2 - n2 * (n2 + 1) / 2.0
+
+    # Normal approximation with tie correction, continuity corrected
+    n = n1 + n2
+    mean = n1 * n2 / 2.0
+    var = n1 * n2 / 12.0 * ((n + 1) - ties / (n * (n - 1)))
+    if var <= 0.0:
+        return 1.0
+    z = (u2 - mean - 0.5) / math.sqrt(var)
+
+    return 0.5 * math.erfc(z / math.sqrt(2.0))
+
+
+def compare(baseline, current, threshold, alpha):
+    """Rows of the diff table, and the number of regressions and missing kernels."""
+    rows = []
+    regressions = 0
+
+    for name in sorted(set(baseline) | set(current)):
+        if name not in current:
+            rows.append((name, statistics.median(baseline[name]), None, None, None, "MISSING"))
+            regressions += 1
+            continue
+        if name not in baseline:
+            rows.append((name, None, statistics.median(current[name]), None, None, "new"))
+            continue
+
+        old = statistics.median(baseline[name])
+        new = statistics.median(current[name])
+        change = new / old - 1.0
+        p = mann_whitney(baseline[name], current[name])
+
+        if (change > threshold) and (p < alpha):
+            verdict = "REGRESSION"
+            regressions += 1
+        elif (change < -threshold) and (mann_whitney(current[name], baseline[name]) < alpha):
+            verdict = "faster"
+        else:
+            verdict = "ok"
+        rows.append((name, old, new, change, p, verdict))
+
+    return rows, regressions
+
+
+def print_table(rows, stream):
+    def cell(value, fmt):
+        return "-" if value is None else fmt.format(value)
+
+    print("{:<28} {:>14} {:>14} {:>9} {:>9}  {}".format(
+        "Kernel", "Baseline (ns)", "Current (ns)", "Change", "p-value", "Verdict"), file=stream)
+    for name, old, new, change, p, verdict in rows:
+        print("{:<28} {:>14} {:>14} {:>9} {:>9}  {}".format(
+            name, cell(old, "{:.1f}"), cell(new, "{:.1f}"), cell(change, "{:+.1%}"),
+            cell(p, "{:.4f}"), verdict), file=stream)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compares a benchmark run with a baseline.")
+    parser.add_argument("--threshold", type=float, default=0.25,
+                        help="slowdown of the median that is tolerated (default 0.25)")
+    parser.add_argument("--alpha", type=float, default=0.01,
+                        help="significance of the Mann-Whitney U test (default 0.01)")
+    parser.add_argument("--runs", type=int, default=7,
+                        help="independent runs of the command, at least 2 (default 7)")
+    parser.add_argument("--update", action="store_true",
+                        help="write the runs as the new baseline")
+    parser.add_argument("baseline", help="baseline JSON")
+    parser.add_argument("command", nargs=argparse.REMAINDER,
+                        help="-- benchmark command that prints JSON")
+    args = parser.parse_args()
+
+    command = args.command[1:] if args.command[:1] == ["--"] else args.command
+    if not command:
+        parser.error("missing the benchmark command after --")
+    if args.runs < 2:
+        parser.error("--runs must be at least 2")
+
+    reports = run(command, args.runs)
+
+    if args.update:
+        with open(args.baseline, "w") as stream:
+            json.dump({"runs": reports}, stream, indent=2)
+            stream.write("\n")
+        print("Baseline {} was updated with {} runs.".format(args.baseline, args.runs))
+        return 0
+
+    with open(args.baseline) as stream:
+        baseline = json.load(stream)
+    # A single report is a baseline of one run, it cannot be tested against
+    if len(baseline.get("runs", [])) < 2:
+        print("Baseline {} has less than 2 runs, record it again with --update.".format(args.baseline))
+        return 1
+
+    rows, regressions = compare(run_medians(baseline["runs"]), run_medians(reports),
+                                args.threshold, args.alpha)
+    print_table(rows, sys.stdout)
+
+    if regressions != 0:
+        print("{} kernel(s) regressed more than {:.0%} or are missing.".format(regressions, args.threshold))
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())